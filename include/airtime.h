@@ -0,0 +1,56 @@
+#pragma once
+
+#include <config.h>
+#include <cstddef>
+#include <cstdint>
+
+// lora time on air model and rolling duty cycle budget
+
+
+/**
+ * @brief time on air of a lora frame, see Semtech SX1276 datasheet chapter 4.1.1.7
+ */
+class AirtimeModel
+{
+public:
+    AirtimeModel(const Settings::LoRa_settings &lora);
+
+    uint32_t symbol_us() const;
+    uint32_t frame_us(size_t payloadLength) const;
+    uint32_t frame_ms(size_t payloadLength) const;
+
+private:
+    const uint8_t m_sf;
+    const uint32_t m_bw;
+    const uint8_t m_cr;         // coding rate 4/(4+cr)
+    const uint16_t m_preamble;  // preamble symbols
+    const bool m_crc;           // payload crc on
+    const bool m_implicit;      // implicit header mode
+    const bool m_lowDataRate;   // low data rate optimization, on if a symbol lasts longer than 16ms
+};
+
+
+/**
+ * @brief airtime spent within a rolling window, kept in fixed time buckets
+ */
+class AirtimeBudget
+{
+public:
+    static constexpr size_t buckets = 60;
+
+    AirtimeBudget(const Settings::LoRa_settings &lora);
+
+    void charge(unsigned long now, uint32_t airtime_ms);
+    bool allows(unsigned long now, uint32_t airtime_ms);
+    uint32_t used(unsigned long now);
+    uint32_t budget() const;
+
+private:
+    const unsigned long m_bucketLength; // [ms]
+    const uint32_t m_budget;            // [ms] airtime allowed per window
+    uint32_t m_buckets[buckets]{};
+    size_t m_current{0};
+    unsigned long m_currentStart{0};
+
+    void rotate(unsigned long now);
+};
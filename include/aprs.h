@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <txqueue.h>
+
+// allocation free aprs frame encoder, writes straight into a fixed byte buffer
+
+
+class AprsFrame
+{
+public:
+    static constexpr size_t capacity = TxFrame::max_length;
+    static constexpr size_t addressee_length = 9;       // aprs message addressee field width
+    static constexpr size_t analog_channels = 5;        // aprs telemetry analog channels
+    static constexpr uint32_t base91_max = 91 * 91 - 1; // largest value of a two character base-91 field
+    static constexpr size_t position_length = 19;       // "DDMM.hhN/DDDMM.hhEr"
+    static constexpr size_t compressed_position_length = 13;
+    static constexpr size_t altitude_length = 9;        // "/A=aaaaaa"
+
+    void clear();
+    AprsFrame &header(const char *source, const char *destination);
+    AprsFrame &message(const char *addressee);
+    AprsFrame &telemetry(uint16_t sequence, const int *analog, size_t analogCount, uint8_t bits, size_t bitCount);
+    AprsFrame &compressedTelemetry(uint16_t sequence, const int *analog, size_t analogCount, uint8_t bits,
+                                   size_t bitCount);
+    AprsFrame &position(double latitude, double longitude, char table, char symbol);
+    AprsFrame &compressedPosition(double latitude, double longitude, double altitude, char table, char symbol);
+    AprsFrame &altitude(double altitude);
+    AprsFrame &append(char c);
+    AprsFrame &append(const char *str);
+    AprsFrame &append(const char *str, size_t length);
+    AprsFrame &appendPadded(const char *str, size_t width, char paddedChar = ' ');
+    AprsFrame &appendNumber(uint32_t value, size_t width = 0, char paddedChar = '0');
+    AprsFrame &appendBase91(uint32_t value, size_t width);
+
+    const uint8_t *data() const;
+    size_t length() const;
+    bool overflow() const;
+
+private:
+    uint8_t m_buffer[capacity];
+    size_t m_length{0};
+    bool m_overflow{false};
+};
+
+/**
+ * @brief position and altitude of the station, encoded once since the station doesn't move
+ */
+class AprsPosition
+{
+public:
+    void encode(double latitude, double longitude, double altitude, char table, char symbol, bool compressed);
+    const char *position() const;
+    const char *altitude() const;
+
+private:
+    char m_position[AprsFrame::position_length + 1]{};
+    char m_altitude[AprsFrame::altitude_length + 1]{}; // empty when compressed, the altitude is in the position
+};
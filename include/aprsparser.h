@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// zero copy parser of tnc2 frames "SOURCE>DEST,PATH:payload", the counterpart of AprsFrame
+// every text field of an AprsPacket is a view into the parsed frame, which has to outlive the packet.
+
+
+enum AprsPacketType : uint8_t
+{
+    aprs_unknown,        // valid header, payload not understood
+    aprs_position,       // ! = / @, uncompressed or compressed
+    aprs_status,         // >
+    aprs_message,        // :ADDRESSEE:text{id
+    aprs_telemetry,      // T# report or base-91 telemetry of a status report
+    aprs_telemetry_parm, // telemetry metadata messages, text holds the list
+    aprs_telemetry_unit,
+    aprs_telemetry_eqns,
+    aprs_telemetry_bits,
+};
+
+struct AprsPacket
+{
+    static constexpr size_t analog_channels = 5;
+
+    AprsPacketType type;
+    std::string_view source;
+    std::string_view destination;
+    std::string_view path;    // digipeaters, empty for a direct frame
+    std::string_view payload; // information field
+
+    // aprs_position
+    double latitude;  // [°] south negative
+    double longitude; // [°] west negative
+    double altitude;  // [m] if hasAltitude
+    bool hasAltitude;
+    bool compressed;  // compressed position or base-91 telemetry
+    char symbolTable;
+    char symbolCode;
+
+    // position comment, status text, message text or the list of a metadata message
+    std::string_view text;
+    // aprs_message and metadata messages
+    std::string_view addressee; // padding removed
+    std::string_view messageId;
+
+    // aprs_telemetry
+    uint16_t sequence;
+    float analog[analog_channels];
+    uint8_t analogMask; // bit n set if analog n is present
+    uint8_t bits;       // bit 0 is the first digital channel
+    uint8_t bitCount;
+};
+
+class AprsParser
+{
+public:
+    static bool parse(std::string_view frame, AprsPacket &packet);
+    static bool header(std::string_view frame, AprsPacket &packet);
+    static std::string_view nextPathElement(std::string_view &path);
+
+private:
+    static bool position(std::string_view data, AprsPacket &packet);
+    static bool message(std::string_view data, AprsPacket &packet);
+    static bool telemetry(std::string_view data, AprsPacket &packet);
+    static bool compressedTelemetry(std::string_view data, AprsPacket &packet);
+};
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// battery voltage from bursts of ADC reads: median of the burst, calibration table, fixed point EMA
+// the filter steps are pure functions so they can be run against recorded traces off target.
+
+
+class BatteryMonitor
+{
+public:
+    static constexpr size_t burst = 15;     // reads per sample, odd for a true median
+    static constexpr uint8_t ema_shift = 2; // ema weight 1/4
+    static constexpr uint8_t lut_shift = 6; // calibration points every 64 raw counts
+    static constexpr size_t lut_size = (4096 >> lut_shift) + 1;
+    static constexpr uint16_t divider = 2;  // on board 100k/100k divider
+    static constexpr uint16_t empty_mv = 3300;
+    static constexpr uint16_t full_mv = 4200;
+
+    BatteryMonitor(uint8_t pin) : m_pin(pin) {};
+
+    void init();
+    void sample();
+    uint16_t millivolts() const;
+    uint8_t percent() const;
+
+    static uint16_t median(uint16_t *values, size_t count);
+    static uint32_t ema(uint32_t filtered, uint16_t value);
+    static uint8_t to_percent(uint16_t millivolts);
+    uint16_t to_millivolts(uint16_t raw) const;
+
+private:
+    uint8_t m_pin;
+    uint16_t m_lut[lut_size]{}; // pin voltage [mV] by raw >> lut_shift
+    uint32_t m_filtered{0};     // [mV] Q16
+    bool m_primed{false};
+    uint16_t m_millivolts{0};
+    uint8_t m_percent{0};
+};
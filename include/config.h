@@ -12,36 +12,52 @@ struct Settings
     struct Basic_settings
     {
         const std::string version{"1.1"};
-        const int EEPROMaddress{0};
+        const int EEPROMaddress{0};             // aprs sequence of older firmware, migrated once
+        const std::uint8_t seq_commit_batch{8}; // aprs sequence increments between flash commits
         const unsigned long serial_baud{115200L};
         const uint8_t display_address{0x3c};
         const int display_sda{21};
         const int display_scl{22};
-        const std::uint8_t green_led_pin{25}; // digital output
+        const std::uint8_t green_led_pin{25};       // digital output
+        const unsigned long display_interval{1000}; // time [ms] between display refreshes
     } basic;
 
     // TELEMETRY SERVICE SETTINGS
     struct Telemetry_settings
     {
         const std::string callsign{"HB9HDG-13"};
-        const std::string lat{"4704.10N"};
-        const std::string lon{"00903.30E"};
-        const std::string alt{"001476"};                        // 450m
+        const double latitude{47.068333};                       // [°] 47°04.10'N, south negative
+        const double longitude{9.055};                          // [°] 9°03.30'E, west negative
+        const double altitude{450};                             // [m]
         const std::string comment{"HB9HDG aprs telemetry 1.1"}; //  max 43 chars!
         // const std::string callsign{"HB9GL-15"}; // Passcode for HB9GL-R: 7370
-        // const std::string lat{"4704.16N"};      // 47°04'16.5"N 9°05'26.5"E
-        // const std::string lon{"00905.26E"};
-        // const std::string alt{"004557"};                                          // 1389m
+        // const double latitude{47.069333};       // 47°04'16.5"N 9°05'26.5"E
+        // const double longitude{9.087667};
+        // const double altitude{1389};                                              // [m]
         // const std::string comment{"HB9GL-R 438.975, -7.6 | T:71.9 | Node:41140"}; //  max 43 chars!
         const std::string destcall = "TLM";
-        const unsigned long beacon_interval{15}; // time [min] between beacons
-        const unsigned long status_interval{60}; // time [min] betwenn status packet transmitting
-        const std::uint8_t hall_sensor_pin{35};  // battery voltage
-        const std::uint8_t usb_power_pin{34};    // digital input
-        const unsigned long pc_timeout{30};      // time [sec] until pc gets status unreachable
-        const std::uint8_t ext_power_pin{36};    // digital input
+        const char symbol_table{'/'};             // primary table
+        const char symbol_code{'r'};              // repeater
+        const bool compressed_position{true};     // base-91 position, 15 bytes shorter beacon
+        const bool compressed_telemetry{false};   // base-91 telemetry in a status frame instead of T# frames
+        const unsigned long beacon_interval{15};  // time [min] between beacons
+        const unsigned long status_interval{60};  // time [min] betwenn status packet transmitting
+        const std::uint8_t hall_sensor_pin{35};   // battery voltage
+        const unsigned long battery_interval{15}; // time [sec] between battery readings
+        const std::uint8_t usb_power_pin{34};     // digital input
+        const unsigned long pc_timeout{30};       // time [sec] until pc gets status unreachable
+        const std::uint8_t ext_power_pin{36};     // digital input
         const std::uint8_t dht11_pin{0};
-        const unsigned long dht11_interval{30}; // time [sec] between dht11 readings
+        const unsigned long dht11_interval{30};   // time [sec] between dht11 readings
+        const unsigned long history_interval{60}; // time [sec] between history samples
+        // change driven telemetry between the beacon_interval heartbeats
+        const std::uint16_t report_deadband_voltage{100};    // [mV] battery change worth a frame
+        const std::uint16_t report_deadband_temperature{20}; // [0.1°C]
+        const std::uint8_t report_deadband_humidity{10};     // [%]
+        const unsigned long report_coalesce{5};              // time [sec] changes are gathered into one frame
+        const unsigned long report_min_interval{120};        // time [sec] between change driven frames
+        // time [sec] a status bit has to keep its new level before it counts: usb, 240V, pc, uplink, echolink
+        const std::uint16_t report_hold_time[5]{10, 10, 30, 60, 60};
     } tlm;
     // const LoRa_settings lora;
     struct LoRa_settings
@@ -58,6 +74,13 @@ struct Settings
         const std::int16_t SpreadingFactor{12};
         const unsigned long SignalBandwidth{125000L};
         const std::int16_t CodingRate4{5};
+        const std::uint16_t PreambleLength{8};     // LoRa library default
+        const std::uint8_t DutyCyclePercent{10};   // 433.05-434.79 MHz sub-band limit
+        const unsigned long DutyCycleWindow{3600}; // time [sec] of the rolling duty cycle window
+        const bool receive{false};                 // listen between transmissions, no light sleep then
+        const bool digipeat{false};                // repeat frames for our callsign or a WIDEn-N alias, listens
+        const std::uint8_t digipeat_max_wide{1};   // WIDEn-N up to n, 1 is a fill-in digipeater
+        const unsigned long dupe_window{30};       // time [sec] a frame heard again is a duplicate
     } lora;
 };
 
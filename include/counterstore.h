@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <esp_partition.h>
+
+// wear levelled persistent counter, appends records to the "seqlog" partition instead of rewriting one cell
+// a record is {value, ~value}, the newest is the one with the highest value. commits are batched, so after
+// a reset the counter continues batch steps ahead of the last record and never repeats a value. setting a lower
+// value starts a new log. without the partition, e.g. on a board flashed with the partition table of older
+// firmware, the low byte of the counter is kept in the eeprom cell older firmware used, with the same batching.
+
+
+class CounterStore
+{
+public:
+    CounterStore(uint8_t batch, int eepromAddress) : m_batch(batch), m_eepromAddress(eepromAddress) {};
+
+    bool init();
+    void set(uint32_t value);
+    uint32_t value() const;
+    void increment();
+    void commit();
+    uint32_t commits() const;
+    uint32_t erases() const;
+    bool eeprom() const;
+
+private:
+    struct Record
+    {
+        uint32_t value;
+        uint32_t inverted;
+    };
+
+    const uint8_t m_batch;     // increments between commits
+    const int m_eepromAddress; // fallback without the partition
+    const esp_partition_t *m_partition{nullptr};
+    bool m_eeprom{false};
+    uint32_t m_value{0};
+    uint32_t m_committed{0};
+    bool m_hasRecord{false};
+    size_t m_nextSlot{0};
+    uint32_t m_commits{0};
+    uint32_t m_erases{0};
+};
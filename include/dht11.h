@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// non blocking dht11 driver
+// start() pulls the line low, release() hands it to the sensor and captures the falling edges of its answer in
+// an isr, finish() decodes them. the caller spaces the three steps with scheduler one shots, nothing waits.
+
+
+/**
+ * @brief last published dht11 measurement
+ */
+struct ClimateReading
+{
+    int16_t temperature;     // [0.1°C]
+    uint8_t humidity;        // [%]
+    bool valid;              // false until the first frame passed the checks
+    unsigned long timestamp; // [ms] millis() of the measurement
+};
+
+class AsyncDht
+{
+public:
+    static constexpr unsigned long power_up_ms = 1000; // sensor is unstable right after power up
+    static constexpr unsigned long start_ms = 20;      // start signal, datasheet minimum 18 ms
+    static constexpr unsigned long frame_ms = 10;      // answer takes at most ~5 ms
+    static constexpr size_t frame_edges = 41;          // falling edges framing the 40 data bits
+    static constexpr uint32_t bit_threshold_us = 100;  // edge spacing 76 us for a 0, 120 us for a 1
+    static constexpr uint32_t bit_min_us = 60;
+    static constexpr uint32_t bit_max_us = 160;
+
+    AsyncDht(uint8_t pin) : m_pin(pin) {};
+
+    void begin();
+    void start();
+    void release();
+    bool finish(unsigned long now);
+    bool busy() const;
+    const ClimateReading &reading() const;
+    uint32_t reads() const;
+    uint32_t errors() const;
+
+    static bool decode(const uint32_t *edges, size_t count, ClimateReading &reading);
+
+private:
+    static constexpr size_t max_edges = 48;
+
+    uint8_t m_pin;
+    bool m_busy{false};
+    ClimateReading m_reading{};
+    uint32_t m_reads{0};
+    uint32_t m_errors{0};
+    static volatile uint32_t s_edges[max_edges]; // [us] micros() of each falling edge
+    static volatile size_t s_edgeCount;
+
+    static void onFallingEdge();
+};
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <aprs.h>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// path rewriting of a digipeater for tnc2 frames "SRC>DEST,PATH:payload"
+// a frame is repeated for our own callsign or a WIDEn-N alias with n up to maxWide. the used element is marked
+// by our callsign with the has-been-repeated '*', which in tnc2 notation only follows the last used element:
+//   WIDE1-1          -> CALL,WIDE1*
+//   WIDE2-2          -> CALL*,WIDE2-1
+//   DIGI*,WIDE2-1    -> DIGI,CALL,WIDE2*
+//   CALL             -> CALL*
+
+
+class Digipeater
+{
+public:
+    static constexpr size_t max_path = 8; // ax.25 digipeater addresses
+
+    Digipeater(const char *callsign, uint8_t maxWide) : m_callsign(callsign), m_maxWide(maxWide) {};
+
+    bool rewrite(const uint8_t *frame, size_t length, AprsFrame &out) const;
+
+private:
+    const char *m_callsign;
+    const uint8_t m_maxWide;
+
+    bool matches(std::string_view element) const;
+};
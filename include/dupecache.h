@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// recently heard aprs frames for the receive path: a frame heard again within the window is a duplicate.
+// open addressing table of 32 bit digests over source, destination and payload (the path changes from digi to
+// digi), probing is bounded so a lookup costs the same whether the table is empty or full. entries expire by
+// time, an expired entry is a free slot.
+
+
+class DupeCache
+{
+public:
+    static constexpr size_t capacity = 64; // power of two, a few times the frames heard within the window
+    static constexpr size_t max_probe = 8; // slots looked at per lookup
+
+    explicit DupeCache(unsigned long window) : m_window(window) {};
+
+    bool seen(uint32_t digest, unsigned long now);
+    size_t size(unsigned long now) const;
+    uint32_t lookups() const;
+    uint32_t hits() const;
+    uint32_t evictions() const;
+
+    static uint32_t digest(const uint8_t *frame, size_t length);
+
+private:
+    struct Entry
+    {
+        uint32_t digest; // 0 = never used
+        unsigned long time;
+    };
+
+    const unsigned long m_window; // [ms]
+    Entry m_entries[capacity]{};
+    uint32_t m_lookups{0};
+    uint32_t m_hits{0};
+    uint32_t m_evictions{0}; // live entries overwritten because their probe range was full
+
+    bool expired(const Entry &entry, unsigned long now) const;
+};
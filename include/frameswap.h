@@ -0,0 +1,56 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <oledpanel.h>
+#include <probe.h>
+#include <seqlock.h>
+
+// hands composed display frames from the ui task to the task that sends them to the panel, the newest frame wins
+// the ui copies its frame into its back buffer and swaps it with the pending slot in one atomic exchange, the flush
+// task swaps the pending slot with its front buffer. neither side ever waits for the other: a pending frame that is
+// replaced before the flush task took it is dropped, so a slow bus only ever sends the newest frame.
+
+
+struct FrameSwapStats
+{
+    uint32_t published;
+    uint32_t flushed;
+    uint32_t dropped;    // replaced while pending
+    uint32_t latencyP99; // [us] publish to the end of the flush
+    uint32_t latencyMax; // [us]
+};
+
+class FrameSwap
+{
+public:
+    static constexpr size_t frame_size = OledPanel::frame_size;
+
+    void publish(const uint8_t *frame, uint32_t now);
+    const uint8_t *take(uint32_t &published);
+    void flushed(uint32_t published, uint32_t now);
+    bool pending() const;
+    FrameSwapStats stats() const;
+
+private:
+    static constexpr uint8_t fresh = 0x80; // pending slot holds a frame the flush task has not taken
+
+    uint8_t m_frames[3][frame_size]{};
+    uint32_t m_times[3]{};             // [us] micros() a frame was published
+    uint8_t m_back{0};                 // ui side
+    std::atomic<uint8_t> m_pending{1}; // index | fresh
+    uint8_t m_front{2};                // flush side
+    // figures of the flush task, published after every flush
+    struct Flushed
+    {
+        uint32_t count;
+        uint32_t latencyP99; // [us]
+        uint32_t latencyMax; // [us]
+    };
+
+    std::atomic<uint32_t> m_published{0};
+    std::atomic<uint32_t> m_dropped{0};
+    LatencyHistogram m_latency; // flush task only
+    Seqlock<Flushed> m_flushed;
+};
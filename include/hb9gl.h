@@ -1,17 +1,24 @@
 #pragma once
 
-#include <DHT.h> // dht11 sensor (temperature & humidity)
 #include <EEPROM.h>
 #include <SSD1306.h> // LCD display
 #include <Wire.h>
+#include <battery.h> // filtered battery voltage
 #include <config.h> // our configuration file
+#include <counterstore.h>
 #include <cstdint>
+#include <dht11.h> // dht11 sensor (temperature & humidity)
+#include <frameswap.h>
+#include <oledpanel.h>
+#include <seqlock.h>
+#include <snapshot.h>
 #include <string>
+#include <telemetry.h>
 
 class Data
 {
 public:
-    Data(const DHT &dht) : m_dht(dht)
+    Data(AsyncDht &dht) : m_dht(dht)
     {
 #if SERIALDEBUG
         Serial.println("Data constructor called");
@@ -20,8 +27,12 @@ public:
     ~Data() = default;
 
     void init();
-    void updateData();
-    void fetchSensorData();
+    void acquire();
+    TelemetrySnapshot snapshot() const;
+    void sampleBattery();
+    void sampleClimate();
+    void releaseClimate();
+    void finishClimate();
     float get_temperature();
     float get_humidity();
     float get_intVoltage();
@@ -29,6 +40,7 @@ public:
     uint8_t get_aprsPacketSeq();
     void set_aprsPacketSeq(uint8_t count);
     void inc_aprsPacketSeq();
+    void flush();
     bool get_statusPCUSBpower();
     bool get_statusMainsPower();
     bool get_statusPCConnected();
@@ -37,6 +49,7 @@ public:
     void set_statusUpLink(bool uplink_reachable);
     bool get_statusEchoLink();
     void set_statusEchoLink(bool echolink_logged_in);
+    uint8_t get_statusBits();
     bool get_statusChanged();
     void reset_statusChanged();
 
@@ -63,17 +76,24 @@ protected:
     bool m_previousStatusEchoLink{false};
 
 private:
-    const unsigned long m_battWaitTime{15000};
-    unsigned long m_battTimeStamp{0};
-    DHT m_dht;
-    const unsigned long m_dhtWaitTime{15000};
-    unsigned long m_dhtTimeStamp{0};
+    CounterStore m_seqStore{settings.basic.seq_commit_batch, settings.basic.EEPROMaddress};
+    BatteryMonitor m_battery{settings.tlm.hall_sensor_pin};
+    Seqlock<TelemetrySnapshot> m_snapshot;
+    AsyncDht &m_dht;
+};
+
+struct DisplayStats
+{
+    uint32_t redraws;
+    uint32_t skipped; // displayData() calls without a changed field
+    FrameSwapStats frames;
+    OledPanelStats panel;
 };
 
 class Display : public Data
 {
 public:
-    Display(SSD1306 &lcd, DHT &dht) : Data(dht), m_lcd(lcd)
+    Display(SSD1306 &lcd, AsyncDht &dht) : Data(dht), m_lcd(lcd)
     {
 #if SERIALDEBUG
         Serial.println("Display constructor called");
@@ -83,8 +103,58 @@ public:
 
     void init();
     void displayData();
+    bool refresh();
+    bool refreshPage();
+    bool flushing() const;
     void printBox(int16_t x, int16_t y, int16_t width, int16_t height, const String &text, bool inverse = false);
+    bool render(const TelemetrySnapshot &data);
+    void renderFull(const TelemetrySnapshot &data);
+    const uint8_t *frame() const;
+    DisplayStats stats() const;
 
 private:
+    static constexpr int16_t battery_y = 13;
+    static constexpr int16_t climate_y = 24;
+    static constexpr int16_t text_height = 13; // ArialMT_Plain_10
+
+    // what a redraw shows, the formatted text compares exactly what ends up on the panel
+    struct Fields
+    {
+        char battery[30];
+        char climate[30];
+        uint8_t status;
+        uint32_t batteryValue; // the values battery and climate were formatted from
+        uint32_t climateValue;
+
+        bool operator==(const Fields &other) const;
+    };
+
+    struct Box
+    {
+        int16_t x;
+        int16_t y;
+        int16_t width;
+        int16_t height;
+        const std::string Texts::*label;
+        TelemetryDigitalId bit;
+    };
+    static const Box s_boxes[tlm_digital_count];
+
     SSD1306 m_lcd;
+    OledPanel m_panel{Wire, settings.basic.display_address};
+    FrameSwap m_frames;
+    const uint8_t *m_flushFrame{nullptr}; // frame of refreshPage() not yet complete on the panel
+    uint32_t m_flushPublished{0};         // [us] its publication
+    Seqlock<OledPanelStats> m_panelStats; // of the flush task, after every frame
+    // title and status boxes rendered once, all boxes normal and all boxes inverse
+    uint8_t m_layers[2][OledPanel::frame_size]{};
+    Fields m_shown{};
+    bool m_shownValid{false};
+    uint32_t m_redraws{0};
+    uint32_t m_skipped{0};
+
+    void format(const TelemetrySnapshot &data, Fields &fields) const;
+    void drawStatic(uint8_t status);
+    void blitBox(const Box &box, bool inverse);
+    void clearRows(int16_t first, int16_t last);
 };
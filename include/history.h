@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <esp_partition.h>
+#include <interface.h>
+
+// telemetry history in RAM, delta encoded in fixed size blocks, optionally persisted to the "history" partition
+// every block starts with an absolute sample, the following samples only store what changed.
+
+
+using HistorySample = esp_history_sample;
+
+struct HistoryBlock
+{
+    static constexpr size_t size = 256;
+    static constexpr uint16_t magic_value = 0x4854; // "HT"
+
+    uint16_t magic;
+    uint16_t check; // crc16 of the block with check = 0, only valid for persisted blocks
+    uint32_t sequence;
+    uint32_t firstTime;
+    uint32_t lastTime;
+    uint16_t used;  // bytes used in data
+    uint16_t count; // samples in data
+    uint8_t data[size - 20];
+};
+
+/**
+ * @brief position of a running range query
+ */
+struct HistoryCursor
+{
+    uint32_t from;
+    uint32_t to;
+    uint32_t sequence; // block
+    uint16_t offset;   // byte in block
+    uint16_t index;    // sample in block
+    HistorySample previous;
+    bool done;
+};
+
+class HistoryLog
+{
+public:
+    static constexpr size_t blocks = 16;
+
+    void init();
+    uint32_t now() const;
+    void record(HistorySample sample);
+    void flush();
+    HistoryCursor query(uint32_t from, uint32_t to) const;
+    bool next(HistoryCursor &cursor, HistorySample &sample) const;
+    uint32_t samples() const;
+    uint32_t bytesUsed() const;
+    bool persistent() const;
+
+private:
+    HistoryBlock m_blocks[blocks];
+    uint32_t m_firstSequence{0}; // oldest block in RAM
+    uint32_t m_nextSequence{0};  // block after the open one
+    bool m_open{false};          // block m_nextSequence - 1 takes new samples
+    uint32_t m_timeBase{0};      // [sec] history clock at boot
+    HistorySample m_last{};
+    const esp_partition_t *m_partition{nullptr};
+
+    HistoryBlock &block(uint32_t sequence);
+    const HistoryBlock &block(uint32_t sequence) const;
+    void open_block(const HistorySample &sample);
+    void close_block();
+    void persist(HistoryBlock &block);
+    void restore();
+    bool read_block(uint32_t sequence, HistoryBlock &out) const;
+    static size_t encode(const HistorySample &sample, const HistorySample *previous, uint8_t *out);
+    static size_t decode(const uint8_t *in, const HistorySample *previous, HistorySample &sample);
+};
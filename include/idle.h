@@ -0,0 +1,58 @@
+#pragma once
+
+#include <config.h>
+#include <cstdint>
+
+// lets loop() wait for the next deadline instead of spinning
+// the loop task blocks on its task notification (tickless for FreeRTOS), which is given by the UART receive
+// callback, edges on the power pins and the radio DIO0 interrupt. with nothing to serve on the serial link and
+// the radio idle the wait is a light sleep instead.
+
+
+enum IdleWakeSource : uint8_t
+{
+    idle_wake_timer = 0x01,
+    idle_wake_uart = 0x02,
+    idle_wake_power = 0x04,
+    idle_wake_radio = 0x08,
+};
+
+/**
+ * @brief wake and duty cycle counters
+ */
+struct IdleStats
+{
+    uint32_t uptime_ms;
+    uint32_t idle_ms;    // time spent waiting
+    uint32_t waits;
+    uint32_t lightSleeps;
+    uint32_t wakeTimer;  // deadline reached
+    uint32_t wakeUart;
+    uint32_t wakePower;  // usb or external power pin edge
+    uint32_t wakeRadio;
+    uint16_t dutyCycle;  // [0.1%] awake share of the uptime
+};
+
+class IdleWait
+{
+public:
+    void init();
+    void wait(unsigned long deadline, bool lightSleep);
+    IdleStats stats() const;
+    static void wake(uint8_t source);
+    static void wakeFromIsr(uint8_t source);
+
+private:
+    Settings m_settings;
+    uint64_t m_idleUs{0};
+    uint32_t m_waits{0};
+    uint32_t m_lightSleeps{0};
+    uint32_t m_wakes[4]{}; // by IdleWakeSource bit
+    static void *s_task;
+    static volatile uint8_t s_sources;
+
+    uint8_t light_sleep(unsigned long timeout);
+    void count(uint8_t sources);
+    static void onPowerEdge();
+    static void onUartReceive();
+};
@@ -1,6 +1,9 @@
 #pragma once
 #include <cstdint>
 
+// messages exchanged with the PC-Compagnion
+// every message travels as one frame: COBS( command | message struct | crc16 ) 0x00, see serialproto.h
+
 struct pc_link_message final
 {
     constexpr static const uint32_t command = 1;
@@ -38,3 +41,222 @@ struct esp_get_reboot_message final
     constexpr static const uint32_t command = 5;
     uint32_t dummy;
 };
+
+struct esp_get_airtime_message final
+{
+    constexpr static const uint32_t command = 6;
+    uint32_t dummy;
+};
+
+struct esp_get_airtime_response_message final
+{
+    constexpr static const uint32_t command = 7;
+    uint32_t airtimeTotal;     // [ms] since boot
+    uint32_t airtimeWindow;    // [ms] within the rolling duty cycle window
+    uint32_t airtimeBudget;    // [ms] allowed per window
+    uint32_t framesSent;
+    uint32_t framesDeferred;   // held back by the duty cycle budget
+    uint32_t framesDropped;    // lost because of a full tx queue
+    uint32_t queueDepth;
+    uint32_t compressedFrames; // telemetry frames sent base-91 compressed
+    uint32_t bytesSaved;       // by the compressed frames compared to T# frames
+    uint32_t airtimeSaved;     // [ms]
+};
+
+// start (or stop) pushing esp_delta_message whenever a value moved beyond its threshold
+struct esp_subscribe_message final
+{
+    constexpr static const uint32_t command = 8;
+    uint8_t enable;                // 0 = stop pushing
+    uint8_t humidityThreshold;     // [%]
+    uint16_t voltageThreshold;     // [mV]
+    uint16_t temperatureThreshold; // [0.1°C]
+    uint16_t heartbeatInterval;    // [sec] push even without changes, 0 = no heartbeat
+};
+
+struct esp_delta_message final
+{
+    constexpr static const uint32_t command = 9;
+    constexpr static const uint8_t changed_status = 0x01;
+    constexpr static const uint8_t changed_voltage = 0x02;
+    constexpr static const uint8_t changed_temperature = 0x04;
+    constexpr static const uint8_t changed_humidity = 0x08;
+    constexpr static const uint8_t changed_sequence = 0x10;
+    uint8_t changed;     // changed_* bits, 0 for a heartbeat
+    uint8_t status;      // bit 0 USB power, 1 mains power, 2 PC connected, 3 uplink, 4 echolink
+    uint16_t intvoltage; // [mV]
+    int16_t temperature; // [0.1°C]
+    uint8_t humidity;    // [%]
+    uint8_t battPercent;
+    uint8_t aprsPacketSeq;
+};
+
+struct esp_history_sample final
+{
+    uint32_t time;       // [sec] history clock, see esp_history_response_message::now
+    uint16_t intvoltage; // [mV]
+    int16_t temperature; // [0.1°C]
+    uint8_t humidity;    // [%]
+    uint8_t status;      // status bits as in esp_delta_message
+};
+
+// fetch the recorded samples of a time range, answered by a series of esp_history_response_message
+struct esp_get_history_message final
+{
+    constexpr static const uint32_t command = 10;
+    uint32_t from; // [sec] history clock, inclusive
+    uint32_t to;   // [sec] history clock, inclusive
+};
+
+struct esp_history_response_message final
+{
+    constexpr static const uint32_t command = 11;
+    constexpr static const uint8_t max_samples = 16;
+    uint32_t now;  // [sec] current history clock, keeps counting across reboots
+    uint8_t count; // valid entries in samples
+    uint8_t last;  // 1 on the final message of the query
+    esp_history_sample samples[max_samples];
+};
+
+// idle wait counters of the main loop
+struct esp_get_idle_message final
+{
+    constexpr static const uint32_t command = 12;
+};
+
+struct esp_get_idle_response_message final
+{
+    constexpr static const uint32_t command = 13;
+    uint32_t uptime;    // [ms]
+    uint32_t idleTime;  // [ms] spent waiting for the next deadline
+    uint32_t waits;
+    uint32_t lightSleeps;
+    uint32_t wakeTimer; // deadline reached
+    uint32_t wakeUart;
+    uint32_t wakePower; // usb or external power pin edge
+    uint32_t wakeRadio;
+    uint16_t dutyCycle; // [0.1%] awake share of the uptime
+};
+
+// task figures, one entry per task: radio, display, pc, loop in DUALCORE mode, loop only otherwise
+struct esp_task_stats final
+{
+    char name[8];          // zero padded, not terminated if it fills the field
+    uint32_t stackFree;    // [bytes] stack high water mark
+    uint32_t worstLatency; // [us] queueing a request until the task picked it up
+    uint32_t runs;         // task loop passes
+};
+
+struct esp_get_tasks_message final
+{
+    constexpr static const uint32_t command = 14;
+};
+
+struct esp_get_tasks_response_message final
+{
+    constexpr static const uint32_t command = 15;
+    constexpr static const uint8_t max_tasks = 4;
+    uint8_t count; // valid entries in tasks
+    esp_task_stats tasks[max_tasks];
+};
+
+// latency histograms of the loop stages, answered by one esp_get_probes_response_message per stage
+struct esp_get_probes_message final
+{
+    constexpr static const uint32_t command = 16;
+    uint8_t reset; // 1 clears the histograms once they are sent
+};
+
+struct esp_get_probes_response_message final
+{
+    constexpr static const uint32_t command = 17;
+    constexpr static const uint8_t max_buckets = 20;
+    char name[8];
+    uint8_t stage;                 // ProbeStage of probe.h
+    uint8_t last;                  // 1 on the final message of the answer
+    uint32_t count;
+    uint32_t min;                  // [us]
+    uint32_t max;                  // [us]
+    uint32_t p99;                  // [us] upper bound of the bucket holding the 99th percentile
+    uint16_t buckets[max_buckets]; // bucket n counts [2^n, 2^(n+1)) us, the last one everything above
+};
+
+// receive path counters
+struct esp_get_rx_message final
+{
+    constexpr static const uint32_t command = 18;
+};
+
+struct esp_get_rx_response_message final
+{
+    constexpr static const uint32_t command = 19;
+    uint32_t framesReceived; // lora-aprs frames heard
+    uint32_t framesInvalid;  // crc error or no lora-aprs header
+    uint32_t duplicates;     // heard again within the dupe window, own frames included
+    uint32_t digipeated;
+    uint32_t forwarded;      // esp_rx_frame_message sent
+    uint32_t poolDrops;      // unique frames lost because the receive pool was full
+    uint32_t cacheEntries;   // live entries of the duplicate cache
+    uint32_t cacheCapacity;
+    uint32_t cacheEvictions; // live entries overwritten, the cache is too small for the traffic
+    uint32_t memory;         // [bytes] receive pool and duplicate cache
+    uint8_t receive;         // 1 while the radio listens between transmissions
+    uint8_t digipeat;
+};
+
+// a unique frame heard on the air, pushed to a connected pc-compagnion to gate it to aprs-is
+struct esp_rx_frame_message final
+{
+    constexpr static const uint32_t command = 20;
+    constexpr static const uint8_t max_length = 240;
+    int16_t rssi;           // [dBm]
+    float snr;              // [dB]
+    uint8_t length;         // valid bytes in frame
+    char frame[max_length]; // tnc2 text without the lora-aprs header
+};
+
+// display refresh counters
+struct esp_get_display_message final
+{
+    constexpr static const uint32_t command = 21;
+};
+
+struct esp_get_display_response_message final
+{
+    constexpr static const uint32_t command = 22;
+    uint32_t redraws;
+    uint32_t redrawsSkipped;   // nothing displayed had changed
+    uint32_t framesDropped;    // replaced by a newer frame before the flush took it
+    uint32_t flushLatencyP99;  // [us] redraw to the end of the flush
+    uint32_t flushLatencyMax;  // [us]
+    uint32_t flushes;
+    uint32_t flushesUnchanged; // redrawn without a changed pixel
+    uint32_t windows;          // address windows sent to the panel
+    uint32_t bytes;            // [bytes] on the i2c bus
+};
+
+// serial output counters
+struct esp_get_serial_message final
+{
+    constexpr static const uint32_t command = 23;
+};
+
+struct esp_get_serial_response_message final
+{
+    constexpr static const uint32_t command = 24;
+    uint32_t frames;        // queued for the uart
+    uint32_t framesDropped; // the output queue was full
+    uint32_t bytesDropped;
+    uint32_t writes;        // uart writes, several frames go out in one
+    uint16_t queued;        // [bytes] waiting for the uart when answered
+    uint16_t highWater;     // [bytes]
+    uint16_t capacity;      // [bytes]
+};
+
+// switches the receive path at runtime, the defaults are Settings::LoRa_settings receive and digipeat
+struct esp_set_radio_message final
+{
+    constexpr static const uint32_t command = 25;
+    uint8_t receive;  // 1 listens between transmissions, the chip no longer light sleeps
+    uint8_t digipeat; // 1 repeats frames for our callsign or a WIDEn-N alias, implies receive
+};
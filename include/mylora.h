@@ -1,20 +1,121 @@
 #include <LoRa.h> // LoRa library by Sandeep Mistry
+#include <airtime.h>
+#include <aprs.h>
 #include <config.h>
+#include <digipeater.h>
+#include <dupecache.h>
 #include <hb9gl.h>
+#include <seqlock.h>
+#include <spscqueue.h>
 #include <string>
+#include <telemetry.h>
+#include <txqueue.h>
+
+/**
+ * @brief airtime and duty cycle counters
+ */
+struct AirtimeStats
+{
+    uint32_t total_ms;         // airtime since boot
+    uint32_t window_ms;        // airtime within the rolling duty cycle window
+    uint32_t budget_ms;        // airtime allowed per window
+    uint32_t framesSent;
+    uint32_t framesDeferred;   // frames held back by the duty cycle budget
+    uint32_t framesDropped;    // frames lost because of a full queue
+    uint32_t queueDepth;
+    uint32_t compressedFrames; // telemetry frames sent base-91 compressed
+    uint32_t bytesSaved;       // compared to the same frames as T#
+    uint32_t airtimeSaved_ms;
+};
+
+/**
+ * @brief frame heard on the air, tnc2 text without the lora-aprs header
+ */
+struct RxFrame
+{
+    uint8_t length;
+    uint8_t data[TxFrame::max_length];
+    int16_t rssi; // [dBm]
+    float snr;    // [dB]
+};
+
+/**
+ * @brief receive path counters
+ */
+struct RxStats
+{
+    uint32_t framesReceived;
+    uint32_t framesInvalid;  // crc error or no lora-aprs header
+    uint32_t duplicates;     // own frames heard back included
+    uint32_t digipeated;
+    uint32_t poolDrops;      // unique frames received() didn't pick up in time
+    uint32_t cacheEntries;
+    uint32_t cacheCapacity;
+    uint32_t cacheEvictions;
+    uint32_t memory;         // [bytes] receive pool and duplicate cache
+    bool receive;
+    bool digipeat;
+};
 
 class MyLora : public LoRaClass
 {
 public:
     void init();
-    void tx(String tx_data);
-    template <typename T>
-    void tx(T tx_data);
+    void service();
+    void mode(bool receive, bool digipeat);
+    void tx(const uint8_t *data, size_t length, TxPriority priority = tx_priority_data);
+    void tx(const AprsFrame &frame, TxPriority priority = tx_priority_data);
     void tx_telemetry_beacon(Display &display);
-    void tx_telemetry_data(Display &display);
+    void tx_telemetry_data(Display &display, uint8_t sequence, TxPriority priority = tx_priority_data);
+    bool busy() const;
+    unsigned long nextDeadline() const;
+    const TxQueue &queue() const;
+    AirtimeStats airtimeStats() const;
+    bool received(RxFrame &frame);
+    RxStats rxStats() const;
+    uint32_t airtime_ms(size_t length) const;
 
 private:
+    static constexpr size_t header_length = 3;           // "<\xFF\x01" lora-aprs header
+    static constexpr unsigned long deferral_retry = 1000; // [ms] budget check interval of a deferred frame
+    static constexpr size_t rx_pool = 4;                  // received frames waiting for received()
+
     Settings m_settings;
-    std::string lpad(std::string const &str, size_t length, char paddedChar = ' ');
-    std::string rpad(std::string const &str, size_t s, char paddedChar = ' ');
+    bool m_receive{m_settings.lora.receive || m_settings.lora.digipeat};
+    bool m_digipeat{m_settings.lora.digipeat};
+    TxQueue m_queue;
+    AirtimeModel m_airtime{m_settings.lora};
+    AirtimeBudget m_budget{m_settings.lora};
+    uint32_t m_airtimeTotal{0};
+    uint32_t m_deferrals{0};
+    uint32_t m_deferredOrder{0};
+    uint32_t m_compressedFrames{0};
+    uint32_t m_bytesSaved{0};
+    uint32_t m_airtimeSaved{0}; // [ms]
+    AprsPosition m_position;
+    SpscQueue<RxFrame, rx_pool> m_rxPool; // service() to received(), radio and loop task in DUALCORE mode
+    DupeCache m_dupes{m_settings.lora.dupe_window * 1000};
+    Digipeater m_digipeater{m_settings.tlm.callsign.c_str(), m_settings.lora.digipeat_max_wide};
+    uint32_t m_rxFrames{0};
+    uint32_t m_rxInvalid{0};
+    uint32_t m_duplicates{0};
+    uint32_t m_digipeated{0};
+    Seqlock<AirtimeStats> m_airtimeStats; // written by the radio owner, read by the loop in DUALCORE mode
+    Seqlock<RxStats> m_rxStats;
+    bool m_deferring{false};
+    unsigned long m_txStartTime{0};
+    unsigned long m_txTimeout{0}; // [ms] poll the radio if dio0 never fired
+    bool m_parked{false}; // off the air: asleep, or listening in receive mode
+    static volatile bool s_dio0Raised;
+
+    void serve_queue();
+    void publish_stats();
+    void enqueue(const uint8_t *data, size_t length, TxPriority priority);
+    void start_tx(const TxFrame &frame);
+    void take_rx();
+    void park();
+    void count_saving(const AprsFrame &compressed, const AprsFrame &plain);
+    static void onDio0();
+    static void onTxDoneDummy();
+    static void onRxDoneDummy(int size);
 };
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <Wire.h>
+#include <cstddef>
+#include <cstdint>
+
+// incremental refresh of a 128x64 SSD1306 in horizontal addressing mode
+// keeps a copy of what the panel shows and sends only the changed columns of each 8 row page. two runs of a page
+// closer than the cost of another address window go out as one run. flushPage() sends a frame one page per call, so
+// a single task can spread a flush over its loop passes.
+
+
+struct OledPanelStats
+{
+    uint32_t flushes;
+    uint32_t unchanged; // flushes without a changed byte
+    uint32_t windows;   // address windows sent
+    uint32_t bytes;     // [bytes] on the i2c bus, address and control bytes included
+};
+
+class OledPanel
+{
+public:
+    static constexpr int16_t width = 128;
+    static constexpr int16_t pages = 8;
+    static constexpr size_t frame_size = width * pages;
+
+    OledPanel(TwoWire &wire, uint8_t address) : m_wire(wire), m_address(address) {};
+
+    void sync(const uint8_t *frame);
+    void invalidate();
+    size_t flush(const uint8_t *frame);
+    bool flushPage(const uint8_t *frame);
+    OledPanelStats stats() const;
+
+private:
+    static constexpr size_t chunk = 64;       // data bytes per i2c transaction, arduino-esp32 buffers 128
+    static constexpr size_t window_cost = 10; // [bytes] window commands and the header of one more transaction
+
+    TwoWire &m_wire;
+    const uint8_t m_address;
+    uint8_t m_shown[frame_size]{};
+    bool m_valid{false};
+    int16_t m_page{0};        // next page of flushPage()
+    uint32_t m_frameBytes{0}; // m_stats.bytes when the frame's first page was sent
+    OledPanelStats m_stats{};
+
+    void send(int16_t firstPage, int16_t lastPage, int16_t firstColumn, int16_t lastColumn, const uint8_t *frame);
+};
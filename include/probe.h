@@ -0,0 +1,89 @@
+#pragma once
+
+#include <Arduino.h>
+#include <cstddef>
+#include <cstdint>
+
+// latency probes of the loop stages, fed into log2 histograms and fetched with esp_get_probes_message
+// a probe reads the cpu cycle counter on entry and exit of its scope, a stage is measured inclusive of the
+// stages it calls. with LOOPPROBES false PROBE() expands to nothing and the histograms don't exist.
+
+#define LOOPPROBES true // time the loop stages
+
+
+enum ProbeStage : uint8_t
+{
+    probe_loop,      // one loop() pass without the idle wait
+    probe_serial,    // pc-compagnion frame parsing and message handling
+    probe_acquire,   // Data::acquire()
+    probe_display,   // Display::displayData()
+    probe_telemetry, // MyLora::tx_telemetry_data() encoding and queueing
+    probe_commit,    // aprs sequence flash commit
+    probe_history,   // history sample, block writes included
+    probe_radio,     // MyLora::service()
+    probe_receive,   // one received frame: copy, duplicate check, digipeat
+    probe_stages
+};
+
+/**
+ * @brief log2 histogram of durations, bucket n counts [2^n, 2^(n+1)) us, the last bucket everything above
+ */
+class LatencyHistogram
+{
+public:
+    static constexpr size_t buckets = 20;
+
+    void record(uint32_t us);
+    void reset();
+    uint32_t count() const;
+    uint32_t min() const;
+    uint32_t max() const;
+    uint32_t percentile(uint16_t perMille) const;
+    uint16_t bucket(size_t index) const;
+
+    static size_t bucket_of(uint32_t us);
+
+private:
+    uint32_t m_count{0};
+    uint32_t m_min{UINT32_MAX};
+    uint32_t m_max{0};
+    uint16_t m_buckets[buckets]{}; // saturating
+};
+
+#if LOOPPROBES
+
+class LoopProbes
+{
+public:
+    static void init();
+    static void record(ProbeStage stage, uint32_t cycles);
+    static const LatencyHistogram &histogram(ProbeStage stage);
+    static const char *name(ProbeStage stage);
+    static void reset();
+
+private:
+    static LatencyHistogram s_histograms[probe_stages];
+    static uint32_t s_cyclesPerUs;
+};
+
+/**
+ * @brief times its own lifetime
+ */
+class ProbeScope
+{
+public:
+    explicit ProbeScope(ProbeStage stage) : m_stage(stage), m_start(ESP.getCycleCount()) {};
+    ~ProbeScope() { LoopProbes::record(m_stage, ESP.getCycleCount() - m_start); }
+
+    ProbeScope(const ProbeScope &) = delete;
+    ProbeScope &operator=(const ProbeScope &) = delete;
+
+private:
+    ProbeStage m_stage;
+    uint32_t m_start;
+};
+
+#define PROBE(stage) const ProbeScope probe_##stage(stage)
+#else
+#define PROBE(stage)
+#endif
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <config.h>
+#include <snapshot.h>
+#include <telemetry.h>
+
+// change driven aprs telemetry: decides when a change is worth a frame between the periodic heartbeat frames
+// an analog value has to move past its deadband, a status bit has to keep its new level for its hold time, so
+// a flapping input is never reported. changes within the coalesce window go out in one frame.
+
+
+class ReportPolicy
+{
+public:
+    explicit ReportPolicy(const Settings::Telemetry_settings &settings);
+
+    bool poll(unsigned long now, const TelemetrySnapshot &data);
+    void sent(unsigned long now, const TelemetrySnapshot &data);
+    unsigned long nextDeadline(unsigned long now) const;
+
+private:
+    const Settings::Telemetry_settings &m_settings;
+    bool m_started{false};
+    bool m_pending{false}; // a reportable change waits for the coalesce window
+    unsigned long m_pendingSince{0};
+    unsigned long m_lastSent{0};
+    uint8_t m_stable{0};                                 // debounced status bits
+    uint8_t m_candidate{0};                              // raw status bits of the last poll
+    unsigned long m_candidateSince[tlm_digital_count]{}; // [ms] time each raw bit took its level
+    TelemetrySnapshot m_reported{};                      // values of the last frame, status debounced
+
+    bool changed(const TelemetrySnapshot &data) const;
+};
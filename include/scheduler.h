@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// cooperative scheduler on a hashed timer wheel
+// jobs hash into the slot of their deadline tick, run() only visits the slots of the ticks that passed since
+// the last call and the tick of that call. the clock is injectable so timing can be simulated.
+
+
+typedef void (*JobFunction)();
+
+/**
+ * @brief periodic or one shot job, owned by the caller
+ */
+struct SchedulerJob
+{
+    const char *name;
+    JobFunction function;
+    unsigned long period{0};      // [ms] 0 = one shot
+    unsigned long deadline{0};    // [ms] next due time
+    uint32_t runs{0};
+    uint32_t overruns{0};         // periods skipped because the job was served too late
+    unsigned long maxLateness{0}; // [ms] worst delay between deadline and run
+    SchedulerJob *next{nullptr};  // wheel slot list
+    bool armed{false};
+
+    SchedulerJob(const char *jobName, JobFunction jobFunction) : name(jobName), function(jobFunction) {};
+};
+
+class Scheduler
+{
+public:
+    typedef unsigned long (*Clock)();
+    static constexpr size_t slots = 64;
+    static constexpr unsigned long tick = 10; // [ms] wheel resolution
+
+    Scheduler(Clock clock) : m_clock(clock) {};
+
+    void every(SchedulerJob &job, unsigned long period, unsigned long delay = 0);
+    void once(SchedulerJob &job, unsigned long delay);
+    void restart(SchedulerJob &job);
+    void cancel(SchedulerJob &job);
+    size_t run();
+    unsigned long nextDeadline() const;
+    unsigned long now() const;
+
+private:
+    Clock m_clock;
+    SchedulerJob *m_slots[slots]{};
+    unsigned long m_lastTick{0};
+    bool m_started{false};
+
+    void insert(SchedulerJob &job);
+    void unlink(SchedulerJob &job);
+    size_t slot_of(unsigned long time) const;
+};
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+// single writer, many reader publication of a small trivially copyable struct
+// readers never block the writer, they retry while a write is in progress. the value is held in atomic words
+// so a torn read is detected by the sequence and never undefined behaviour.
+// keep the writer short, a reader on the same core with a higher priority spins until it is done.
+
+
+template <typename T>
+class Seqlock
+{
+    static_assert(std::is_trivially_copyable<T>::value, "seqlock values are copied word by word");
+
+public:
+    /**
+     * @brief publishes a new value, only one task may write
+     */
+    void write(const T &value)
+    {
+        uint32_t words[word_count]{};
+        memcpy(words, &value, sizeof(T));
+        const auto sequence = m_sequence.load(std::memory_order_relaxed);
+        m_sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (size_t i = 0; i < word_count; ++i)
+            m_words[i].store(words[i], std::memory_order_relaxed);
+        m_sequence.store(sequence + 2, std::memory_order_release);
+    }
+
+    /**
+     * @brief consistent copy of the last published value
+     */
+    T read() const
+    {
+        uint32_t words[word_count];
+        uint32_t before;
+        uint32_t after;
+        do
+        {
+            before = m_sequence.load(std::memory_order_acquire);
+            for (size_t i = 0; i < word_count; ++i)
+                words[i] = m_words[i].load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            after = m_sequence.load(std::memory_order_relaxed);
+        } while ((before & 1) || before != after);
+        T value;
+        memcpy(&value, words, sizeof(T));
+        return value;
+    }
+
+    /**
+     * @brief number of writes so far
+     */
+    uint32_t version() const
+    {
+        return m_sequence.load(std::memory_order_acquire) / 2;
+    }
+
+private:
+    static constexpr size_t word_count = (sizeof(T) + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+
+    std::atomic<uint32_t> m_sequence{0}; // odd while a write is in progress
+    std::atomic<uint32_t> m_words[word_count]{};
+};
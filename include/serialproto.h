@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// framing of the interface.h messages on the serial link to the PC-Compagnion
+// frame: COBS( command (uint32, little endian) | message struct | crc16 (little endian) ) 0x00
+// crc16 is CRC-16/CCITT-FALSE over command and message struct
+
+
+/**
+ * @brief copy of a received message, e.g. to hand it to another task
+ */
+struct SerialMessage
+{
+    static constexpr size_t max_payload = 256;
+
+    uint32_t command;
+    uint16_t length;
+    uint32_t enqueued; // [us] micros() when it was queued
+    uint8_t payload[max_payload];
+
+    /**
+     * @brief copies the payload into a message struct
+     *
+     * @return false if the payload length does not match the struct
+     */
+    template <typename T>
+    bool decode(T &msg) const
+    {
+        if (length != sizeof(T))
+            return false;
+        memcpy(&msg, payload, sizeof(T));
+        return true;
+    }
+};
+
+class SerialProtocol
+{
+public:
+    static constexpr size_t max_payload = SerialMessage::max_payload;
+    static constexpr size_t max_message = sizeof(uint32_t) + max_payload + sizeof(uint16_t);
+    static constexpr size_t max_frame = max_message + max_message / 254 + 2; // cobs overhead and delimiter
+
+    bool feed(uint8_t byte);
+    uint32_t command() const;
+    const uint8_t *payload() const;
+    size_t payloadLength() const;
+    void message(SerialMessage &msg) const;
+
+    /**
+     * @brief copies the received payload into a message struct
+     *
+     * @return false if the payload length does not match the struct
+     */
+    template <typename T>
+    bool decode(T &msg) const
+    {
+        if (payloadLength() != sizeof(T))
+            return false;
+        memcpy(&msg, payload(), sizeof(T));
+        return true;
+    }
+
+    static size_t encode(uint32_t command, const void *payload, size_t length, uint8_t *out, size_t outSize);
+    static uint16_t crc16(const uint8_t *data, size_t length, uint16_t crc = 0xFFFF);
+
+    uint32_t frames() const;
+    uint32_t crcErrors() const;
+    uint32_t framingErrors() const;
+
+private:
+    uint8_t m_buffer[max_message];
+    size_t m_length{0};
+    uint8_t m_remaining{0};  // data bytes left in the current cobs block
+    bool m_zeroPending{false};
+    bool m_discard{false};   // skip until the next delimiter
+    size_t m_messageLength{0};
+    uint32_t m_frames{0};
+    uint32_t m_crcErrors{0};
+    uint32_t m_framingErrors{0};
+
+    bool finish();
+    void put(uint8_t byte);
+};
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <Arduino.h>
+#include <cstddef>
+#include <cstdint>
+
+// outbound ring of the framed messages to the pc-compagnion
+// the messages of a loop pass are queued as whole frames and go out together, each pass drains as much as the uart
+// tx fifo takes without waiting, so a slow or absent host never stalls the loop. a frame which doesn't fit is
+// dropped as a whole, the frames already queued stay intact.
+
+
+struct SerialTxStats
+{
+    uint32_t frames;        // queued
+    uint32_t framesDropped; // didn't fit into the ring
+    uint32_t bytesDropped;
+    uint32_t writes;        // uart writes, each carries what the tx fifo took at once
+    uint16_t queued;        // [bytes] waiting for the uart
+    uint16_t highWater;     // [bytes] most ever queued
+    uint16_t capacity;      // [bytes]
+};
+
+class SerialTx
+{
+public:
+    static constexpr size_t capacity = 2048;
+
+    SerialTx(HardwareSerial &serial, unsigned long baud) : m_serial(serial), m_baud(baud) {};
+
+    bool queue(const uint8_t *frame, size_t length);
+    size_t drain();
+    size_t queued() const;
+    size_t room() const;
+    unsigned long nextDeadline(unsigned long now) const;
+    SerialTxStats stats() const;
+
+private:
+    static constexpr size_t uart_fifo = 128; // [bytes] esp32 uart tx fifo
+
+    HardwareSerial &m_serial;
+    const unsigned long m_baud;
+    uint8_t m_ring[capacity];
+    size_t m_head{0}; // next byte to queue, free running
+    size_t m_tail{0}; // next byte to write, free running
+    SerialTxStats m_stats{};
+};
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstdint>
+
+// one consistent set of telemetry values, produced by Data::acquire() and read by every consumer
+
+
+struct __attribute__((packed)) TelemetrySnapshot
+{
+    uint32_t timestamp;   // [ms] millis() of the acquisition
+    uint32_t climateTime; // [ms] millis() of the dht11 reading
+    uint16_t intvoltage;  // [mV]
+    int16_t temperature;  // [0.1°C]
+    uint8_t humidity;     // [%]
+    uint8_t battPercent;  // [%]
+    uint8_t status;       // bit n is TelemetryDigitalId n
+    uint8_t aprsPacketSeq;
+    uint8_t climateValid; // 1 once the dht11 delivered a valid frame
+};
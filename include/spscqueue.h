@@ -0,0 +1,72 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// bounded lock free queue for exactly one producer and one consumer task
+// head is only written by the producer, tail only by the consumer, the release/acquire pair publishes the slot.
+
+
+template <typename T, size_t N>
+class SpscQueue
+{
+    static_assert(N > 0 && (N & (N - 1)) == 0, "capacity must be a power of two");
+
+public:
+    static constexpr size_t capacity = N;
+
+    /**
+     * @brief producer side
+     *
+     * @return false if the queue is full, the item is dropped and counted
+     */
+    bool push(const T &item)
+    {
+        const auto head = m_head.load(std::memory_order_relaxed);
+        if (head - m_tail.load(std::memory_order_acquire) == N)
+        {
+            m_drops.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        m_items[head & (N - 1)] = item;
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief consumer side
+     *
+     * @return false if the queue is empty
+     */
+    bool pop(T &item)
+    {
+        const auto tail = m_tail.load(std::memory_order_relaxed);
+        if (m_head.load(std::memory_order_acquire) == tail)
+            return false;
+        item = m_items[tail & (N - 1)];
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    size_t size() const
+    {
+        return m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_acquire);
+    }
+
+    bool empty() const
+    {
+        return size() == 0;
+    }
+
+    uint32_t drops() const
+    {
+        return m_drops.load(std::memory_order_relaxed);
+    }
+
+private:
+    T m_items[N];
+    std::atomic<uint32_t> m_head{0}; // next slot to write
+    std::atomic<uint32_t> m_tail{0}; // next slot to read
+    std::atomic<uint32_t> m_drops{0};
+};
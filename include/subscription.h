@@ -0,0 +1,27 @@
+#pragma once
+
+#include <interface.h>
+#include <snapshot.h>
+
+// push mode for the PC-Compagnion: sends esp_delta_message on change instead of waiting to be polled
+
+
+class Subscription
+{
+public:
+    void configure(const esp_subscribe_message &msg);
+    void cancel();
+    bool active() const;
+    bool poll(unsigned long now, const TelemetrySnapshot &data, esp_delta_message &msg);
+    unsigned long nextDeadline(unsigned long now) const;
+
+private:
+    bool m_active{false};
+    bool m_initial{false}; // next poll sends a full message
+    uint16_t m_voltageThreshold{0};
+    int16_t m_temperatureThreshold{0};
+    uint8_t m_humidityThreshold{0};
+    unsigned long m_heartbeatInterval{0};
+    unsigned long m_lastSent{0};
+    esp_delta_message m_last{};
+};
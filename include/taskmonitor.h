@@ -0,0 +1,30 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// per task figures for the DUALCORE mode: free stack and worst queue latency
+// the monitored task writes the counters, the loop reads them, so they are atomic words.
+
+
+class TaskMonitor
+{
+public:
+    TaskMonitor(const char *name) : m_name(name) {};
+
+    void attach(void *handle);
+    void attachCurrent();
+    void pass();
+    void served(uint32_t enqueued);
+    const char *name() const;
+    void *handle() const;
+    uint32_t stackFree() const;
+    uint32_t worstLatency() const;
+    uint32_t runs() const;
+
+private:
+    const char *m_name;
+    void *m_handle{nullptr};
+    std::atomic<uint32_t> m_runs{0};
+    std::atomic<uint32_t> m_worstLatency{0}; // [us]
+};
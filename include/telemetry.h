@@ -0,0 +1,240 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// aprs telemetry channel table
+// the PARM/UNIT/EQNS/BITS message texts are generated from this table at compile time and the
+// same coefficients scale the values of the T# reports, so metadata and data can not drift apart.
+
+
+/**
+ * @brief exact decimal number, e.g. {1, 2} is 0.01
+ */
+struct TelemetryDecimal
+{
+    int32_t mantissa;
+    uint8_t decimals;
+
+    constexpr double value() const
+    {
+        double v = mantissa;
+        for (uint8_t i = 0; i < decimals; ++i)
+            v /= 10;
+        return v;
+    }
+};
+
+/**
+ * @brief analog channel, the aprs equation is a*x^2 + b*x + c
+ */
+struct TelemetryAnalogChannel
+{
+    const char *name;
+    const char *unit;
+    TelemetryDecimal a;
+    TelemetryDecimal b;
+    TelemetryDecimal c;
+};
+
+/**
+ * @brief digital channel
+ */
+struct TelemetryDigitalChannel
+{
+    const char *name;
+    const char *unit;
+    bool activeHigh;
+};
+
+// index into TelemetryTable::analog, order of the T# values
+enum TelemetryAnalogId : uint8_t
+{
+    tlm_vbatt,
+    tlm_capacity,
+    tlm_temperature,
+    tlm_humidity,
+    tlm_analog_count
+};
+
+// index into TelemetryTable::digital, order of the T# bits
+enum TelemetryDigitalId : uint8_t
+{
+    tlm_usbpower,
+    tlm_mainspower,
+    tlm_pcconnected,
+    tlm_uplink,
+    tlm_echolink,
+    tlm_digital_count
+};
+
+/**
+ * @brief null terminated text with a length known at compile time, lives in flash
+ */
+template <size_t N>
+struct TelemetryText
+{
+    static constexpr size_t length = N;
+    char text[N + 1];
+};
+
+/**
+ * @brief writes (or only counts, if out is nullptr) the generated metadata texts
+ */
+struct TelemetryTextWriter
+{
+    char *out;
+    size_t pos;
+
+    constexpr void put(char c)
+    {
+        if (out)
+            out[pos] = c;
+        ++pos;
+    }
+    constexpr void put(const char *str)
+    {
+        while (*str)
+            put(*str++);
+    }
+    constexpr void put(TelemetryDecimal d)
+    {
+        uint32_t magnitude = d.mantissa < 0 ? -d.mantissa : d.mantissa;
+        uint32_t scale = 1;
+        for (uint8_t i = 0; i < d.decimals; ++i)
+            scale *= 10;
+        if (d.mantissa < 0)
+            put('-');
+        put(magnitude / scale);
+        if (d.decimals)
+        {
+            put('.');
+            auto fraction = magnitude % scale;
+            for (scale /= 10; scale; scale /= 10)
+            {
+                put(static_cast<char>('0' + fraction / scale));
+                fraction %= scale;
+            }
+        }
+    }
+    constexpr void put(uint32_t value)
+    {
+        uint32_t scale = 1;
+        while (value / scale >= 10)
+            scale *= 10;
+        for (; scale; scale /= 10)
+            put(static_cast<char>('0' + value / scale % 10));
+    }
+};
+
+struct TelemetryTable
+{
+    static constexpr size_t aprs_analog_channels = 5;  // T# reports carry 5 analog values
+    static constexpr size_t aprs_digital_channels = 8; // and 8 bits
+    static constexpr uint16_t raw_min = 0;
+    static constexpr uint16_t raw_max = 255;
+
+    // clang-format off
+    static constexpr TelemetryAnalogChannel analog[tlm_analog_count] = {
+        {"Vbatt",       "Vdc",     {0, 0}, {1, 2}, {25, 1}},
+        {"Capacity",    "%",       {0, 0}, {1, 0}, {0, 0}},
+        {"Temperature", "Celsius", {0, 0}, {1, 0}, {-100, 0}},
+        {"Humidity",    "%",       {0, 0}, {1, 0}, {0, 0}},
+    };
+
+    static constexpr TelemetryDigitalChannel digital[tlm_digital_count] = {
+        {"USBPower", "UP", true},
+        {"240V",     "UP", true},
+        {"PCconn",   "UP", true},
+        {"Uplink",   "UP", true},
+        {"Echolink", "UP", true},
+    };
+    // clang-format on
+
+    static constexpr const char *project_title = "HB9GL-R telemetry by HB9HDG";
+
+    static int encode(TelemetryAnalogId id, float value);
+};
+
+/**
+ * @brief "PARM." or "UNIT." followed by all analog slots and the digital channels
+ */
+constexpr void telemetry_write_labels(TelemetryTextWriter &w, bool units)
+{
+    w.put(units ? "UNIT." : "PARM.");
+    for (size_t i = 0; i < TelemetryTable::aprs_analog_channels; ++i)
+    {
+        if (i)
+            w.put(',');
+        if (i < tlm_analog_count)
+            w.put(units ? TelemetryTable::analog[i].unit : TelemetryTable::analog[i].name);
+    }
+    for (size_t i = 0; i < tlm_digital_count; ++i)
+    {
+        w.put(',');
+        w.put(units ? TelemetryTable::digital[i].unit : TelemetryTable::digital[i].name);
+    }
+}
+
+constexpr void telemetry_write_parm(TelemetryTextWriter &w)
+{
+    telemetry_write_labels(w, false);
+}
+
+constexpr void telemetry_write_unit(TelemetryTextWriter &w)
+{
+    telemetry_write_labels(w, true);
+}
+
+/**
+ * @brief "EQNS." followed by a,b,c of every analog channel
+ */
+constexpr void telemetry_write_eqns(TelemetryTextWriter &w)
+{
+    w.put("EQNS.");
+    for (size_t i = 0; i < tlm_analog_count; ++i)
+    {
+        if (i)
+            w.put(',');
+        w.put(TelemetryTable::analog[i].a);
+        w.put(',');
+        w.put(TelemetryTable::analog[i].b);
+        w.put(',');
+        w.put(TelemetryTable::analog[i].c);
+    }
+}
+
+/**
+ * @brief "BITS." followed by the 8 bit sense flags and the project title
+ */
+constexpr void telemetry_write_bits(TelemetryTextWriter &w)
+{
+    w.put("BITS.");
+    for (size_t i = 0; i < TelemetryTable::aprs_digital_channels; ++i)
+        w.put(i >= tlm_digital_count || TelemetryTable::digital[i].activeHigh ? '1' : '0');
+    w.put(',');
+    w.put(TelemetryTable::project_title);
+}
+
+template <void (*Generate)(TelemetryTextWriter &)>
+constexpr size_t telemetry_text_length()
+{
+    TelemetryTextWriter w{nullptr, 0};
+    Generate(w);
+    return w.pos;
+}
+
+template <void (*Generate)(TelemetryTextWriter &)>
+constexpr TelemetryText<telemetry_text_length<Generate>()> telemetry_make_text()
+{
+    TelemetryText<telemetry_text_length<Generate>()> t{};
+    TelemetryTextWriter w{t.text, 0};
+    Generate(w);
+    return t;
+}
+
+// generated aprs message texts
+inline constexpr auto telemetry_parm = telemetry_make_text<telemetry_write_parm>();
+inline constexpr auto telemetry_unit = telemetry_make_text<telemetry_write_unit>();
+inline constexpr auto telemetry_eqns = telemetry_make_text<telemetry_write_eqns>();
+inline constexpr auto telemetry_bits = telemetry_make_text<telemetry_write_bits>();
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// fixed capacity frame queue feeding the LoRa transmitter
+
+
+// lower value is sent first
+enum TxPriority : uint8_t
+{
+    tx_priority_status,   // telemetry triggered by a status change
+    tx_priority_digipeat, // repeated frame, late copies are useless
+    tx_priority_data,     // periodic telemetry
+    tx_priority_position, // position beacon
+    tx_priority_metadata, // PARM/UNIT/EQNS/BITS
+};
+
+/**
+ * @brief one queued LoRa frame (aprs payload without the lora-aprs header)
+ */
+struct TxFrame
+{
+    static constexpr size_t max_length = 252; // 255 byte lora payload minus the 3 byte "<\xFF\x01" header
+    uint8_t length;
+    uint8_t data[max_length];
+    TxPriority priority;
+    uint32_t order; // fifo order within the same priority
+};
+
+/**
+ * @brief TxFrame slots handed out by priority, the selected frame can be marked as in flight while the radio
+ * sends it
+ */
+class TxQueue
+{
+public:
+    static constexpr size_t capacity = 8;
+
+    bool push(const uint8_t *data, size_t length, TxPriority priority = tx_priority_data);
+    const TxFrame *peek() const;
+    const TxFrame *begin_tx();
+    void complete_tx();
+    const TxFrame *inFlight() const;
+    size_t depth() const;
+    bool empty() const;
+    uint32_t drops() const;
+    uint32_t sent() const;
+
+private:
+    TxFrame m_frames[capacity];
+    bool m_used[capacity]{};
+    size_t m_count{0};
+    int m_inFlight{-1};
+    uint32_t m_order{0};
+    uint32_t m_drops{0};
+    uint32_t m_sent{0};
+
+    int select(bool lowest) const;
+};
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <functional>
+#include <string>
+#include <type_traits>
+
+// Arduino core shim for the host simulation, only what the firmware uses
+
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+#define RISING 0x01
+#define FALLING 0x02
+#define CHANGE 0x03
+#define IRAM_ATTR
+
+using std::isnan;
+typedef uint8_t byte;
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+int digitalRead(uint8_t pin);
+void digitalWrite(uint8_t pin, uint8_t level);
+void pinMode(uint8_t pin, uint8_t mode);
+uint16_t analogRead(uint8_t pin);
+int digitalPinToInterrupt(uint8_t pin);
+void attachInterrupt(uint8_t interrupt, void (*isr)(), int mode);
+void detachInterrupt(uint8_t interrupt);
+void noInterrupts();
+void interrupts();
+
+class String
+{
+public:
+    String(const char *text = "") : m_text(text ? text : "") {};
+    String(const std::string &text) : m_text(text) {};
+    template <typename T, typename = typename std::enable_if<std::is_arithmetic<T>::value>::type>
+    String(T value) : m_text(std::to_string(value)) {};
+
+    const char *c_str() const { return m_text.c_str(); }
+    unsigned int length() const { return m_text.size(); }
+    String substring(unsigned int from, unsigned int to) const { return String(m_text.substr(from, to - from)); }
+    String operator+(const String &other) const { return String(m_text + other.m_text); }
+
+private:
+    std::string m_text;
+};
+
+typedef std::function<void(void)> OnReceiveCb;
+
+class HardwareSerial
+{
+public:
+    void begin(unsigned long baud);
+    int available();
+    int availableForWrite();
+    int read();
+    size_t write(uint8_t byte);
+    size_t write(const uint8_t *data, size_t length);
+    void flush();
+    void onReceive(OnReceiveCb function, bool onlyOnTimeout = false);
+
+    size_t print(const char *text);
+    size_t print(const String &text);
+    template <typename T, typename = typename std::enable_if<std::is_arithmetic<T>::value>::type>
+    size_t print(T value)
+    {
+        return print(std::to_string(value).c_str());
+    }
+    template <typename T>
+    size_t println(const T &value)
+    {
+        return print(value) + println();
+    }
+    size_t println();
+};
+
+extern HardwareSerial Serial;
+
+class EspClass
+{
+public:
+    void restart();
+    uint32_t getCycleCount();
+    uint32_t getCpuFreqMHz();
+    uint32_t getFreeHeap();
+};
+
+extern EspClass ESP;
+
+/**
+ * @brief thrown by EspClass::restart(), ends the simulated run
+ */
+struct SimRestart
+{
+};
+
+void setup();
+void loop();
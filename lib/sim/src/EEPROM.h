@@ -0,0 +1,21 @@
+#pragma once
+
+#include <Arduino.h>
+
+// EEPROM emulation shim for the host simulation, starts erased like a fresh flash
+
+
+class EEPROMClass
+{
+public:
+    bool begin(size_t size);
+    uint8_t read(int address);
+    void write(int address, uint8_t value);
+    bool commit();
+
+private:
+    uint8_t m_data[4096];
+    size_t m_size{0};
+};
+
+extern EEPROMClass EEPROM;
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <Arduino.h>
+#include <SPI.h>
+
+// sandeepmistry LoRa shim for the host simulation
+// the time on air is computed here from the modem settings, independent of the firmware's airtime.h.
+// endPacket(true) raises DIO0 when the frame is on air, isTransmitting() clears it like the TX_DONE irq flag.
+// frames from sim_lora_receive() raise DIO0 while the radio listens in receive(), parsePacket() clears it.
+
+
+#define LORA_DEFAULT_SS_PIN 10
+#define LORA_DEFAULT_RESET_PIN 9
+#define LORA_DEFAULT_DIO0_PIN 2
+#define PA_OUTPUT_RFO_PIN 0
+#define PA_OUTPUT_PA_BOOST_PIN 1
+
+class LoRaClass
+{
+public:
+    int begin(long frequency);
+    void end();
+
+    int beginPacket(int implicitHeader = false);
+    int endPacket(bool async = false);
+
+    int parsePacket(int size = 0);
+    int packetRssi();
+    float packetSnr();
+    long packetFrequencyError();
+
+    size_t write(uint8_t byte);
+    size_t write(const uint8_t *buffer, size_t size);
+    int available();
+    int read();
+    int peek();
+
+    void onReceive(void (*callback)(int));
+    void onTxDone(void (*callback)());
+    void receive(int size = 0);
+    void idle();
+    void sleep();
+
+    void setTxPower(int level, int outputPin = PA_OUTPUT_PA_BOOST_PIN);
+    void setFrequency(long frequency);
+    void setSpreadingFactor(int sf);
+    void setSignalBandwidth(long sbw);
+    void setCodingRate4(int denominator);
+    void setPreambleLength(long length);
+    void setSyncWord(int sw);
+    void enableCrc();
+    void disableCrc();
+    void setPins(int ss = LORA_DEFAULT_SS_PIN, int reset = LORA_DEFAULT_RESET_PIN, int dio0 = LORA_DEFAULT_DIO0_PIN);
+
+    bool isTransmitting();
+
+    /**
+     * @brief time on air of a frame with the current modem settings
+     *
+     * @return uint64_t [us]
+     */
+    uint64_t airtime(size_t length) const;
+
+private:
+    int m_dio0{LORA_DEFAULT_DIO0_PIN};
+    int m_spreadingFactor{7};
+    long m_bandwidth{125000};
+    int m_codingRate{5};
+    long m_preamble{8};
+    bool m_crc{false};
+    bool m_implicitHeader{false};
+    size_t m_length{0};
+    uint64_t m_txEnd{0};
+};
+
+extern LoRaClass LoRa;
+
+void sim_lora_receive(const uint8_t *data, size_t length, int rssi, float snr);
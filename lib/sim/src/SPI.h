@@ -0,0 +1,14 @@
+#pragma once
+
+#include <Arduino.h>
+
+// SPI shim for the host simulation, the radio is simulated above the bus
+
+
+class SPIClass
+{
+public:
+    void begin(int8_t sck = -1, int8_t miso = -1, int8_t mosi = -1, int8_t ss = -1);
+};
+
+extern SPIClass SPI;
@@ -0,0 +1,8 @@
+#pragma once
+
+#include <SSD1306Wire.h>
+
+// ThingPulse SSD1306 shim for the host simulation
+
+
+typedef SSD1306Wire SSD1306;
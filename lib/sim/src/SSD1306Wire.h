@@ -0,0 +1,101 @@
+#pragma once
+
+#include <Arduino.h>
+#include <Wire.h>
+
+// ThingPulse OLEDDisplay/SSD1306Wire shim for the host simulation
+// drawing works on a real 128x64 page buffer, text uses a fixed 6x10 cell pattern derived from the character.
+// display() sends the bounding box of the changed bytes like the double buffered driver and counts the i2c bytes.
+// the panel memory is shared with the SSD1306 model behind the Wire shim, raw transmissions land there as well.
+
+
+enum OLEDDISPLAY_COLOR
+{
+    BLACK = 0,
+    WHITE = 1,
+    INVERSE = 2
+};
+
+enum OLEDDISPLAY_TEXT_ALIGNMENT
+{
+    TEXT_ALIGN_LEFT = 0,
+    TEXT_ALIGN_RIGHT = 1,
+    TEXT_ALIGN_CENTER = 2,
+    TEXT_ALIGN_CENTER_BOTH = 3
+};
+
+enum OLEDDISPLAY_GEOMETRY
+{
+    GEOMETRY_128_64 = 0,
+};
+
+enum HW_I2C
+{
+    I2C_ONE,
+    I2C_TWO
+};
+
+extern const uint8_t ArialMT_Plain_10[];
+extern const uint8_t ArialMT_Plain_16[];
+extern const uint8_t ArialMT_Plain_24[];
+
+class OLEDDisplay
+{
+public:
+    static constexpr int16_t display_width = 128;
+    static constexpr int16_t display_height = 64;
+    static constexpr size_t buffer_size = display_width * display_height / 8;
+
+    virtual ~OLEDDisplay() = default;
+
+    bool init();
+    void end();
+    void resetDisplay();
+    void clear();
+    void displayOn();
+    void displayOff();
+    void flipScreenVertically();
+    void setBrightness(uint8_t brightness);
+    void setContrast(uint8_t contrast, uint8_t precharge = 241, uint8_t comdetect = 64);
+
+    void setColor(OLEDDISPLAY_COLOR color);
+    OLEDDISPLAY_COLOR getColor();
+    void setPixel(int16_t x, int16_t y);
+    void clearPixel(int16_t x, int16_t y);
+    void drawHorizontalLine(int16_t x, int16_t y, int16_t length);
+    void drawVerticalLine(int16_t x, int16_t y, int16_t length);
+    void drawRect(int16_t x, int16_t y, int16_t width, int16_t height);
+    void fillRect(int16_t x, int16_t y, int16_t width, int16_t height);
+
+    void setTextAlignment(OLEDDISPLAY_TEXT_ALIGNMENT textAlignment);
+    void setFont(const uint8_t *fontData);
+    uint16_t drawString(int16_t x, int16_t y, const String &text);
+    uint16_t getStringWidth(const String &text);
+
+    int16_t width() const { return display_width; }
+    int16_t height() const { return display_height; }
+
+    virtual void display() = 0;
+
+    uint8_t buffer[buffer_size]{};
+
+protected:
+    OLEDDISPLAY_COLOR m_color{WHITE};
+    OLEDDISPLAY_TEXT_ALIGNMENT m_alignment{TEXT_ALIGN_LEFT};
+
+    virtual bool connect() = 0;
+    void transfer(size_t bytes);
+};
+
+class SSD1306Wire : public OLEDDisplay
+{
+public:
+    SSD1306Wire(uint8_t address, int sda = -1, int scl = -1, OLEDDISPLAY_GEOMETRY g = GEOMETRY_128_64,
+                HW_I2C i2cBus = I2C_ONE, int frequency = 700000);
+
+    bool connect() override;
+    void display() override;
+
+private:
+    uint8_t m_address;
+};
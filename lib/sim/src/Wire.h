@@ -0,0 +1,29 @@
+#pragma once
+
+#include <Arduino.h>
+
+// I2C shim for the host simulation
+// transmissions go to the SSD1306 model of peripherals.cpp, the only device on the bus. the display driver shim
+// counts its own bus traffic.
+
+
+class TwoWire
+{
+public:
+    static constexpr size_t buffer_length = 128; // arduino-esp32 I2C_BUFFER_LENGTH
+
+    bool begin(int sda = -1, int scl = -1, uint32_t frequency = 0);
+    void setClock(uint32_t frequency);
+
+    void beginTransmission(uint8_t address);
+    uint8_t endTransmission(bool sendStop = true);
+    size_t write(uint8_t byte);
+    size_t write(const uint8_t *data, size_t length);
+
+private:
+    uint8_t m_address{0};
+    uint8_t m_buffer[buffer_length];
+    size_t m_length{0};
+};
+
+extern TwoWire Wire;
@@ -0,0 +1,99 @@
+#include <airtime.h>
+#include <airtimecheck.h>
+#include <check.h>
+#include <cmath>
+#include <cstdio>
+
+/**
+ * @brief modem settings of a case, the rest as in config.h
+ */
+static Settings::LoRa_settings modem(int16_t sf, unsigned long bw, int16_t cr)
+{
+    return Settings::LoRa_settings{433775000U, 20, 5, 19, 27, 18, 14, 26, sf, bw, cr, 8};
+}
+
+/**
+ * @brief time on air by known values: preamble 8, explicit header, crc on
+ * @note low data rate optimization as LoRaClass::setLdoFlag() decides it, 1000 / (BW / 2^SF) > 16 in integer
+ * math. the library leaves it off for SF11/125 kHz (16.384 ms symbols) where the Semtech calculator turns it on.
+ */
+static void model_checks(CheckCount &check)
+{
+    const struct
+    {
+        const char *name;
+        int16_t sf;
+        unsigned long bw;
+        int16_t cr;
+        size_t length;
+        double airtime; // [ms]
+    } cases[] = {
+        {"sf7_bw125_cr5_10", 7, 125000, 5, 10, 41.216},       // 40.25 symbols of 1.024 ms
+        {"sf7_bw125_cr6_255", 7, 125000, 6, 255, 475.392},    // longest frame
+        {"sf8_bw500_cr5_0", 8, 500000, 5, 0, 12.928},         // no payload: 8 + 1 block
+        {"sf9_bw125_cr5_20", 9, 125000, 5, 20, 185.344},
+        {"sf10_bw125_cr8_30", 10, 125000, 8, 30, 624.640},    // coding rate 4/8
+        {"sf11_bw250_cr5_25", 11, 250000, 5, 25, 370.688},
+        {"sf11_bw125_cr5_25", 11, 125000, 5, 25, 741.376},    // library: no low data rate optimization
+        {"sf12_bw125_cr5_0", 12, 125000, 5, 0, 663.552},      // negative payload term: 8 symbols only
+        {"sf12_bw125_cr5_51", 12, 125000, 5, 51, 2465.792},   // low data rate optimization
+        {"sf12_bw125_cr5_100", 12, 125000, 5, 100, 3940.352},
+    };
+    for (const auto &entry : cases)
+    {
+        const auto settings = modem(entry.sf, entry.bw, entry.cr);
+        const AirtimeModel model(settings);
+        const auto us = model.frame_us(entry.length);
+        const bool ok = fabs(us - entry.airtime * 1000) < 1 && model.frame_ms(entry.length) == ceil(entry.airtime);
+        if (!check(ok, entry.name))
+            printf("airtime_%s_us=%u expected %.0f\n", entry.name, us, entry.airtime * 1000);
+    }
+
+    const AirtimeModel sf7(modem(7, 125000, 5));
+    const AirtimeModel sf12(modem(12, 125000, 5));
+    check(sf7.symbol_us() == 1024 && sf12.symbol_us() == 32768, "symbol_time");
+
+    // one more byte never costs less, a block of SF bytes at most one block of symbols more
+    bool monotonic = true;
+    for (size_t length = 1; length <= 255; ++length)
+        monotonic = monotonic && sf12.frame_us(length) >= sf12.frame_us(length - 1) &&
+                    sf12.frame_us(length) - sf12.frame_us(length - 1) <= 5 * sf12.symbol_us();
+    check(monotonic, "monotonic");
+}
+
+/**
+ * @brief rolling window budget: 10% of 3600 s
+ */
+static void budget_checks(CheckCount &check)
+{
+    const Settings settings;
+    AirtimeBudget budget(settings.lora);
+    const unsigned long window = settings.lora.DutyCycleWindow * 1000UL;
+    const unsigned long bucket = window / AirtimeBudget::buckets;
+    check(budget.budget() == 360000, "budget");
+
+    budget.charge(1000, 200000);
+    budget.charge(window / 2, 159000);
+    check(budget.used(window / 2) == 359000, "budget_used");
+    check(budget.allows(window / 2, 1000) && !budget.allows(window / 2, 1001), "budget_limit");
+
+    // a charge leaves the window with its bucket, a window after the start of the bucket
+    check(budget.used(window - 1) == 359000, "budget_window_held");
+    check(budget.used(window) == 159000, "budget_window_rolled");
+    check(budget.used(window / 2 + window - 1) == 159000, "budget_window_second_held");
+    check(budget.used(window / 2 + window) == 0, "budget_window_empty");
+    check(budget.allows(window / 2 + window + bucket, budget.budget()), "budget_window_free");
+}
+
+/**
+ * @brief runs the checks
+ *
+ * @return int exit code, 1 if a check failed
+ */
+int airtime_check()
+{
+    CheckCount check;
+    model_checks(check);
+    budget_checks(check);
+    return check.report("airtime");
+}
@@ -0,0 +1,7 @@
+#pragma once
+
+// the lora time on air model on the host against known values of the Semtech SX1276 formula (AN1200.13) over
+// SF7-12, bandwidths, coding rates and payload lengths, and the rolling duty cycle budget
+
+
+int airtime_check();
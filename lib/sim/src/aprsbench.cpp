@@ -0,0 +1,154 @@
+#include <aprs.h>
+#include <aprsbench.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <new>
+#include <string>
+
+static size_t s_allocations = 0; // operator new calls of the whole program
+
+void *operator new(size_t size)
+{
+    ++s_allocations;
+    if (auto memory = malloc(size ? size : 1))
+        return memory;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *memory) noexcept
+{
+    free(memory);
+}
+
+void operator delete(void *memory, size_t) noexcept
+{
+    free(memory);
+}
+
+static const char *const callsign = "HB9HDG-13";
+static const char *const destcall = "APRS";
+
+/**
+ * @brief left pads like the helper of the old encoder
+ */
+static std::string lpad(const std::string &text, size_t width, char padding)
+{
+    return text.size() >= width ? text : std::string(width - text.size(), padding) + text;
+}
+
+static std::string rpad(const std::string &text, size_t width)
+{
+    return text.size() >= width ? text : text + std::string(width - text.size(), ' ');
+}
+
+/**
+ * @brief telemetry values of frame n
+ */
+static void values(unsigned n, int *analog, uint8_t &bits)
+{
+    analog[0] = static_cast<int>(n * 7 % 256);
+    analog[1] = static_cast<int>(n % 101);
+    analog[2] = static_cast<int>(80 + n % 60);
+    analog[3] = static_cast<int>(n * 3 % 100);
+    bits = static_cast<uint8_t>(n & 0x1F);
+}
+
+static const struct
+{
+    const char *name;
+    std::function<std::string(unsigned)> concatenated;
+    std::function<void(unsigned, AprsFrame &)> encoded;
+} frame_types[] = {
+    {"telemetry",
+     [](unsigned n) {
+         int analog[4];
+         uint8_t bits;
+         values(n, analog, bits);
+         std::string txbits = "00000";
+         for (size_t i = 0; i < txbits.size(); ++i)
+             txbits[i] = (bits & (1U << i)) ? '1' : '0';
+         return std::string(callsign) + ">" + destcall + ":T#" + lpad(std::to_string(n % 1000), 3, '0') + "," +
+                lpad(std::to_string(analog[0]), 3, '0') + "," + lpad(std::to_string(analog[1]), 3, '0') + "," +
+                lpad(std::to_string(analog[2]), 3, '0') + "," + lpad(std::to_string(analog[3]), 3, '0') + ",," +
+                txbits;
+     },
+     [](unsigned n, AprsFrame &frame) {
+         int analog[4];
+         uint8_t bits;
+         values(n, analog, bits);
+         frame.header(callsign, destcall).telemetry(static_cast<uint16_t>(n % 1000), analog, 4, bits, 5);
+     }},
+    {"message",
+     [](unsigned) {
+         return std::string(callsign) + ">" + destcall + "::" + rpad(callsign, 9) +
+                ":UNIT.Vdc,%,Celsius,%,,UP,UP,UP,UP,UP";
+     },
+     [](unsigned, AprsFrame &frame) {
+         frame.header(callsign, destcall).message(callsign).append("UNIT.Vdc,%,Celsius,%,,UP,UP,UP,UP,UP");
+     }},
+};
+
+/**
+ * @brief host time and allocations of frames built one way
+ *
+ * @param checksum keeps the compiler from dropping the work
+ * @return double [ns] per frame
+ */
+template <typename Build>
+static double measure(unsigned frames, size_t &allocations, uint32_t &checksum, Build build)
+{
+    const auto before = s_allocations;
+    const auto start = std::chrono::steady_clock::now();
+    for (unsigned n = 0; n < frames; ++n)
+        checksum += build(n);
+    const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    allocations = s_allocations - before;
+    return frames ? elapsed.count() / frames : 0;
+}
+
+/**
+ * @brief builds every frame type both ways, prints the time and the allocations per frame
+ *
+ * @param frames per frame type
+ * @return int exit code, 1 if the encoder allocates or its text differs from the concatenated one
+ */
+int aprs_benchmark(unsigned frames)
+{
+    uint32_t mismatches = 0;
+    size_t encoderAllocations = 0;
+    uint32_t checksum = 0;
+    for (const auto &type : frame_types)
+    {
+        for (unsigned n = 0; n < frames; ++n)
+        {
+            AprsFrame frame;
+            type.encoded(n, frame);
+            mismatches += type.concatenated(n) != std::string(reinterpret_cast<const char *>(frame.data()),
+                                                              frame.length());
+        }
+
+        size_t concatenatedAllocations;
+        size_t encodedAllocations;
+        const auto concatenatedNs = measure(frames, concatenatedAllocations, checksum, [&](unsigned n) {
+            return static_cast<uint32_t>(type.concatenated(n).size());
+        });
+        const auto encodedNs = measure(frames, encodedAllocations, checksum, [&](unsigned n) {
+            AprsFrame frame;
+            type.encoded(n, frame);
+            return static_cast<uint32_t>(frame.length() + frame.data()[frame.length() - 1]);
+        });
+        encoderAllocations += encodedAllocations;
+        printf("aprs_%s_concatenated_ns=%.0f\n", type.name, concatenatedNs);
+        printf("aprs_%s_concatenated_allocations=%.1f\n", type.name,
+               frames ? static_cast<double>(concatenatedAllocations) / frames : 0);
+        printf("aprs_%s_encoded_ns=%.0f\n", type.name, encodedNs);
+        printf("aprs_%s_encoded_allocations=%.1f\n", type.name,
+               frames ? static_cast<double>(encodedAllocations) / frames : 0);
+    }
+    printf("aprs_frames=%u\n", frames);
+    printf("aprs_checksum=%u\n", checksum);
+    printf("aprs_mismatches=%u\n", mismatches);
+    return mismatches || encoderAllocations ? 1 : 0;
+}
@@ -0,0 +1,7 @@
+#pragma once
+
+// AprsFrame on the host: time per frame and heap allocations of the telemetry and message frames, against the
+// std::string concatenation with lpad/rpad it replaced. both must produce the same text.
+
+
+int aprs_benchmark(unsigned frames);
@@ -0,0 +1,258 @@
+#include <aprs.h>
+#include <aprscheck.h>
+#include <aprsparser.h>
+#include <check.h>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief reference base-91 field: each character is 33 + digit, most significant first
+ *
+ * @return false if a character is out of range
+ */
+static bool reference_base91(std::string_view field, uint32_t &value)
+{
+    value = 0;
+    for (const auto c : field)
+    {
+        if (c < '!' || c > '{')
+            return false;
+        value = value * 91 + static_cast<uint32_t>(c - '!');
+    }
+    return true;
+}
+
+struct ReferenceTelemetry
+{
+    uint32_t sequence;
+    std::vector<uint32_t> analog;
+    bool hasBits;
+    uint32_t bits;
+};
+
+/**
+ * @brief reference decoder of base-91 comment telemetry in a frame: the first "|...|" of the information field,
+ * a sequence and 1..5 analog values of two characters each, the digital bits only after all five values
+ */
+static bool reference_telemetry(std::string_view frame, ReferenceTelemetry &telemetry)
+{
+    const auto info = frame.find(':');
+    if (info == std::string_view::npos)
+        return false;
+    const auto start = frame.find('|', info);
+    const auto end = start == std::string_view::npos ? start : frame.find('|', start + 1);
+    if (end == std::string_view::npos)
+        return false;
+    const auto field = frame.substr(start + 1, end - start - 1);
+    if (field.size() % 2 || field.size() < 4 || field.size() > 14)
+        return false;
+    std::vector<uint32_t> values;
+    for (size_t i = 0; i < field.size(); i += 2)
+    {
+        uint32_t value;
+        if (!reference_base91(field.substr(i, 2), value))
+            return false;
+        values.push_back(value);
+    }
+    telemetry.sequence = values[0];
+    telemetry.hasBits = values.size() == 7;
+    telemetry.bits = telemetry.hasBits ? values[6] : 0;
+    telemetry.analog.assign(values.begin() + 1, values.begin() + (telemetry.hasBits ? 6 : values.size()));
+    return true;
+}
+
+struct TelemetryCase
+{
+    uint32_t sequence;
+    std::vector<int> analog;
+    uint8_t bits;
+    size_t bitCount;
+};
+
+static std::string telemetry_frame(const TelemetryCase &input)
+{
+    AprsFrame frame;
+    frame.header("HB9GL-R", "APZHDG")
+        .append('>')
+        .compressedTelemetry(static_cast<uint16_t>(input.sequence), input.analog.data(), input.analog.size(),
+                             input.bits, input.bitCount);
+    return std::string(reinterpret_cast<const char *>(frame.data()), frame.length());
+}
+
+/**
+ * @brief what a receiver has to get back: the sequence modulo 8281, values clamped to 0..8280, channels padded to
+ * five when bits follow, at least one channel, the bits masked to bitCount
+ */
+static bool telemetry_roundtrip(const TelemetryCase &input)
+{
+    const auto text = telemetry_frame(input);
+    ReferenceTelemetry decoded;
+    if (!reference_telemetry(text, decoded))
+        return false;
+    if (decoded.sequence != input.sequence % (AprsFrame::base91_max + 1))
+        return false;
+    auto channels = input.bitCount ? AprsFrame::analog_channels : input.analog.size();
+    channels = channels ? channels > AprsFrame::analog_channels ? AprsFrame::analog_channels : channels : 1;
+    if (decoded.analog.size() != channels || decoded.hasBits != (input.bitCount > 0))
+        return false;
+    for (size_t i = 0; i < channels; ++i)
+    {
+        const auto value = i < input.analog.size() ? input.analog[i] : 0;
+        const auto expected = value < 0 ? 0U : std::min<uint32_t>(static_cast<uint32_t>(value), AprsFrame::base91_max);
+        if (decoded.analog[i] != expected)
+            return false;
+    }
+    if (input.bitCount && decoded.bits != (input.bits & ((1U << input.bitCount) - 1)))
+        return false;
+
+    // the firmware's own parser reads the same
+    AprsPacket packet{};
+    if (!AprsParser::parse(text, packet) || packet.type != aprs_telemetry || !packet.compressed ||
+        packet.sequence != decoded.sequence || packet.bits != decoded.bits)
+        return false;
+    for (size_t i = 0; i < decoded.analog.size(); ++i)
+    {
+        if (!(packet.analogMask & (1U << i)) || packet.analog[i] != static_cast<float>(decoded.analog[i]))
+            return false;
+    }
+    return true;
+}
+
+/**
+ * @brief known frames and random round trips of the compressed telemetry
+ */
+static void telemetry_checks(CheckCount &check)
+{
+    // worked out by hand: 4 = 0 * 91 + 4 "!%", 1472 = 16 * 91 + 16 "11", 4173 = 45 * 91 + 78 "No", 0xA9 "\"o"
+    const int known[] = {1472, 1564, 4173, 7544, 2};
+    AprsFrame frame;
+    frame.compressedTelemetry(4, known, 5, 0xA9, 8);
+    check(std::string_view(reinterpret_cast<const char *>(frame.data()), frame.length()) == "|!%1122Noss!#\"o|",
+          "telemetry_known_frame");
+
+    check(telemetry_roundtrip({0, {0, 0, 0, 0, 0}, 0, 8}), "telemetry_zero");
+    check(telemetry_roundtrip({8280, {8280, 8280, 8280, 8280, 8280}, 0xFF, 8}), "telemetry_max");
+    check(telemetry_roundtrip({8281, {1}, 0, 0}), "telemetry_sequence_wraps");
+    check(telemetry_roundtrip({65535, {1, 2}, 0, 0}), "telemetry_sequence_16_bit");
+    check(telemetry_roundtrip({7, {-5, 9000, 100000, -1, 3}, 0x5A, 8}), "telemetry_clamped");
+    check(telemetry_roundtrip({7, {161, 85}, 0x05, 3}), "telemetry_bits_pad_channels");
+    check(telemetry_roundtrip({7, {}, 0, 0}), "telemetry_one_channel");
+    check(telemetry_roundtrip({7, {1, 2, 3, 4, 5, 6}, 0, 0}), "telemetry_five_channels_at_most");
+
+    std::mt19937 random(17);
+    unsigned failed = 0;
+    for (unsigned n = 0; n < 10000; ++n)
+    {
+        TelemetryCase input{static_cast<uint32_t>(random() % 65536), std::vector<int>(random() % 6),
+                            static_cast<uint8_t>(random()), random() % 9};
+        for (auto &value : input.analog)
+            value = static_cast<int>(random() % 9000) - 200;
+        failed += !telemetry_roundtrip(input);
+    }
+    printf("aprs_telemetry_random_failed=%u\n", failed);
+    check(failed == 0, "telemetry_random");
+}
+
+struct ReferencePosition
+{
+    double latitude;
+    double longitude;
+    bool hasAltitude;
+    double altitude; // [m]
+    char table;
+    char symbol;
+};
+
+/**
+ * @brief reference decoder of a compressed position: table, 4 characters latitude 90 - y / 380926, 4 characters
+ * longitude -180 + x / 190463, symbol, cs and the compression type T. cs is an altitude of 1.002^cs feet when the
+ * nmea source bits of T are GGA.
+ */
+static bool reference_position(std::string_view text, ReferencePosition &position)
+{
+    uint32_t y, x, cs;
+    if (text.size() != AprsFrame::compressed_position_length || !reference_base91(text.substr(1, 4), y) ||
+        !reference_base91(text.substr(5, 4), x) || !reference_base91(text.substr(10, 2), cs) || text[12] < '!')
+        return false;
+    position.table = text[0];
+    position.symbol = text[9];
+    position.latitude = 90.0 - y / 380926.0;
+    position.longitude = -180.0 + x / 190463.0;
+    position.hasAltitude = ((text[12] - '!') & 0x18) == 0x10;
+    position.altitude = position.hasAltitude ? pow(1.002, cs) * 0.3048 : 0;
+    return true;
+}
+
+/**
+ * @brief encodes a position and decodes it back, within one base-91 step and the 0.2 % altitude steps
+ */
+static bool position_roundtrip(double latitude, double longitude, double altitude)
+{
+    AprsPosition encoded;
+    encoded.encode(latitude, longitude, altitude, '/', '-', true);
+    ReferencePosition decoded;
+    if (!reference_position(encoded.position(), decoded) || *encoded.altitude())
+        return false;
+    if (decoded.table != '/' || decoded.symbol != '-' || !decoded.hasAltitude)
+        return false;
+    if (fabs(decoded.latitude - latitude) > 1.01 / 380926 || fabs(decoded.longitude - longitude) > 1.01 / 190463)
+        return false;
+    // below a foot cs is 0, one foot
+    if (altitude < 0.3048 ? decoded.altitude > 0.31 : fabs(decoded.altitude - altitude) > altitude * 0.0011)
+        return false;
+
+    // the firmware's own parser reads the same
+    const auto text = std::string("HB9GL-R>APZHDG:!") + encoded.position();
+    AprsPacket packet{};
+    return AprsParser::parse(text, packet) && packet.type == aprs_position && packet.compressed &&
+           fabs(packet.latitude - decoded.latitude) < 1e-9 && fabs(packet.longitude - decoded.longitude) < 1e-9 &&
+           packet.hasAltitude && fabs(packet.altitude - decoded.altitude) < 1e-6;
+}
+
+/**
+ * @brief the spec example and round trips of the compressed position
+ */
+static void position_checks(CheckCount &check)
+{
+    // APRS 1.0.1 chapter 9: "/5L!!<*e7>7P[" is 49°30' N 72°45' W, cs and T differ here, they hold the altitude
+    AprsFrame frame;
+    frame.compressedPosition(49.5, -72.75, 100, '/', '>');
+    const std::string_view text(reinterpret_cast<const char *>(frame.data()), frame.length());
+    check(text.substr(0, 10) == "/5L!!<*e7>", "position_spec_example");
+    ReferencePosition decoded;
+    check(reference_position(text, decoded) && fabs(decoded.latitude - 49.5) < 1e-5 &&
+              fabs(decoded.longitude + 72.75) < 1e-5,
+          "position_spec_example_decoded");
+
+    check(position_roundtrip(47.0502, 8.3093, 436), "position_station");
+    check(position_roundtrip(0, 0, 0), "position_origin");
+    check(position_roundtrip(-33.8688, -70.6693, 567), "position_south_west");
+    check(position_roundtrip(89.9999, 179.9999, 8848), "position_north_east");
+    check(position_roundtrip(-90, -180, 1), "position_south_pole_date_line");
+    check(position_roundtrip(47, 8, 0.1), "position_altitude_below_one_foot");
+
+    std::mt19937 random(18);
+    std::uniform_real_distribution<double> latitude(-90, 90), longitude(-180, 180), altitude(0, 9000);
+    unsigned failed = 0;
+    for (unsigned n = 0; n < 10000; ++n)
+        failed += !position_roundtrip(latitude(random), longitude(random), altitude(random));
+    printf("aprs_position_random_failed=%u\n", failed);
+    check(failed == 0, "position_random");
+}
+
+/**
+ * @brief runs the checks
+ *
+ * @return int exit code, 1 if a check failed
+ */
+int aprs_check()
+{
+    CheckCount check;
+    telemetry_checks(check);
+    position_checks(check);
+    return check.report("aprs");
+}
@@ -0,0 +1,9 @@
+#pragma once
+
+// the compressed aprs encodings of AprsFrame decoded back by a reference decoder written from the specs, not by
+// AprsParser: base-91 comment telemetry "|ss1122334455xx|" (Base91 Comment Telemetry, APRS 1.2 addendum) over known
+// and random values, sequence wrap and clamping, and the compressed position "/YYYYXXXX$csT" (APRS 1.0.1 chapter 9)
+// back to coordinates and the altitude of the cs bytes. AprsParser must agree with the reference.
+
+
+int aprs_check();
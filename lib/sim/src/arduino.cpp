@@ -0,0 +1,273 @@
+#include <Arduino.h>
+#include <EEPROM.h>
+#include <SPI.h>
+#include <chrono>
+#include <Wire.h>
+#include <sim.h>
+
+static constexpr uint16_t adc_full_scale_mv = 3300; // ADC_ATTEN_DB_11, ideal
+static constexpr uint16_t adc_max = 4095;
+static constexpr uint16_t battery_divider = 2;      // on board 100k/100k divider
+static constexpr size_t uart_tx_fifo = 128;         // arduino core without tx ring buffer
+static constexpr uint32_t esp_cpu_mhz = 240;
+
+HardwareSerial Serial;
+EspClass ESP;
+SPIClass SPI;
+TwoWire Wire;
+EEPROMClass EEPROM;
+
+static const Settings board;
+static uint64_t s_uartNsPerByte = 86806; // 10 bits at 115200 baud
+static uint64_t s_uartIdleNs = 0;        // [ns] virtual time the tx fifo runs empty
+
+
+unsigned long millis()
+{
+    return static_cast<uint32_t>(Simulator::instance().now() / 1000);
+}
+
+/**
+ * @brief wraps after 71 minutes like the 32 bit micros() of the ESP32
+ */
+unsigned long micros()
+{
+    return static_cast<uint32_t>(Simulator::instance().now());
+}
+
+void delay(unsigned long ms)
+{
+    Simulator::instance().advance(static_cast<uint64_t>(ms) * 1000);
+}
+
+void delayMicroseconds(unsigned int us)
+{
+    Simulator::instance().advance(us);
+}
+
+void yield()
+{
+}
+
+int digitalRead(uint8_t pin)
+{
+    return Simulator::instance().pin(pin);
+}
+
+void digitalWrite(uint8_t pin, uint8_t level)
+{
+    Simulator::instance().setPin(pin, level);
+}
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+    auto &sim = Simulator::instance();
+    sim.driven(pin, mode == OUTPUT);
+    if (mode == INPUT_PULLUP)
+        sim.setPin(pin, HIGH);
+}
+
+/**
+ * @brief the battery pin reads half the battery voltage plus the scenario's noise, other pins read 0
+ */
+uint16_t analogRead(uint8_t pin)
+{
+    auto &sim = Simulator::instance();
+    if (pin != board.tlm.hall_sensor_pin)
+        return 0;
+    long raw = static_cast<long>(sim.battery_mv) / battery_divider * adc_max / adc_full_scale_mv;
+    if (sim.adcNoise)
+        raw += static_cast<long>(sim.random() % (2 * sim.adcNoise + 1)) - sim.adcNoise;
+    return static_cast<uint16_t>(raw < 0 ? 0 : raw > adc_max ? adc_max : raw);
+}
+
+int digitalPinToInterrupt(uint8_t pin)
+{
+    return pin;
+}
+
+void attachInterrupt(uint8_t interrupt, void (*isr)(), int mode)
+{
+    Simulator::instance().attach(interrupt, isr, mode);
+}
+
+void detachInterrupt(uint8_t interrupt)
+{
+    Simulator::instance().detach(interrupt);
+}
+
+// events only run while the firmware waits or is busy, never inside a critical section
+void noInterrupts()
+{
+}
+
+void interrupts()
+{
+}
+
+
+void HardwareSerial::begin(unsigned long baud)
+{
+    const auto drain = Simulator::instance().serialBaud;
+    s_uartNsPerByte = 10000000000ULL / (drain ? drain : baud);
+}
+
+int HardwareSerial::available()
+{
+    return static_cast<int>(Simulator::instance().serialRx.size());
+}
+
+/**
+ * @brief free space in the tx fifo, it drains at the baud rate of virtual time
+ */
+int HardwareSerial::availableForWrite()
+{
+    const auto now = Simulator::instance().now() * 1000;
+    if (s_uartIdleNs <= now)
+        return uart_tx_fifo;
+    const auto queued = (s_uartIdleNs - now + s_uartNsPerByte - 1) / s_uartNsPerByte;
+    return queued >= uart_tx_fifo ? 0 : static_cast<int>(uart_tx_fifo - queued);
+}
+
+int HardwareSerial::read()
+{
+    auto &rx = Simulator::instance().serialRx;
+    if (rx.empty())
+        return -1;
+    const auto byte = rx.front();
+    rx.pop_front();
+    return byte;
+}
+
+size_t HardwareSerial::write(uint8_t byte)
+{
+    return write(&byte, 1);
+}
+
+/**
+ * @brief blocks while the tx fifo is full, like the arduino core without a tx ring buffer
+ */
+size_t HardwareSerial::write(const uint8_t *data, size_t length)
+{
+    auto &sim = Simulator::instance();
+    for (size_t i = 0; i < length; ++i)
+    {
+        if (!availableForWrite())
+            sim.advance((s_uartIdleNs - (uart_tx_fifo - 1) * s_uartNsPerByte) / 1000 - sim.now() + 1);
+        const auto now = sim.now() * 1000;
+        s_uartIdleNs = (s_uartIdleNs > now ? s_uartIdleNs : now) + s_uartNsPerByte;
+    }
+    sim.serialOutput(data, length);
+    return length;
+}
+
+/**
+ * @brief waits until the tx fifo ran empty
+ */
+void HardwareSerial::flush()
+{
+    auto &sim = Simulator::instance();
+    const auto now = sim.now() * 1000;
+    if (s_uartIdleNs > now)
+        sim.advance((s_uartIdleNs - now + 999) / 1000);
+}
+
+void HardwareSerial::onReceive(OnReceiveCb function, bool onlyOnTimeout)
+{
+    Simulator::instance().onSerialReceive = function;
+}
+
+size_t HardwareSerial::print(const char *text)
+{
+    return write(reinterpret_cast<const uint8_t *>(text), strlen(text));
+}
+
+size_t HardwareSerial::print(const String &text)
+{
+    return print(text.c_str());
+}
+
+size_t HardwareSerial::println()
+{
+    return print("\r\n");
+}
+
+
+/**
+ * @brief ends the simulated run, setup() can't run twice on the same globals
+ */
+void EspClass::restart()
+{
+    ++Simulator::instance().metrics.restarts;
+    sim_log("ESP.restart()");
+    throw SimRestart{};
+}
+
+/**
+ * @brief virtual time in cycles, or the host's clock if the scenario asks for it
+ */
+uint32_t EspClass::getCycleCount()
+{
+    auto &sim = Simulator::instance();
+    if (sim.hostCycles)
+    {
+        const auto host = std::chrono::steady_clock::now().time_since_epoch();
+        return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(host).count() *
+                                     esp_cpu_mhz / 1000);
+    }
+    return static_cast<uint32_t>(sim.now() * esp_cpu_mhz);
+}
+
+uint32_t EspClass::getCpuFreqMHz()
+{
+    return esp_cpu_mhz;
+}
+
+uint32_t EspClass::getFreeHeap()
+{
+    return 200000;
+}
+
+
+void SPIClass::begin(int8_t sck, int8_t miso, int8_t mosi, int8_t ss)
+{
+}
+
+bool TwoWire::begin(int sda, int scl, uint32_t frequency)
+{
+    return true;
+}
+
+void TwoWire::setClock(uint32_t frequency)
+{
+}
+
+
+/**
+ * @brief a new eeprom reads 0 like the arduino core's nvs backed emulation
+ */
+bool EEPROMClass::begin(size_t size)
+{
+    if (size > sizeof(m_data))
+        return false;
+    if (!m_size)
+        memset(m_data, 0, sizeof(m_data));
+    m_size = size;
+    return true;
+}
+
+uint8_t EEPROMClass::read(int address)
+{
+    return address >= 0 && static_cast<size_t>(address) < m_size ? m_data[address] : 0;
+}
+
+void EEPROMClass::write(int address, uint8_t value)
+{
+    if (address >= 0 && static_cast<size_t>(address) < m_size)
+        m_data[address] = value;
+}
+
+bool EEPROMClass::commit()
+{
+    return m_size != 0;
+}
@@ -0,0 +1,208 @@
+#include <algorithm>
+#include <batterybench.h>
+#include <battery.h>
+#include <check.h>
+#include <chrono>
+#include <cmath>
+#include <config.h>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+static constexpr double adc_full_scale_mv = 3300; // ADC_ATTEN_DB_11, ideal, as the esp_adc_cal shim
+static constexpr double adc_max = 4095;
+
+struct BatteryTrace
+{
+    std::string name;
+    std::vector<uint16_t> reference;           // [mV] battery voltage of a burst
+    std::vector<std::vector<uint16_t>> bursts; // raw reads, the first BatteryMonitor::burst are used
+};
+
+/**
+ * @brief synthetic trace, gaussian noise and spikes on the ideal adc of a battery voltage curve
+ */
+static BatteryTrace synthetic(const char *name, unsigned samples, double sigma, double spikes,
+                              uint16_t (*voltage)(unsigned, unsigned))
+{
+    std::mt19937 random(11);
+    std::normal_distribution<double> noise(0, sigma);
+    std::uniform_real_distribution<double> uniform(0, 1);
+    BatteryTrace trace{name, {}, {}};
+    for (unsigned n = 0; n < samples; ++n)
+    {
+        const auto millivolts = voltage(n, samples);
+        trace.reference.push_back(millivolts);
+        std::vector<uint16_t> burst;
+        for (size_t i = 0; i < BatteryMonitor::burst; ++i)
+        {
+            auto raw = millivolts / BatteryMonitor::divider * adc_max / adc_full_scale_mv + noise(random);
+            if (uniform(random) < spikes)
+                raw += uniform(random) < 0.5 ? -400 : 400; // wifi/lora tx on the supply
+            burst.push_back(static_cast<uint16_t>(std::lround(raw < 0 ? 0 : raw > adc_max ? adc_max : raw)));
+        }
+        trace.bursts.push_back(burst);
+    }
+    return trace;
+}
+
+static std::vector<BatteryTrace> synthetic_traces()
+{
+    return {
+        synthetic("discharge", 2000, 25, 0.03,
+                  [](unsigned n, unsigned count) { return static_cast<uint16_t>(4200 - 900 * n / count); }),
+        synthetic("charger", 1000, 25, 0.03,
+                  [](unsigned n, unsigned) { return static_cast<uint16_t>(n < 500 ? 3700 : 4150); }),
+        synthetic("quiet", 1000, 5, 0, [](unsigned, unsigned) { return static_cast<uint16_t>(3900); }),
+    };
+}
+
+/**
+ * @brief reads a trace file, see batterybench.h
+ */
+static bool load(const char *path, std::vector<BatteryTrace> &traces)
+{
+    std::ifstream file(path);
+    if (!file)
+        return false;
+    BatteryTrace trace{"trace", {}, {}};
+    std::string line;
+    while (std::getline(file, line))
+    {
+        line = line.substr(0, line.find('#'));
+        std::istringstream words(line);
+        unsigned value;
+        if (!(words >> value))
+            continue;
+        std::vector<uint16_t> burst;
+        unsigned raw;
+        while (words >> raw)
+            burst.push_back(static_cast<uint16_t>(raw));
+        if (burst.empty())
+            return false;
+        trace.reference.push_back(static_cast<uint16_t>(value));
+        trace.bursts.push_back(burst);
+    }
+    traces.push_back(trace);
+    return !trace.bursts.empty();
+}
+
+struct BatteryError
+{
+    double mean{0}; // [mV] absolute
+    double max{0};  // [mV] absolute
+};
+
+/**
+ * @brief error of the outputs after the filter settled, the first samples and those after a step are skipped
+ */
+static BatteryError error(const BatteryTrace &trace, const std::vector<uint16_t> &output)
+{
+    BatteryError result;
+    unsigned counted = 0;
+    for (size_t n = 0; n < output.size(); ++n)
+    {
+        bool settling = false;
+        for (size_t k = 1; k <= 16 && k <= n && !settling; ++k)
+            settling = std::abs(trace.reference[n] - trace.reference[n - k]) > 50;
+        if (n < 16 || settling)
+            continue;
+        const auto difference = std::fabs(static_cast<double>(output[n]) - trace.reference[n]);
+        result.mean += difference;
+        result.max = std::max(result.max, difference);
+        ++counted;
+    }
+    result.mean = counted ? result.mean / counted : 0;
+    return result;
+}
+
+/**
+ * @brief samples until the output is within 20 mV of a step of the reference
+ */
+static int step_response(const BatteryTrace &trace, const std::vector<uint16_t> &output)
+{
+    for (size_t n = 1; n < output.size(); ++n)
+    {
+        if (std::abs(trace.reference[n] - trace.reference[n - 1]) <= 50)
+            continue;
+        for (size_t k = n; k < output.size(); ++k)
+        {
+            if (std::abs(output[k] - trace.reference[k]) <= 20)
+                return static_cast<int>(k - n);
+        }
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief runs every trace through the old single read and the filter steps of BatteryMonitor::sample()
+ *
+ * @param trace file of recorded bursts, nullptr for the synthetic traces
+ * @return int exit code, 1 if the filter is less accurate than the single read or the trace is unreadable
+ */
+int battery_benchmark(const char *trace)
+{
+    static const Settings board;
+    BatteryMonitor monitor(board.tlm.hall_sensor_pin);
+    monitor.init(); // the calibration table of the esp_adc_cal shim
+
+    std::vector<BatteryTrace> traces;
+    if (trace ? !load(trace, traces) : (traces = synthetic_traces()).empty())
+    {
+        printf("battery_trace_unreadable=%s\n", trace);
+        return 1;
+    }
+
+    CheckCount check;
+    uint32_t checksum = 0;
+    for (const auto &current : traces)
+    {
+        const auto samples = current.bursts.size();
+        std::vector<uint16_t> single(samples), scaled(samples), filtered(samples);
+
+        // before: one read, float, with the 1.1 correction of the uncalibrated adc and without it
+        auto start = std::chrono::steady_clock::now();
+        for (size_t n = 0; n < samples; ++n)
+            scaled[n] = static_cast<uint16_t>(float(current.bursts[n][0]) / 4095 * 2 * 3.3 * 1.1 * 1000);
+        const std::chrono::duration<double, std::nano> singleTime = std::chrono::steady_clock::now() - start;
+        for (size_t n = 0; n < samples; ++n)
+            single[n] = static_cast<uint16_t>(float(current.bursts[n][0]) / 4095 * 2 * 3.3 * 1000);
+
+        // after: the steps of BatteryMonitor::sample()
+        uint32_t ema = 0;
+        start = std::chrono::steady_clock::now();
+        for (size_t n = 0; n < samples; ++n)
+        {
+            uint16_t reads[BatteryMonitor::burst];
+            const auto count = std::min(current.bursts[n].size(), BatteryMonitor::burst);
+            std::copy_n(current.bursts[n].begin(), count, reads);
+            const auto value = static_cast<uint16_t>(monitor.to_millivolts(BatteryMonitor::median(reads, count)) *
+                                                     BatteryMonitor::divider);
+            ema = n ? BatteryMonitor::ema(ema, value) : static_cast<uint32_t>(value) << 16;
+            filtered[n] = static_cast<uint16_t>((ema + 0x8000) >> 16);
+            checksum += BatteryMonitor::to_percent(filtered[n]);
+        }
+        const std::chrono::duration<double, std::nano> filterTime = std::chrono::steady_clock::now() - start;
+
+        const auto singleError = error(current, single);
+        const auto scaledError = error(current, scaled);
+        const auto filterError = error(current, filtered);
+        const auto name = current.name.c_str();
+        printf("battery_%s_samples=%zu\n", name, samples);
+        printf("battery_%s_single_mean_error_mv=%.1f\n", name, singleError.mean);
+        printf("battery_%s_single_max_error_mv=%.0f\n", name, singleError.max);
+        printf("battery_%s_single_scaled_mean_error_mv=%.1f\n", name, scaledError.mean);
+        printf("battery_%s_filter_mean_error_mv=%.1f\n", name, filterError.mean);
+        printf("battery_%s_filter_max_error_mv=%.0f\n", name, filterError.max);
+        printf("battery_%s_filter_step_samples=%d\n", name, step_response(current, filtered));
+        printf("battery_%s_single_ns=%.0f\n", name, samples ? singleTime.count() / samples : 0);
+        printf("battery_%s_filter_ns=%.0f\n", name, samples ? filterTime.count() / samples : 0);
+        check(filterError.mean <= singleError.mean, name);
+    }
+    printf("battery_checksum=%u\n", checksum);
+    return check.report("battery");
+}
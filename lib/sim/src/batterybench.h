@@ -0,0 +1,9 @@
+#pragma once
+
+// BatteryMonitor on the host: cost and accuracy of the filter steps (median of the burst, calibration table, EMA)
+// against the single float read they replaced, over sample traces with a known battery voltage. the built in traces
+// are synthetic, a trace file of recorded bursts can be passed instead: per line the reference voltage [mV] and the
+// raw reads of one burst, '#' starts a comment.
+
+
+int battery_benchmark(const char *trace);
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdio>
+
+// bookkeeping of the host checks of the native program: a failed check prints check_failed=<name>, the summary
+// <prefix>_checks=<passed>/<count>
+
+
+class CheckCount
+{
+public:
+    /**
+     * @brief counts one check
+     *
+     * @return bool ok, to chain dependent checks
+     */
+    bool operator()(bool ok, const char *name)
+    {
+        ++m_count;
+        if (ok)
+            ++m_passed;
+        else
+            printf("check_failed=%s\n", name);
+        return ok;
+    }
+
+    /**
+     * @brief prints the summary
+     *
+     * @return int exit code, 1 if a check failed
+     */
+    int report(const char *prefix) const
+    {
+        printf("%s_checks=%u/%u\n", prefix, m_passed, m_count);
+        return m_passed == m_count ? 0 : 1;
+    }
+
+private:
+    unsigned m_count{0};
+    unsigned m_passed{0};
+};
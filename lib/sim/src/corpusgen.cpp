@@ -0,0 +1,357 @@
+#include <cctype>
+#include <cmath>
+#include <corpusgen.h>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+static const char *const prefixes[] = {"HB9", "HB3", "DL", "DO", "DB0", "OE", "F", "F4", "I", "IZ", "EA", "G", "M0",
+                                       "PA", "ON", "SP", "OK", "K", "W", "VE", "JA", "VK", "LU", "ZS"};
+static const char *const tocalls[] = {"APRS", "APLRT1", "APLRG1", "APDR16", "APDW17", "APMI06", "APN391", "APX219"};
+static const char *const servers[] = {"T2SWISS", "T2FRANCE", "T2UK", "T2SPAIN", "T2CZECH", "T2ROTATE", "FOURTH"};
+static const char *const words[] = {"LoRa", "iGate", "digi", "tracker", "mobile", "home", "wx", "station", "73",
+                                    "QRV", "145.500", "438.750", "HB9GL", "Monitoring", "solar", "battery", "on air",
+                                    "Gr\xc3\xbc" "sse", "25\xc2\xb0" "C", "test", "net", "tonight", "hello"};
+
+/**
+ * @brief random pieces of frames, one corpus per seed
+ */
+class Generator
+{
+public:
+    explicit Generator(unsigned seed) : m_random(seed) {}
+
+    /**
+     * @brief uniform integer in [low, high]
+     */
+    int uniform(int low, int high) { return std::uniform_int_distribution<int>(low, high)(m_random); }
+    bool chance(int percent) { return uniform(0, 99) < percent; }
+    template <typename T, size_t N> T pick(T (&list)[N]) { return list[uniform(0, N - 1)]; }
+
+    std::string call(bool ssid = true)
+    {
+        std::string text = pick(prefixes);
+        if (!isdigit(static_cast<unsigned char>(text.back())))
+            text += static_cast<char>('0' + uniform(0, 9));
+        const auto letters = uniform(1, 3);
+        for (int i = 0; i < letters; ++i)
+            text += static_cast<char>('A' + uniform(0, 25));
+        if (ssid && chance(75))
+            text += "-" + std::to_string(uniform(1, 15));
+        return text;
+    }
+
+    /**
+     * @brief path of the frame as a q construct of APRS-IS shows it, rf heard by an igate or sent to a server
+     */
+    std::string path()
+    {
+        if (chance(30))
+            return std::string(",TCPIP*,qAC,") + pick(servers);
+        std::string text;
+        switch (uniform(0, 4))
+        {
+        case 0:
+            break;
+        case 1:
+            text = ",WIDE1-1";
+            break;
+        case 2:
+            text = ",WIDE1-1,WIDE2-1";
+            break;
+        case 3:
+            text = "," + call() + "*,WIDE2-1";
+            break;
+        default:
+            text = "," + call() + "," + call() + "*,WIDE2*";
+            break;
+        }
+        return text + (chance(80) ? ",qAR," : ",qAO,") + call();
+    }
+
+    std::string comment(int maxWords)
+    {
+        std::string text;
+        const auto count = uniform(0, maxWords);
+        for (int i = 0; i < count; ++i)
+            text += (i ? " " : "") + std::string(pick(words));
+        return text;
+    }
+
+    std::string number(const char *format, double value)
+    {
+        char text[32];
+        snprintf(text, sizeof(text), format, value);
+        return text;
+    }
+
+    std::string timestamp()
+    {
+        char text[16];
+        if (chance(80))
+            snprintf(text, sizeof(text), "%02d%02d%02dz", uniform(1, 28), uniform(0, 23), uniform(0, 59));
+        else
+            snprintf(text, sizeof(text), "%02d%02d%02dh", uniform(0, 23), uniform(0, 59), uniform(0, 59));
+        return text;
+    }
+
+    /**
+     * @brief "DDMM.mmN/DDDMM.mmE" with the symbol, some digits replaced by spaces for position ambiguity
+     */
+    std::string position(char table, char code)
+    {
+        const auto latitude = uniform(-8999, 8999) / 100.0;
+        const auto longitude = uniform(-17999, 17999) / 100.0;
+        char text[48];
+        snprintf(text, sizeof(text), "%02d%05.2f%c%c%03d%05.2f%c%c", static_cast<int>(fabs(latitude)),
+                 fmod(fabs(latitude), 1) * 60, latitude < 0 ? 'S' : 'N', table, static_cast<int>(fabs(longitude)),
+                 fmod(fabs(longitude), 1) * 60, longitude < 0 ? 'W' : 'E', code);
+        if (chance(5))
+        {
+            const auto blanks = uniform(1, 4);
+            const int digits[] = {6, 5, 3, 2};
+            for (int i = 0; i < blanks; ++i)
+            {
+                text[digits[i]] = ' ';
+                text[digits[i] + 9] = ' ';
+            }
+        }
+        return text;
+    }
+
+    std::string base91(uint32_t value, int width)
+    {
+        std::string text(width, '!');
+        for (int i = width - 1; i >= 0; --i, value /= 91)
+            text[i] = static_cast<char>('!' + value % 91);
+        return text;
+    }
+
+    /**
+     * @brief "/YYYYXXXX$csT", the cs bytes course/speed, altitude, range or unused
+     */
+    std::string compressedPosition(char table, char code)
+    {
+        const auto latitude = uniform(-89000, 89000) / 1000.0;
+        const auto longitude = uniform(-179000, 179000) / 1000.0;
+        std::string text(1, table);
+        text += base91(static_cast<uint32_t>(380926 * (90 - latitude)), 4);
+        text += base91(static_cast<uint32_t>(190463 * (180 + longitude)), 4);
+        text += code;
+        switch (uniform(0, 3))
+        {
+        case 0:
+            return text + "  " + static_cast<char>('!' + 0x20); // no cs bytes
+        case 1:
+            return text + base91(uniform(0, 89), 1) + base91(uniform(0, 90), 1) + static_cast<char>('!' + 0x3B);
+        case 2:
+            return text + base91(uniform(0, 8280), 2) + static_cast<char>('!' + 0x32); // altitude of a gga fix
+        default:
+            return text + '{' + base91(uniform(0, 90), 1) + static_cast<char>('!' + 0x3B);
+        }
+    }
+
+    /**
+     * @brief "|ss11...|" base-91 comment telemetry with 1 to 5 values and sometimes the bits
+     */
+    std::string compressedTelemetry()
+    {
+        std::string text = "|" + base91(uniform(0, 8280), 2);
+        const auto values = uniform(1, 5);
+        for (int i = 0; i < values; ++i)
+            text += base91(uniform(0, 8280), 2);
+        if (values == 5 && chance(50))
+            text += base91(uniform(0, 255), 2);
+        return text + "|";
+    }
+
+    std::string telemetry()
+    {
+        std::string text = "T#";
+        text += chance(10) ? "MIC" : number("%03.0f", uniform(0, chance(10) ? 65535 : 999));
+        const auto values = uniform(1, 5);
+        for (int i = 0; i < 5; ++i)
+        {
+            text += ',';
+            if (i >= values || chance(5))
+                continue;
+            switch (uniform(0, 3))
+            {
+            case 0:
+                text += number("%.2f", uniform(-5000, 5000) / 100.0);
+                break;
+            case 1:
+                text += number("%.0f", uniform(0, 99999));
+                break;
+            default:
+                text += number("%03.0f", uniform(0, 255));
+                break;
+            }
+        }
+        text += ',';
+        const auto bits = chance(80) ? 8 : uniform(0, 8);
+        for (int i = 0; i < bits; ++i)
+            text += chance(50) ? '1' : '0';
+        return text;
+    }
+
+    /**
+     * @brief ":ADDRESSEE:" padded to nine characters
+     */
+    std::string addressee(const std::string &name)
+    {
+        return ":" + name + std::string(name.size() < 9 ? 9 - name.size() : 0, ' ') + ":";
+    }
+
+    /**
+     * @brief mic-e: the latitude in the destination, the longitude and course/speed in binary characters
+     */
+    std::string micE(std::string &destination)
+    {
+        destination.clear();
+        for (int i = 0; i < 6; ++i)
+            destination += static_cast<char>(chance(50) ? '0' + uniform(0, 9) : 'P' + uniform(0, 9));
+        std::string text(1, chance(50) ? '`' : '\'');
+        for (int i = 0; i < 6; ++i)
+            text += static_cast<char>(uniform(0x1C, 0x7F));
+        text += chance(50) ? '>' : '[';
+        text += '/';
+        return text + (chance(50) ? "]=" : "") + comment(2);
+    }
+
+private:
+    std::mt19937 m_random;
+};
+
+/**
+ * @brief one frame of the feed, the weights follow a busy regional filter
+ */
+static std::string frame(Generator &gen)
+{
+    const auto source = gen.call();
+    std::string destination = gen.pick(tocalls);
+    std::string payload;
+    const char tables[] = {'/', '/', '/', '\\', 'L', 'S'};
+    const char codes[] = {'>', '-', '#', '&', '_', 'k', 'v', '[', 'y', 'r', 'a', 'O'};
+    const auto table = gen.pick(tables);
+    const auto code = gen.pick(codes);
+
+    const auto kind = gen.uniform(0, 99);
+    if (kind < 22)
+    {
+        payload = (gen.chance(50) ? "!" : "=") + gen.position(table, code);
+        if (gen.chance(30))
+            payload += gen.number("%03.0f", gen.uniform(1, 360)) + "/" + gen.number("%03.0f", gen.uniform(0, 120));
+        if (gen.chance(40))
+            payload += "/A=" + gen.number("%06.0f", gen.uniform(-100, 15000));
+        payload += " " + gen.comment(5);
+    }
+    else if (kind < 32)
+    {
+        payload = (gen.chance(50) ? "/" : "@") + gen.timestamp() + gen.position(table, code) + gen.comment(4);
+    }
+    else if (kind < 44)
+    {
+        payload = (gen.chance(70) ? "!" : "=") + gen.compressedPosition(table, code) + gen.comment(4);
+        if (gen.chance(20))
+            payload += gen.compressedTelemetry();
+    }
+    else if (kind < 52)
+    {
+        payload = gen.micE(destination);
+    }
+    else if (kind < 60)
+    {
+        payload = ">" + (gen.chance(20) ? gen.timestamp() : "") + gen.comment(6);
+        if (gen.chance(40))
+            payload += gen.compressedTelemetry() + gen.comment(2);
+    }
+    else if (kind < 70)
+    {
+        switch (gen.uniform(0, 3))
+        {
+        case 0:
+            payload = gen.addressee(gen.call()) + "ack" + std::to_string(gen.uniform(1, 999));
+            break;
+        case 1:
+            payload = gen.addressee("BLN" + std::to_string(gen.uniform(0, 9))) + gen.comment(8);
+            break;
+        default:
+            payload = gen.addressee(gen.call()) + gen.comment(8);
+            if (gen.chance(70))
+                payload += "{" + std::to_string(gen.uniform(1, 99999));
+            break;
+        }
+    }
+    else if (kind < 80)
+    {
+        payload = gen.telemetry();
+    }
+    else if (kind < 85)
+    {
+        const char *const lists[] = {"PARM.Vbatt,Temp,Hum,Rssi,Snr,B1,B2,B3", "UNIT.V,degC,%,dBm,dB,on,on,open",
+                                     "EQNS.0,0.01,0,0,0.1,-40,0,1,0,0,1,-140,0,0.25,0", "BITS.11110000,Station"};
+        payload = gen.addressee(source) + gen.pick(lists);
+    }
+    else if (kind < 90)
+    {
+        payload = gen.chance(50) ? "_" + gen.number("%08.0f", gen.uniform(1010000, 12312359))
+                                 : "@" + gen.timestamp() + gen.position('/', '_');
+        payload += "c" + gen.number("%03.0f", gen.uniform(0, 360)) + "s" + gen.number("%03.0f", gen.uniform(0, 50));
+        payload += "g" + gen.number("%03.0f", gen.uniform(0, 80)) + "t" + gen.number("%03.0f", gen.uniform(-20, 105));
+        payload += "h" + gen.number("%02.0f", gen.uniform(0, 99)) + "b" + gen.number("%05.0f", gen.uniform(9500, 10500));
+    }
+    else if (kind < 94)
+    {
+        auto name = gen.call(false) + "-OBJ";
+        name.resize(9, ' ');
+        payload = gen.chance(60) ? ";" + name + (gen.chance(90) ? "*" : "_") + gen.timestamp() +
+                                       gen.position('/', code) + gen.comment(3)
+                                 : ")" + name.substr(0, gen.uniform(3, 9)) + "!" + gen.position('/', code);
+    }
+    else if (kind < 96)
+    {
+        payload = "}" + gen.call() + ">" + gen.pick(tocalls) + ",TCPIP," + gen.call() + "*:>" + gen.comment(3);
+    }
+    else
+    {
+        // damaged: cut short, header without payload or garbage the way a bad igate passes it on
+        auto text = source + ">" + destination + gen.path() + ":!" + gen.position(table, code) + gen.comment(3);
+        switch (gen.uniform(0, 3))
+        {
+        case 0:
+            text.resize(gen.uniform(1, static_cast<int>(text.size()) - 1));
+            return text;
+        case 1:
+            return source + ">" + destination + gen.path();
+        case 2:
+            return ">" + destination + ":" + gen.comment(3);
+        default:
+            for (auto &c : text)
+                c = gen.chance(5) ? static_cast<char>(gen.uniform(1, 255)) : c;
+            for (auto &c : text)
+                c = c == '\n' || c == '\r' ? ' ' : c;
+            return text;
+        }
+    }
+    return source + ">" + destination + gen.path() + ":" + payload;
+}
+
+/**
+ * @brief writes the given number of frames to stdout
+ *
+ * @return int exit code
+ */
+int corpus_generate(unsigned frames, unsigned seed)
+{
+    Generator gen(seed);
+    printf("# synthetic aprs-is feed, program --corpus %u %u\n", frames, seed);
+    for (unsigned i = 0; i < frames; ++i)
+    {
+        const auto text = frame(gen);
+        fwrite(text.data(), 1, text.size(), stdout);
+        fputc('\n', stdout);
+    }
+    return 0;
+}
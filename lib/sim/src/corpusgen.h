@@ -0,0 +1,11 @@
+#pragma once
+
+// synthetic APRS-IS feed for "program --parse": random stations sending the packet types of a real feed with its
+// spread of formats, uncompressed and compressed positions with timestamps, course/speed, altitude and ambiguity,
+// mic-e, status reports with base-91 telemetry, messages, acks and bulletins, T# reports, telemetry metadata, weather,
+// objects, items and third party traffic over rf and internet paths, plus a share of damaged frames.
+//
+// the same seed gives the same corpus, the frames are written to stdout one per line.
+
+
+int corpus_generate(unsigned frames, unsigned seed);
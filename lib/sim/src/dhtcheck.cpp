@@ -0,0 +1,95 @@
+#include <Arduino.h>
+#include <check.h>
+#include <dht11.h>
+#include <dhtcheck.h>
+#include <sim.h>
+
+/**
+ * @brief one read with the step spacing of the firmware's scheduler one shots
+ *
+ * @param startMs [ms] start signal
+ * @return bool finish()
+ */
+static bool read(AsyncDht &dht, unsigned long startMs = AsyncDht::start_ms)
+{
+    auto &sim = Simulator::instance();
+    dht.start();
+    sim.advance(startMs * 1000);
+    dht.release();
+    sim.advance(AsyncDht::frame_ms * 1000);
+    return dht.finish(millis());
+}
+
+static bool reads(const ClimateReading &reading, int16_t temperature, uint8_t humidity)
+{
+    return reading.valid && reading.temperature == temperature && reading.humidity == humidity;
+}
+
+/**
+ * @brief a damaged answer is rejected, counted and the previous reading stays
+ */
+static void rejected(CheckCount &check, AsyncDht &dht, DhtFault fault, const char *name)
+{
+    auto &sim = Simulator::instance();
+    const auto errors = dht.errors();
+    sim.dhtFault = fault;
+    sim.temperature = 30.0f;
+    check(!read(dht) && dht.errors() == errors + 1 && reads(dht.reading(), 216, 45), name);
+    sim.dhtFault = DhtFault::none;
+    sim.temperature = 21.6f;
+}
+
+/**
+ * @brief runs the checks
+ *
+ * @return int exit code, 1 if a check failed
+ */
+int dht_check()
+{
+    static const Settings board;
+    auto &sim = Simulator::instance();
+    AsyncDht dht(board.tlm.dht11_pin);
+    CheckCount check;
+    dht.begin();
+    sim.advance(AsyncDht::power_up_ms * 1000);
+
+    sim.temperature = 21.6f;
+    sim.humidity = 45;
+    check(read(dht) && reads(dht.reading(), 216, 45), "clean");
+    check(!dht.busy() && dht.reads() == 1 && dht.errors() == 0, "clean_counters");
+    sim.temperature = -7.3f;
+    sim.humidity = 92;
+    check(read(dht) && reads(dht.reading(), -73, 92), "clean_negative");
+    sim.temperature = 21.6f;
+    sim.humidity = 45;
+    check(read(dht) && reads(dht.reading(), 216, 45) && dht.reading().timestamp == millis(), "clean_timestamp");
+
+    rejected(check, dht, DhtFault::checksum, "bad_checksum");
+    rejected(check, dht, DhtFault::missing_edge, "missing_edge");
+    rejected(check, dht, DhtFault::extra_edge, "extra_edge");
+    rejected(check, dht, DhtFault::truncated, "truncated");
+    rejected(check, dht, DhtFault::slow_bit, "slow_bit");
+
+    // the decoder uses the last edges, a glitch before the answer does no harm
+    sim.dhtFault = DhtFault::early_edge;
+    check(read(dht) && reads(dht.reading(), 216, 45), "early_edge_accepted");
+    sim.dhtFault = DhtFault::none;
+
+    // no answer at all: no sensor, or a start signal shorter than the sensor needs
+    sim.dhtPresent = false;
+    sim.temperature = 30.0f;
+    check(!read(dht) && reads(dht.reading(), 216, 45), "timeout_no_sensor");
+    sim.dhtPresent = true;
+    check(!read(dht, 10) && reads(dht.reading(), 216, 45), "timeout_short_start");
+
+    // a valid checksum over an impossible humidity
+    sim.humidity = 120;
+    check(!read(dht) && reads(dht.reading(), 216, 45), "humidity_range");
+    sim.humidity = 45;
+
+    // the line recovers after the faults
+    check(read(dht) && reads(dht.reading(), 300, 45), "recovers");
+    printf("dht_reads=%u\n", dht.reads());
+    printf("dht_errors=%u\n", dht.errors());
+    return check.report("dht");
+}
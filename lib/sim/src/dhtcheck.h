@@ -0,0 +1,8 @@
+#pragma once
+
+// AsyncDht against the dht11 model of the simulator: start, release and finish on the virtual clock with clean
+// answers and with damaged ones (bad checksum, lost, extra and early edges, a truncated answer, a stretched bit,
+// no sensor, a short start signal). a damaged answer must be rejected and keep the previous reading.
+
+
+int dht_check();
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <esp_err.h>
+
+// ESP-IDF uart driver shim for the host simulation
+
+
+typedef int uart_port_t;
+
+#define UART_NUM_0 0
+
+esp_err_t uart_set_wakeup_threshold(uart_port_t uart_num, int wakeup_threshold);
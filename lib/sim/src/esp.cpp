@@ -0,0 +1,258 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <driver/gpio.h>
+#include <driver/uart.h>
+#include <esp_adc_cal.h>
+#include <esp_partition.h>
+#include <esp_sleep.h>
+#include <esp_timer.h>
+#include <freertos/task.h>
+#include <sim.h>
+
+static constexpr size_t flash_sector_size = 4096;
+static constexpr uint32_t adc_full_scale_mv = 3300; // ADC_ATTEN_DB_11, ideal
+static constexpr uint32_t adc_max = 4095;
+
+struct SimPartition
+{
+    esp_partition_t partition;
+    uint8_t *data;
+    bool missing{false}; // not in the partition table, see sim_partition_missing()
+};
+
+// the data partitions of partitions.csv the firmware opens
+static uint8_t s_seqlog[0x4000];
+static uint8_t s_history[0x1C000];
+static SimPartition s_partitions[] = {
+    {{ESP_PARTITION_TYPE_DATA, 0x40, 0x3E0000, sizeof(s_seqlog), "seqlog", false}, s_seqlog},
+    {{ESP_PARTITION_TYPE_DATA, 0x41, 0x3E4000, sizeof(s_history), "history", false}, s_history},
+};
+static bool s_flashErased = false;
+
+static uint64_t s_sleepTimerUs = 0;
+static esp_sleep_wakeup_cause_t s_wakeCause = ESP_SLEEP_WAKEUP_UNDEFINED;
+static int s_loopTask; // the handle of the only task
+
+
+int64_t esp_timer_get_time()
+{
+    return static_cast<int64_t>(Simulator::instance().now());
+}
+
+
+esp_err_t esp_sleep_enable_timer_wakeup(uint64_t time_in_us)
+{
+    s_sleepTimerUs = time_in_us;
+    return ESP_OK;
+}
+
+esp_err_t esp_sleep_enable_gpio_wakeup()
+{
+    return ESP_OK;
+}
+
+esp_err_t esp_sleep_enable_uart_wakeup(int uart_num)
+{
+    return ESP_OK;
+}
+
+esp_err_t esp_light_sleep_start()
+{
+    s_wakeCause = static_cast<esp_sleep_wakeup_cause_t>(Simulator::instance().lightSleep(s_sleepTimerUs));
+    return ESP_OK;
+}
+
+esp_sleep_wakeup_cause_t esp_sleep_get_wakeup_cause()
+{
+    return s_wakeCause;
+}
+
+esp_err_t gpio_wakeup_enable(gpio_num_t gpio_num, gpio_int_type_t intr_type)
+{
+    if (intr_type != GPIO_INTR_LOW_LEVEL && intr_type != GPIO_INTR_HIGH_LEVEL)
+        return ESP_ERR_INVALID_ARG;
+    Simulator::instance().wakeOnLevel(gpio_num, intr_type == GPIO_INTR_HIGH_LEVEL ? 1 : 0);
+    return ESP_OK;
+}
+
+esp_err_t gpio_wakeup_disable(gpio_num_t gpio_num)
+{
+    Simulator::instance().wakeOnLevel(gpio_num, -1);
+    return ESP_OK;
+}
+
+esp_err_t gpio_set_intr_type(gpio_num_t gpio_num, gpio_int_type_t intr_type)
+{
+    return ESP_OK;
+}
+
+esp_err_t uart_set_wakeup_threshold(uart_port_t uart_num, int wakeup_threshold)
+{
+    return ESP_OK;
+}
+
+
+esp_adc_cal_value_t esp_adc_cal_characterize(adc_unit_t adc_num, adc_atten_t atten, adc_bits_width_t bit_width,
+                                             uint32_t default_vref, esp_adc_cal_characteristics_t *chars)
+{
+    chars->adc_num = adc_num;
+    chars->atten = atten;
+    chars->bit_width = bit_width;
+    chars->vref = default_vref;
+    return ESP_ADC_CAL_VAL_DEFAULT_VREF;
+}
+
+uint32_t esp_adc_cal_raw_to_voltage(uint32_t adc_reading, const esp_adc_cal_characteristics_t *chars)
+{
+    return adc_reading * adc_full_scale_mv / adc_max;
+}
+
+
+/**
+ * @brief a fresh chip, every partition erased
+ */
+static void flash_init()
+{
+    if (s_flashErased)
+        return;
+    for (auto &partition : s_partitions)
+        memset(partition.data, 0xFF, partition.partition.size);
+    s_flashErased = true;
+}
+
+static SimPartition *flash_find(const esp_partition_t *partition)
+{
+    for (auto &candidate : s_partitions)
+    {
+        if (&candidate.partition == partition)
+            return &candidate;
+    }
+    return nullptr;
+}
+
+const esp_partition_t *esp_partition_find_first(esp_partition_type_t type, esp_partition_subtype_t subtype,
+                                                const char *label)
+{
+    flash_init();
+    for (const auto &candidate : s_partitions)
+    {
+        if (candidate.partition.type != type)
+            continue;
+        if (subtype != ESP_PARTITION_SUBTYPE_ANY && candidate.partition.subtype != subtype)
+            continue;
+        if (label && strcmp(label, candidate.partition.label))
+            continue;
+        if (candidate.missing)
+            continue;
+        return &candidate.partition;
+    }
+    return nullptr;
+}
+
+/**
+ * @brief hides a partition from esp_partition_find_first(), like the partition table of older firmware
+ */
+void sim_partition_missing(const char *label, bool missing)
+{
+    for (auto &candidate : s_partitions)
+    {
+        if (!strcmp(label, candidate.partition.label))
+            candidate.missing = missing;
+    }
+}
+
+esp_err_t esp_partition_read(const esp_partition_t *partition, size_t src_offset, void *dst, size_t size)
+{
+    const auto flash = flash_find(partition);
+    if (!flash)
+        return ESP_ERR_INVALID_ARG;
+    if (src_offset + size > partition->size)
+        return ESP_ERR_INVALID_SIZE;
+    memcpy(dst, flash->data + src_offset, size);
+    return ESP_OK;
+}
+
+/**
+ * @brief NOR flash write, only clears bits
+ */
+esp_err_t esp_partition_write(const esp_partition_t *partition, size_t dst_offset, const void *src, size_t size)
+{
+    const auto flash = flash_find(partition);
+    if (!flash)
+        return ESP_ERR_INVALID_ARG;
+    if (dst_offset + size > partition->size)
+        return ESP_ERR_INVALID_SIZE;
+    const auto bytes = static_cast<const uint8_t *>(src);
+    for (size_t i = 0; i < size; ++i)
+        flash->data[dst_offset + i] &= bytes[i];
+    Simulator::instance().metrics.flashBytesWritten += size;
+    return ESP_OK;
+}
+
+esp_err_t esp_partition_erase_range(const esp_partition_t *partition, size_t offset, size_t size)
+{
+    const auto flash = flash_find(partition);
+    if (!flash)
+        return ESP_ERR_INVALID_ARG;
+    if (offset % flash_sector_size || size % flash_sector_size)
+        return ESP_ERR_INVALID_SIZE;
+    if (offset + size > partition->size)
+        return ESP_ERR_INVALID_SIZE;
+    memset(flash->data + offset, 0xFF, size);
+    Simulator::instance().metrics.flashErases += size / flash_sector_size;
+    return ESP_OK;
+}
+
+
+TaskHandle_t xTaskGetCurrentTaskHandle()
+{
+    return &s_loopTask;
+}
+
+/**
+ * @brief a wait of the loop task, the virtual clock jumps to the next event
+ */
+uint32_t ulTaskNotifyTake(BaseType_t xClearCountOnExit, TickType_t xTicksToWait)
+{
+    auto &sim = Simulator::instance();
+    if (!xTicksToWait)
+        return sim.takeNotification();
+    ++sim.metrics.waits;
+    return sim.waitForWake(xTicksToWait == portMAX_DELAY ? ~0ULL : static_cast<uint64_t>(xTicksToWait) * 1000);
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t xTaskToNotify)
+{
+    Simulator::instance().notify();
+    return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t xTaskToNotify, BaseType_t *pxHigherPriorityTaskWoken)
+{
+    Simulator::instance().notify();
+    if (pxHigherPriorityTaskWoken)
+        *pxHigherPriorityTaskWoken = pdTRUE;
+}
+
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t xTask)
+{
+    return 0;
+}
+
+/**
+ * @brief the simulation has one task, build with DUALCORE false
+ */
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t pvTaskCode, const char *pcName, uint32_t usStackDepth,
+                                   void *pvParameters, UBaseType_t uxPriority, TaskHandle_t *pvCreatedTask,
+                                   BaseType_t xCoreID)
+{
+    fprintf(stderr, "sim: task '%s' can't run, the simulation has no scheduler (build with DUALCORE false)\n",
+            pcName);
+    exit(2);
+}
+
+void vTaskDelay(TickType_t xTicksToDelay)
+{
+    Simulator::instance().advance(static_cast<uint64_t>(xTicksToDelay) * 1000);
+}
@@ -0,0 +1,11 @@
+#pragma once
+
+// ESP-IDF error codes shim for the host simulation
+
+
+typedef int esp_err_t;
+
+#define ESP_OK 0
+#define ESP_FAIL -1
+#define ESP_ERR_INVALID_ARG 0x102
+#define ESP_ERR_INVALID_SIZE 0x104
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstdint>
+#include <esp_err.h>
+
+// ESP-IDF sleep shim for the host simulation
+
+
+typedef enum
+{
+    ESP_SLEEP_WAKEUP_UNDEFINED = 0,
+    ESP_SLEEP_WAKEUP_TIMER = 1,
+    ESP_SLEEP_WAKEUP_GPIO = 2,
+    ESP_SLEEP_WAKEUP_UART = 3,
+} esp_sleep_wakeup_cause_t;
+
+esp_err_t esp_sleep_enable_timer_wakeup(uint64_t time_in_us);
+esp_err_t esp_sleep_enable_gpio_wakeup();
+esp_err_t esp_sleep_enable_uart_wakeup(int uart_num);
+esp_err_t esp_light_sleep_start();
+esp_sleep_wakeup_cause_t esp_sleep_get_wakeup_cause();
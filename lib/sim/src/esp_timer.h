@@ -0,0 +1,8 @@
+#pragma once
+
+#include <cstdint>
+
+// ESP-IDF high resolution timer shim for the host simulation, reads the virtual clock
+
+
+int64_t esp_timer_get_time();
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstdint>
+
+// FreeRTOS shim for the host simulation, one tick is one millisecond like on the ESP32 arduino core
+
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdPASS 1
+#define pdMS_TO_TICKS(ms) (static_cast<TickType_t>(ms))
+#define portMAX_DELAY static_cast<TickType_t>(0xffffffffUL)
+#define portYIELD_FROM_ISR(woken) (void)(woken)
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <freertos/FreeRTOS.h>
+
+// FreeRTOS task shim for the host simulation
+// only the loop task exists, task notifications wait on the virtual clock. DUALCORE builds do not run here.
+
+
+typedef void *TaskHandle_t;
+typedef void (*TaskFunction_t)(void *);
+
+TaskHandle_t xTaskGetCurrentTaskHandle();
+uint32_t ulTaskNotifyTake(BaseType_t xClearCountOnExit, TickType_t xTicksToWait);
+BaseType_t xTaskNotifyGive(TaskHandle_t xTaskToNotify);
+void vTaskNotifyGiveFromISR(TaskHandle_t xTaskToNotify, BaseType_t *pxHigherPriorityTaskWoken);
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t xTask);
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t pvTaskCode, const char *pcName, uint32_t usStackDepth,
+                                   void *pvParameters, UBaseType_t uxPriority, TaskHandle_t *pvCreatedTask,
+                                   BaseType_t xCoreID);
+void vTaskDelay(TickType_t xTicksToDelay);
@@ -0,0 +1,212 @@
+#include <check.h>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <esp_partition.h>
+#include <functional>
+#include <history.h>
+#include <historybench.h>
+#include <memory>
+#include <random>
+#include <vector>
+
+static constexpr uint32_t sample_interval = 60; // [sec] settings.tlm.history_interval
+
+/**
+ * @brief sample traces of the benchmark, sample n of a trace follows the sample before it
+ */
+static const struct
+{
+    const char *name;
+    std::function<void(unsigned, std::mt19937 &, HistorySample &)> next;
+} traces[] = {
+    {"steady", [](unsigned, std::mt19937 &, HistorySample &sample) { sample.time += sample_interval; }},
+    {"day",
+     [](unsigned n, std::mt19937 &, HistorySample &sample) {
+         // 24 h triangle of the temperature, the humidity the other way, the battery drains and is charged at noon
+         const auto minute = static_cast<int>(n % 1440);
+         const auto triangle = minute < 720 ? minute : 1440 - minute;
+         sample.time += sample_interval;
+         sample.temperature = static_cast<int16_t>(120 + triangle / 8);
+         sample.humidity = static_cast<uint8_t>(80 - triangle / 24);
+         sample.intvoltage = static_cast<uint16_t>(minute == 720 ? 4150 : sample.intvoltage - (n % 9 == 0));
+         sample.status = static_cast<uint8_t>(minute >= 360 && minute < 1080 ? 0x01 : 0x00);
+     }},
+    {"noisy",
+     [](unsigned, std::mt19937 &random, HistorySample &sample) {
+         sample.time += sample_interval;
+         sample.intvoltage = static_cast<uint16_t>(3950 + random() % 41);
+         sample.temperature = static_cast<int16_t>(215 + static_cast<int>(random() % 7) - 3);
+         sample.humidity = static_cast<uint8_t>(55 + random() % 3);
+         sample.status = static_cast<uint8_t>(random() % 16 ? sample.status : random() % 256);
+     }},
+    {"irregular",
+     [](unsigned, std::mt19937 &random, HistorySample &sample) {
+         // reboots and backpressure: gaps up to an hour, jumps of every field
+         sample.time += 1 + random() % 3600;
+         sample.intvoltage = static_cast<uint16_t>(3300 + random() % 900);
+         sample.temperature = static_cast<int16_t>(static_cast<int>(random() % 900) - 300);
+         sample.humidity = static_cast<uint8_t>(random() % 101);
+         sample.status = static_cast<uint8_t>(random());
+     }},
+};
+
+static bool same(const HistorySample &a, const HistorySample &b)
+{
+    return a.time == b.time && a.intvoltage == b.intvoltage && a.temperature == b.temperature &&
+           a.humidity == b.humidity && a.status == b.status;
+}
+
+/**
+ * @brief host time of a range query, repeated until it took at least a few ms
+ *
+ * @param returned samples of one query
+ * @return double [ns] per query
+ */
+static double measure(const HistoryLog &log, uint32_t from, uint32_t to, uint32_t &returned)
+{
+    unsigned runs = 0;
+    std::chrono::duration<double, std::nano> elapsed{0};
+    const auto start = std::chrono::steady_clock::now();
+    do
+    {
+        auto cursor = log.query(from, to);
+        HistorySample sample;
+        returned = 0;
+        while (log.next(cursor, sample))
+            ++returned;
+        ++runs;
+        elapsed = std::chrono::steady_clock::now() - start;
+    } while (elapsed.count() < 5e6);
+    return elapsed.count() / runs;
+}
+
+/**
+ * @brief records blocks into the simulated "history" partition and restores them, then damages the newest block
+ *
+ * @param check counts the checks
+ */
+static void persistence_checks(CheckCount &check)
+{
+    const auto partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, "history");
+    if (!check(partition != nullptr, "persist_partition"))
+        return;
+    esp_partition_erase_range(partition, 0, partition->size);
+
+    // three closed blocks, the samples of the middle one are the last the restore keeps after the damage
+    std::vector<uint32_t> closed; // last time of each persisted block
+    {
+        auto log = std::make_unique<HistoryLog>();
+        log->init();
+        HistorySample sample{};
+        sample.time = 1000;
+        for (int block = 0; block < 3; ++block)
+        {
+            for (int n = 0; n < 20; ++n)
+            {
+                sample.time += sample_interval;
+                sample.intvoltage = static_cast<uint16_t>(3900 + n);
+                log->record(sample);
+            }
+            log->flush();
+            closed.push_back(sample.time);
+        }
+    }
+
+    {
+        auto log = std::make_unique<HistoryLog>();
+        log->init();
+        check(log->samples() == 60 && log->now() > closed[2], "persist_restore");
+    }
+
+    // clear bytes of the newest block's samples, as a torn write or a worn cell would
+    const auto slots = partition->size / HistoryBlock::size;
+    const uint8_t zeros[4] = {};
+    esp_partition_write(partition, (2 % slots) * HistoryBlock::size + offsetof(HistoryBlock, data), zeros,
+                        sizeof(zeros));
+    {
+        auto log = std::make_unique<HistoryLog>();
+        log->init();
+        check(log->samples() == 40, "persist_damaged_newest_skipped");
+        check(log->now() > closed[1], "persist_damaged_newest_time_base");
+
+        // what this boot records follows the restored samples
+        HistorySample sample{};
+        sample.time = log->now();
+        log->record(sample);
+        auto cursor = log->query(0, UINT32_MAX);
+        uint32_t previous = 0;
+        uint32_t count = 0;
+        bool ordered = true;
+        while (log->next(cursor, sample))
+        {
+            ordered = ordered && sample.time >= previous;
+            previous = sample.time;
+            ++count;
+        }
+        check(ordered && count == 41, "persist_damaged_newest_ordered");
+    }
+    esp_partition_erase_range(partition, 0, partition->size);
+}
+
+/**
+ * @brief records every trace into a RAM only log, prints the bytes per sample and the query times
+ *
+ * @param samples recorded per trace, the ring keeps the newest
+ * @return int exit code, 1 if a query returned other samples than recorded
+ */
+int history_benchmark(unsigned samples)
+{
+    CheckCount check;
+    for (const auto &trace : traces)
+    {
+        std::mt19937 random(7);
+        auto log = std::make_unique<HistoryLog>(); // without init() no partition, RAM only
+        std::vector<HistorySample> recorded;
+        HistorySample sample{};
+        sample.intvoltage = 4100;
+        sample.temperature = 215;
+        sample.humidity = 50;
+        for (unsigned n = 0; n < samples; ++n)
+        {
+            trace.next(n, random, sample);
+            log->record(sample);
+            recorded.push_back(sample);
+        }
+
+        // the ring holds the newest log->samples() of the recorded ones
+        const auto held = log->samples();
+        auto cursor = log->query(0, UINT32_MAX);
+        auto expected = recorded.end() - std::min<size_t>(held, recorded.size());
+        bool ok = held > 0;
+        while (ok && log->next(cursor, sample))
+            ok = expected != recorded.end() && same(sample, *expected++);
+        check(ok && expected == recorded.end(), trace.name);
+
+        const auto first = recorded.end()[-static_cast<ptrdiff_t>(std::min<size_t>(held, recorded.size()))].time;
+        const auto last = recorded.back().time;
+        uint32_t all, hour, one;
+        const auto allNs = measure(*log, 0, UINT32_MAX, all);
+        const auto hourNs = measure(*log, last - 3599, last, hour);
+        const auto middle = first + (last - first) / 2;
+        const auto oneNs = measure(*log, middle, middle + sample_interval - 1, one);
+
+        printf("history_%s_samples=%u\n", trace.name, held);
+        printf("history_%s_hours=%.1f\n", trace.name, (last - first) / 3600.0);
+        printf("history_%s_bytes_per_sample=%.2f\n", trace.name,
+               held ? static_cast<double>(log->bytesUsed()) / held : 0);
+        // with block headers and unused block tails, once the ring is full
+        printf("history_%s_ram_bytes_per_sample=%.2f\n", trace.name,
+               held ? static_cast<double>(HistoryLog::blocks * HistoryBlock::size) / held : 0);
+        printf("history_%s_query_all_us=%.1f\n", trace.name, allNs / 1000);
+        printf("history_%s_query_all_ns_per_sample=%.1f\n", trace.name, all ? allNs / all : 0);
+        printf("history_%s_query_last_hour_us=%.1f\n", trace.name, hourNs / 1000);
+        printf("history_%s_query_last_hour_samples=%u\n", trace.name, hour);
+        printf("history_%s_query_one_us=%.1f\n", trace.name, oneNs / 1000);
+        printf("history_%s_query_one_samples=%u\n", trace.name, one);
+    }
+    printf("history_raw_bytes_per_sample=%zu\n", sizeof(HistorySample));
+    persistence_checks(check);
+    return check.report("history");
+}
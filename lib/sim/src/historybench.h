@@ -0,0 +1,8 @@
+#pragma once
+
+// HistoryLog on the host: encoded bytes per sample and the range query time over synthetic traces, a quiet station,
+// a day cycle, noisy sensors and irregular sample times. every query must return the recorded samples. then the
+// restore from the simulated "history" partition, also with a damaged newest block.
+
+
+int history_benchmark(unsigned samples);
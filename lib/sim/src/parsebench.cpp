@@ -0,0 +1,186 @@
+#include <aprs.h>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <parsebench.h>
+#include <string>
+#include <telemetry.h>
+#include <vector>
+
+static constexpr size_t packet_types = aprs_telemetry_bits + 1;
+
+
+const char *packet_type_name(AprsPacketType type)
+{
+    static const char *const names[packet_types] = {"unknown", "position",       "status",         "message",
+                                                    "telemetry", "telemetry_parm", "telemetry_unit", "telemetry_eqns",
+                                                    "telemetry_bits"};
+    return type < packet_types ? names[type] : "?";
+}
+
+/**
+ * @brief parses an encoded frame and checks it with the given predicate
+ */
+template <typename Check>
+static bool roundtrip(const char *name, const AprsFrame &frame, AprsPacketType type, Check check)
+{
+    const std::string_view text(reinterpret_cast<const char *>(frame.data()), frame.length());
+    AprsPacket packet;
+    const bool ok = AprsParser::parse(text, packet) && packet.type == type && packet.source == "HB9HDG-13" &&
+                    packet.destination == "APRS" && check(packet);
+    if (!ok)
+        printf("roundtrip_failed=%s %.*s\n", name, static_cast<int>(text.size()), text.data());
+    return ok;
+}
+
+/**
+ * @brief parses what AprsFrame encodes for every frame the firmware sends
+ *
+ * @return size_t number of failed round trips
+ */
+static size_t roundtrips()
+{
+    constexpr double latitude = 47.06671;
+    constexpr double longitude = -9.04925;
+    constexpr double altitude = 512; // [m]
+    const int analog[AprsFrame::analog_channels] = {412, 87, 231, 999, 0};
+    const int wide[AprsFrame::analog_channels] = {8280, 87, 4100, 12, 0};
+    constexpr uint8_t bits = 0xA5;
+    size_t count = 0;
+    size_t passed = 0;
+
+    AprsFrame frame;
+    frame.header("HB9HDG-13", "APRS").append('!').position(latitude, longitude, '/', '-').append("comment");
+    frame.altitude(altitude);
+    ++count;
+    passed += roundtrip("position", frame, aprs_position, [&](const AprsPacket &p) {
+        return !p.compressed && fabs(p.latitude - latitude) < 1 / 6000.0 && fabs(p.longitude - longitude) < 1 / 6000.0 &&
+               p.symbolTable == '/' && p.symbolCode == '-' && p.hasAltitude && fabs(p.altitude - altitude) < 0.3048 &&
+               p.text.substr(0, 7) == "comment";
+    });
+
+    frame.clear();
+    frame.header("HB9HDG-13", "APRS").append('!').compressedPosition(latitude, longitude, altitude, '/', '-');
+    ++count;
+    passed += roundtrip("compressed_position", frame, aprs_position, [&](const AprsPacket &p) {
+        return p.compressed && fabs(p.latitude - latitude) < 1e-5 && fabs(p.longitude - longitude) < 1e-5 &&
+               p.symbolTable == '/' && p.symbolCode == '-' && p.hasAltitude && fabs(p.altitude / altitude - 1) < 0.002;
+    });
+
+    frame.clear();
+    frame.header("HB9HDG-13", "APRS").telemetry(1234, analog, 4, bits, 8);
+    ++count;
+    passed += roundtrip("telemetry", frame, aprs_telemetry, [&](const AprsPacket &p) {
+        bool same = p.sequence == 234 && p.analogMask == 0x0F && p.bits == bits && p.bitCount == 8 && !p.compressed;
+        for (size_t i = 0; i < 4; ++i)
+            same = same && p.analog[i] == analog[i];
+        return same;
+    });
+
+    frame.clear();
+    frame.header("HB9HDG-13", "APRS").append('>').compressedTelemetry(7000, wide, 4, bits, 8);
+    ++count;
+    passed += roundtrip("compressed_telemetry", frame, aprs_telemetry, [&](const AprsPacket &p) {
+        bool same = p.sequence == 7000 && p.analogMask == 0x1F && p.bits == bits && p.bitCount == 8 && p.compressed;
+        for (size_t i = 0; i < AprsFrame::analog_channels; ++i)
+            same = same && p.analog[i] == (i < 4 ? wide[i] : 0);
+        return same;
+    });
+
+    const struct
+    {
+        const char *name;
+        const char *text;
+        AprsPacketType type;
+    } metadata[] = {{"parm", telemetry_parm.text, aprs_telemetry_parm},
+                    {"unit", telemetry_unit.text, aprs_telemetry_unit},
+                    {"eqns", telemetry_eqns.text, aprs_telemetry_eqns},
+                    {"bits", telemetry_bits.text, aprs_telemetry_bits}};
+    for (const auto &entry : metadata)
+    {
+        frame.clear();
+        frame.header("HB9HDG-13", "APRS").message("HB9HDG-13").append(entry.text);
+        ++count;
+        passed += roundtrip(entry.name, frame, entry.type, [&](const AprsPacket &p) {
+            return p.addressee == "HB9HDG-13" && p.text == std::string_view(entry.text).substr(5);
+        });
+    }
+
+    printf("roundtrip_ok=%zu/%zu\n", passed, count);
+    return count - passed;
+}
+
+/**
+ * @brief parses the corpus the given number of times and prints the throughput and the packet types
+ *
+ * @param corpus file of tnc2 frames, "-" for stdin
+ * @param passes over the corpus
+ * @return int exit code, 1 if the corpus can't be read or a round trip fails
+ */
+int parse_benchmark(const char *corpus, unsigned passes)
+{
+    // "-" reads the corpus from stdin, e.g. piped from program --corpus
+    const bool piped = !strcmp(corpus, "-");
+    std::ifstream file;
+    if (!piped)
+        file.open(corpus);
+    std::istream &input = piped ? std::cin : file;
+    if (!input)
+    {
+        fprintf(stderr, "sim: can't open %s\n", corpus);
+        return 1;
+    }
+    std::vector<std::string> frames;
+    size_t bytes = 0;
+    for (std::string line; std::getline(input, line);)
+    {
+        if (!line.empty() && line.back() == '\r')
+            line.pop_back();
+        if (line.empty() || line[0] == '#')
+            continue;
+        bytes += line.size();
+        frames.push_back(std::move(line));
+    }
+
+    uint32_t types[packet_types] = {};
+    uint32_t invalid = 0;
+    AprsPacket packet;
+    for (const auto &text : frames)
+    {
+        if (AprsParser::parse(text, packet))
+            ++types[packet.type];
+        else
+            ++invalid;
+    }
+
+    // the checksum keeps the compiler from dropping the parsing
+    uint32_t checksum = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (unsigned pass = 0; pass < passes; ++pass)
+    {
+        for (const auto &text : frames)
+        {
+            if (AprsParser::parse(text, packet))
+                checksum += packet.type + static_cast<uint32_t>(packet.payload.size());
+        }
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    const auto seconds = elapsed.count();
+    const auto parsed = static_cast<double>(frames.size()) * passes;
+
+    printf("corpus_frames=%zu\n", frames.size());
+    printf("corpus_bytes=%zu\n", bytes);
+    printf("passes=%u\n", passes);
+    printf("parse_time_ms=%.1f\n", seconds * 1e3);
+    printf("packets_per_s=%.0f\n", seconds > 0 ? parsed / seconds : 0);
+    printf("ns_per_packet=%.1f\n", parsed > 0 ? seconds * 1e9 / parsed : 0);
+    printf("mbytes_per_s=%.1f\n", seconds > 0 ? bytes * static_cast<double>(passes) / seconds / 1e6 : 0);
+    printf("checksum=%u\n", checksum);
+    printf("invalid=%u\n", invalid);
+    for (size_t i = 0; i < packet_types; ++i)
+        printf("type_%s=%u\n", packet_type_name(static_cast<AprsPacketType>(i)), types[i]);
+    return roundtrips() ? 1 : 0;
+}
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <aprsparser.h>
+
+// AprsParser on the host: throughput over a corpus of tnc2 frames and round trips of the firmware's AprsFrame output
+//
+// corpus lines are tnc2 frames as an APRS-IS client receives them, '#' starts a comment. corpusgen.h writes a large
+// varied corpus.
+
+
+const char *packet_type_name(AprsPacketType type);
+int parse_benchmark(const char *corpus, unsigned passes);
@@ -0,0 +1,596 @@
+#include <LoRa.h>
+#include <SSD1306Wire.h>
+#include <cmath>
+#include <sim.h>
+
+static constexpr size_t lora_max_payload = 255;
+static constexpr uint32_t i2c_hz = 700000;     // SSD1306Wire default clock
+static constexpr size_t i2c_bits_per_byte = 9; // data and ack
+static constexpr size_t i2c_command_bytes = 3; // address, control byte, command
+static constexpr size_t i2c_chunk = 16;        // data bytes per transaction of the driver
+static constexpr size_t oled_init_commands = 25;
+static constexpr int16_t glyph_width = 6;      // cell of the shim font
+static constexpr int16_t narrow_width = 3;     // cell of i, l, punctuation, roughly as in ArialMT_Plain_10
+static constexpr int16_t glyph_height = 10;
+
+LoRaClass LoRa;
+
+// the radio's fifo, the frame being sent or one received frame like the SX1276 in continuous receive
+static uint8_t s_txData[lora_max_payload];
+static uint8_t s_rxData[lora_max_payload];
+static size_t s_rxLength = 0;
+static size_t s_rxIndex = 0;
+static bool s_rxPending = false; // rx done irq flag
+static bool s_listening = false;
+static int s_rxDio0 = LORA_DEFAULT_DIO0_PIN;
+static int s_rssi = 0;
+static float s_snr = 0;
+
+// the SSD1306 behind the display driver and the Wire shim, horizontal addressing mode
+static uint8_t s_gddram[OLEDDisplay::buffer_size]; // what the panel shows
+static uint8_t s_columns[2] = {0, OLEDDisplay::display_width - 1};
+static uint8_t s_pages[2] = {0, OLEDDisplay::display_height / 8 - 1};
+static uint8_t s_column = 0;
+static uint8_t s_page = 0;
+static uint8_t s_command[3]; // a command and its arguments, which may come in separate transactions
+static size_t s_commandLength = 0;
+
+// the shim font ignores the font data, only its address is compared
+const uint8_t ArialMT_Plain_10[] = {10};
+const uint8_t ArialMT_Plain_16[] = {16};
+const uint8_t ArialMT_Plain_24[] = {24};
+
+
+int LoRaClass::begin(long frequency)
+{
+    return 1;
+}
+
+void LoRaClass::end()
+{
+}
+
+int LoRaClass::beginPacket(int implicitHeader)
+{
+    if (isTransmitting())
+        return 0;
+    s_listening = false;
+    m_implicitHeader = implicitHeader;
+    m_length = 0;
+    return 1;
+}
+
+/**
+ * @brief puts the frame on air, async returns at once and raises DIO0 when done, otherwise waits
+ */
+int LoRaClass::endPacket(bool async)
+{
+    auto &sim = Simulator::instance();
+    const auto duration = airtime(m_length);
+    ++sim.metrics.radioFrames;
+    sim.metrics.radioBytes += m_length;
+    sim.metrics.airtimeUs += duration;
+    sim_log("lora tx %zu bytes, %llu ms on air", m_length, static_cast<unsigned long long>(duration / 1000));
+    if (sim.onRadioOutput)
+        sim.onRadioOutput(s_txData, m_length);
+
+    m_txEnd = sim.now() + duration;
+    if (async)
+    {
+        const auto dio0 = m_dio0;
+        sim.at(m_txEnd, [dio0]() { Simulator::instance().setPin(dio0, HIGH); });
+        return 1;
+    }
+    sim.advance(duration);
+    return 1;
+}
+
+/**
+ * @brief length of a received frame, clears the rx done irq and idles the radio like the library
+ */
+int LoRaClass::parsePacket(int size)
+{
+    if (!s_rxPending)
+        return 0;
+    s_rxPending = false;
+    s_rxIndex = 0;
+    s_listening = false;
+    Simulator::instance().setPin(m_dio0, LOW);
+    return static_cast<int>(s_rxLength);
+}
+
+int LoRaClass::packetRssi()
+{
+    return s_rssi;
+}
+
+float LoRaClass::packetSnr()
+{
+    return s_snr;
+}
+
+long LoRaClass::packetFrequencyError()
+{
+    return 0;
+}
+
+size_t LoRaClass::write(uint8_t byte)
+{
+    return write(&byte, 1);
+}
+
+size_t LoRaClass::write(const uint8_t *buffer, size_t size)
+{
+    if (m_length + size > lora_max_payload)
+        size = lora_max_payload - m_length;
+    memcpy(s_txData + m_length, buffer, size);
+    m_length += size;
+    return size;
+}
+
+int LoRaClass::available()
+{
+    return static_cast<int>(s_rxLength - s_rxIndex);
+}
+
+int LoRaClass::read()
+{
+    return s_rxIndex < s_rxLength ? s_rxData[s_rxIndex++] : -1;
+}
+
+int LoRaClass::peek()
+{
+    return s_rxIndex < s_rxLength ? s_rxData[s_rxIndex] : -1;
+}
+
+void LoRaClass::onReceive(void (*callback)(int))
+{
+}
+
+void LoRaClass::onTxDone(void (*callback)())
+{
+}
+
+void LoRaClass::receive(int size)
+{
+    s_listening = true;
+    s_rxDio0 = m_dio0;
+}
+
+void LoRaClass::idle()
+{
+    s_listening = false;
+}
+
+void LoRaClass::sleep()
+{
+    s_listening = false;
+}
+
+void LoRaClass::setTxPower(int level, int outputPin)
+{
+}
+
+void LoRaClass::setFrequency(long frequency)
+{
+}
+
+void LoRaClass::setSpreadingFactor(int sf)
+{
+    m_spreadingFactor = sf < 6 ? 6 : sf > 12 ? 12 : sf;
+}
+
+void LoRaClass::setSignalBandwidth(long sbw)
+{
+    m_bandwidth = sbw;
+}
+
+void LoRaClass::setCodingRate4(int denominator)
+{
+    m_codingRate = denominator < 5 ? 5 : denominator > 8 ? 8 : denominator;
+}
+
+void LoRaClass::setPreambleLength(long length)
+{
+    m_preamble = length;
+}
+
+void LoRaClass::setSyncWord(int sw)
+{
+}
+
+void LoRaClass::enableCrc()
+{
+    m_crc = true;
+}
+
+void LoRaClass::disableCrc()
+{
+    m_crc = false;
+}
+
+void LoRaClass::setPins(int ss, int reset, int dio0)
+{
+    m_dio0 = dio0;
+}
+
+/**
+ * @brief true while a frame is on air, afterwards clears the TX_DONE irq and with it DIO0
+ */
+bool LoRaClass::isTransmitting()
+{
+    auto &sim = Simulator::instance();
+    if (sim.now() < m_txEnd)
+        return true;
+    sim.setPin(m_dio0, LOW);
+    return false;
+}
+
+/**
+ * @brief what the simulated SSD1306 shows, in the page layout of the display driver's buffer
+ */
+const uint8_t *sim_panel()
+{
+    return s_gddram;
+}
+
+/**
+ * @brief a frame ends on air, the radio only takes it while it listens
+ * @note an unread frame is overwritten like in the radio's fifo
+ */
+void sim_lora_receive(const uint8_t *data, size_t length, int rssi, float snr)
+{
+    auto &sim = Simulator::instance();
+    if (!s_listening)
+    {
+        ++sim.metrics.radioRxLost;
+        return;
+    }
+    if (s_rxPending)
+        ++sim.metrics.radioRxLost;
+    ++sim.metrics.radioRxFrames;
+    s_rxLength = length < lora_max_payload ? length : lora_max_payload;
+    memcpy(s_rxData, data, s_rxLength);
+    s_rxIndex = 0;
+    s_rxPending = true;
+    s_rssi = rssi;
+    s_snr = snr;
+    sim.setPin(s_rxDio0, HIGH);
+}
+
+/**
+ * @brief Semtech AN1200.13 time on air, low data rate optimization above 16 ms symbols like the library
+ */
+uint64_t LoRaClass::airtime(size_t length) const
+{
+    const double symbol = std::ldexp(1.0, m_spreadingFactor) / m_bandwidth * 1e6; // [us]
+    const int lowDataRate = symbol > 16000 ? 1 : 0;
+    const double bits = 8.0 * length - 4 * m_spreadingFactor + 28 + (m_crc ? 16 : 0) - (m_implicitHeader ? 20 : 0);
+    const double blocks = std::ceil(bits / (4 * (m_spreadingFactor - 2 * lowDataRate)));
+    const double symbols = m_preamble + 4.25 + 8 + (blocks > 0 ? blocks * m_codingRate : 0);
+    return static_cast<uint64_t>(symbols * symbol);
+}
+
+
+bool OLEDDisplay::init()
+{
+    if (!connect())
+        return false;
+    memset(buffer, 0, buffer_size);
+    memset(s_gddram, 0, buffer_size);
+    transfer(oled_init_commands * i2c_command_bytes);
+    return true;
+}
+
+void OLEDDisplay::end()
+{
+}
+
+void OLEDDisplay::resetDisplay()
+{
+    clear();
+    memset(s_gddram, 0xFF, buffer_size); // forces a full transfer
+    display();
+}
+
+void OLEDDisplay::clear()
+{
+    memset(buffer, 0, buffer_size);
+}
+
+void OLEDDisplay::displayOn()
+{
+    transfer(i2c_command_bytes);
+}
+
+void OLEDDisplay::displayOff()
+{
+    transfer(i2c_command_bytes);
+}
+
+void OLEDDisplay::flipScreenVertically()
+{
+    transfer(2 * i2c_command_bytes);
+}
+
+void OLEDDisplay::setBrightness(uint8_t brightness)
+{
+    transfer(6 * i2c_command_bytes);
+}
+
+void OLEDDisplay::setContrast(uint8_t contrast, uint8_t precharge, uint8_t comdetect)
+{
+    transfer(6 * i2c_command_bytes);
+}
+
+void OLEDDisplay::setColor(OLEDDISPLAY_COLOR color)
+{
+    m_color = color;
+}
+
+OLEDDISPLAY_COLOR OLEDDisplay::getColor()
+{
+    return m_color;
+}
+
+void OLEDDisplay::setPixel(int16_t x, int16_t y)
+{
+    if (x < 0 || x >= display_width || y < 0 || y >= display_height)
+        return;
+    auto &byte = buffer[x + (y >> 3) * display_width];
+    const uint8_t bit = 1 << (y & 7);
+    switch (m_color)
+    {
+    case WHITE:
+        byte |= bit;
+        break;
+    case BLACK:
+        byte &= ~bit;
+        break;
+    case INVERSE:
+        byte ^= bit;
+        break;
+    }
+}
+
+void OLEDDisplay::clearPixel(int16_t x, int16_t y)
+{
+    const auto color = m_color;
+    m_color = m_color == BLACK ? WHITE : BLACK;
+    setPixel(x, y);
+    m_color = color;
+}
+
+void OLEDDisplay::drawHorizontalLine(int16_t x, int16_t y, int16_t length)
+{
+    for (int16_t i = 0; i < length; ++i)
+        setPixel(x + i, y);
+}
+
+void OLEDDisplay::drawVerticalLine(int16_t x, int16_t y, int16_t length)
+{
+    for (int16_t i = 0; i < length; ++i)
+        setPixel(x, y + i);
+}
+
+void OLEDDisplay::drawRect(int16_t x, int16_t y, int16_t width, int16_t height)
+{
+    drawHorizontalLine(x, y, width);
+    drawHorizontalLine(x, y + height - 1, width);
+    drawVerticalLine(x, y + 1, height - 2);
+    drawVerticalLine(x + width - 1, y + 1, height - 2);
+}
+
+void OLEDDisplay::fillRect(int16_t x, int16_t y, int16_t width, int16_t height)
+{
+    for (int16_t i = 0; i < height; ++i)
+        drawHorizontalLine(x, y + i, width);
+}
+
+void OLEDDisplay::setTextAlignment(OLEDDISPLAY_TEXT_ALIGNMENT textAlignment)
+{
+    m_alignment = textAlignment;
+}
+
+void OLEDDisplay::setFont(const uint8_t *fontData)
+{
+}
+
+/**
+ * @brief width of a glyph cell, one column of it is spacing
+ */
+static int16_t glyph_cell(uint8_t code)
+{
+    return code && strchr("iljI.,:;!|'", code) ? narrow_width : glyph_width;
+}
+
+/**
+ * @brief draws an 8 row pattern per character derived from its code, enough to dirty the right bytes
+ */
+uint16_t OLEDDisplay::drawString(int16_t x, int16_t y, const String &text)
+{
+    const auto width = getStringWidth(text);
+    if (m_alignment == TEXT_ALIGN_RIGHT)
+        x -= width;
+    else if (m_alignment != TEXT_ALIGN_LEFT)
+        x -= width / 2;
+    if (m_alignment == TEXT_ALIGN_CENTER_BOTH)
+        y -= glyph_height / 2;
+
+    for (const char *c = text.c_str(); *c; ++c)
+    {
+        const auto code = static_cast<uint8_t>(*c);
+        if ((code & 0xC0) == 0x80)
+            continue; // utf-8 continuation, one glyph per character
+        if (code != ' ')
+        {
+            for (int16_t column = 0; column < glyph_cell(code) - 1; ++column)
+            {
+                const uint8_t pattern = static_cast<uint8_t>(code * (column + 3) ^ (code >> column)) | 0x81;
+                for (int16_t row = 0; row < 8; ++row)
+                {
+                    if (pattern & (1 << row))
+                        setPixel(x + column, y + 1 + row);
+                }
+            }
+        }
+        x += glyph_cell(code);
+    }
+    return width;
+}
+
+uint16_t OLEDDisplay::getStringWidth(const String &text)
+{
+    uint16_t width = 0;
+    for (const char *c = text.c_str(); *c; ++c)
+    {
+        const auto code = static_cast<uint8_t>(*c);
+        if ((code & 0xC0) != 0x80)
+            width += glyph_cell(code);
+    }
+    return width;
+}
+
+/**
+ * @brief counts the i2c bytes and the bus time they take
+ */
+static void i2c_transfer(size_t bytes)
+{
+    auto &sim = Simulator::instance();
+    sim.metrics.displayBytes += bytes;
+    sim.advance(static_cast<uint64_t>(bytes) * i2c_bits_per_byte * 1000000 / i2c_hz);
+}
+
+/**
+ * @brief next command byte, only the address window commands are interpreted
+ */
+static void oled_command(uint8_t byte)
+{
+    s_command[s_commandLength++] = byte;
+    const bool window = s_command[0] == 0x21 || s_command[0] == 0x22;
+    if (window && s_commandLength < sizeof(s_command))
+        return;
+    if (s_command[0] == 0x21)
+    {
+        s_columns[0] = s_command[1];
+        s_columns[1] = s_command[2];
+        s_column = s_columns[0];
+    }
+    else if (s_command[0] == 0x22)
+    {
+        s_pages[0] = s_command[1];
+        s_pages[1] = s_command[2];
+        s_page = s_pages[0];
+    }
+    s_commandLength = 0;
+}
+
+/**
+ * @brief one SSD1306 transaction: control byte 0x00 a command stream, 0x80 one command and another control byte,
+ * 0x40 display data that fills the address window
+ */
+static void oled_transaction(const uint8_t *data, size_t length)
+{
+    size_t i = 0;
+    while (i < length)
+    {
+        const auto control = data[i++];
+        if (control & 0x40)
+        {
+            for (; i < length; ++i)
+            {
+                s_gddram[s_column + s_page * OLEDDisplay::display_width] = data[i];
+                if (s_column++ < s_columns[1])
+                    continue;
+                s_column = s_columns[0];
+                s_page = s_page < s_pages[1] ? s_page + 1 : s_pages[0];
+            }
+        }
+        else if (control & 0x80)
+        {
+            if (i < length)
+                oled_command(data[i++]);
+        }
+        else
+        {
+            while (i < length)
+                oled_command(data[i++]);
+        }
+    }
+}
+
+void OLEDDisplay::transfer(size_t bytes)
+{
+    i2c_transfer(bytes);
+}
+
+
+void TwoWire::beginTransmission(uint8_t address)
+{
+    m_address = address;
+    m_length = 0;
+}
+
+/**
+ * @brief the address byte and the buffered bytes go on the bus
+ */
+uint8_t TwoWire::endTransmission(bool sendStop)
+{
+    i2c_transfer(1 + m_length);
+    oled_transaction(m_buffer, m_length);
+    m_length = 0;
+    return 0;
+}
+
+size_t TwoWire::write(uint8_t byte)
+{
+    return write(&byte, 1);
+}
+
+size_t TwoWire::write(const uint8_t *data, size_t length)
+{
+    if (length > buffer_length - m_length)
+        length = buffer_length - m_length;
+    memcpy(m_buffer + m_length, data, length);
+    m_length += length;
+    return length;
+}
+
+
+SSD1306Wire::SSD1306Wire(uint8_t address, int sda, int scl, OLEDDISPLAY_GEOMETRY g, HW_I2C i2cBus, int frequency)
+    : m_address(address)
+{
+}
+
+bool SSD1306Wire::connect()
+{
+    return true;
+}
+
+/**
+ * @brief sends the bounding box of the changed bytes, nothing if the buffer is unchanged
+ */
+void SSD1306Wire::display()
+{
+    auto &sim = Simulator::instance();
+    ++sim.metrics.displayRefreshes;
+    int16_t minX = display_width, maxX = -1, minPage = display_height / 8, maxPage = -1;
+    for (int16_t page = 0; page < display_height / 8; ++page)
+    {
+        for (int16_t x = 0; x < display_width; ++x)
+        {
+            const auto index = x + page * display_width;
+            if (buffer[index] == s_gddram[index])
+                continue;
+            minX = x < minX ? x : minX;
+            maxX = x > maxX ? x : maxX;
+            minPage = page < minPage ? page : minPage;
+            maxPage = page;
+        }
+    }
+    if (maxX < 0)
+        return;
+    const size_t data = static_cast<size_t>(maxX - minX + 1) * (maxPage - minPage + 1);
+    transfer(6 * i2c_command_bytes + data + (data + i2c_chunk - 1) / i2c_chunk * 2);
+    memcpy(s_gddram, buffer, buffer_size);
+}
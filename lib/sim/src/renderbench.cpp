@@ -0,0 +1,124 @@
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <hb9gl.h>
+#include <renderbench.h>
+#include <sim.h>
+
+/**
+ * @brief update sequences of the benchmark, frame n of a sequence is a function of n
+ */
+static const struct
+{
+    const char *name;
+    std::function<void(unsigned, TelemetrySnapshot &)> update;
+} sequences[] = {
+    {"unchanged", [](unsigned, TelemetrySnapshot &) {}},
+    {"status", [](unsigned n, TelemetrySnapshot &data) { data.status ^= 1U << (n % tlm_digital_count); }},
+    {"battery",
+     [](unsigned n, TelemetrySnapshot &data) {
+         data.intvoltage = static_cast<uint16_t>(3500 + n * 37 % 700);
+         data.battPercent = static_cast<uint8_t>((data.intvoltage - 3500) / 7);
+     }},
+    {"climate",
+     [](unsigned n, TelemetrySnapshot &data) {
+         data.temperature = static_cast<int16_t>(n * 13 % 500 - 100);
+         data.humidity = static_cast<uint8_t>(n * 7 % 100);
+     }},
+    {"mixed",
+     [](unsigned n, TelemetrySnapshot &data) {
+         // mostly unchanged, now and then one of the others, like a station on the desk
+         if (n % 7 == 0)
+             data.status ^= 1U << (n % tlm_digital_count);
+         if (n % 5 == 0)
+             data.intvoltage = static_cast<uint16_t>(3900 + n % 3 * 100);
+         if (n % 11 == 0)
+             data.temperature = static_cast<int16_t>(200 + n % 4 * 5);
+     }},
+};
+
+/**
+ * @brief host time of one call of render per frame of a sequence
+ *
+ * @return double [ns] per frame
+ */
+static double measure(unsigned frames, std::function<void(unsigned, TelemetrySnapshot &)> update,
+                      std::function<void(const TelemetrySnapshot &)> render)
+{
+    TelemetrySnapshot data{};
+    data.intvoltage = 4100;
+    data.battPercent = 85;
+    data.temperature = 215;
+    data.humidity = 45;
+    const auto start = std::chrono::steady_clock::now();
+    for (unsigned n = 0; n < frames; ++n)
+    {
+        update(n, data);
+        render(data);
+    }
+    const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return frames ? elapsed.count() / frames : 0;
+}
+
+/**
+ * @brief renders every sequence both ways, prints the time per frame and the frames that differ
+ *
+ * @param frames per sequence
+ * @return int exit code, 1 if an incremental frame differs from the full one
+ */
+int render_benchmark(unsigned frames)
+{
+    static const Settings board;
+    static AsyncDht dht(board.tlm.dht11_pin);
+    static SSD1306 lcd(board.basic.display_address, board.basic.display_sda, board.basic.display_scl);
+    static Display incremental(lcd, dht);
+    static Display full(lcd, dht);
+    incremental.init();
+    full.init();
+
+    uint32_t mismatches = 0;
+    for (const auto &sequence : sequences)
+    {
+        measure(frames, sequence.update, [&](const TelemetrySnapshot &data) {
+            incremental.render(data);
+            full.renderFull(data);
+            mismatches += memcmp(incremental.frame(), full.frame(), OledPanel::frame_size) != 0;
+        });
+        const auto fullNs = measure(frames, sequence.update, [&](const TelemetrySnapshot &data) {
+            full.renderFull(data);
+        });
+        const auto incrementalNs = measure(frames, sequence.update, [&](const TelemetrySnapshot &data) {
+            incremental.render(data);
+        });
+        printf("render_%s_full_ns=%.0f\n", sequence.name, fullNs);
+        printf("render_%s_incremental_ns=%.0f\n", sequence.name, incrementalNs);
+        printf("render_%s_speedup=%.1f\n", sequence.name, incrementalNs > 0 ? fullNs / incrementalNs : 0);
+    }
+
+    // a frame sent a page per render, as the single core loop does, must be on the panel once flushPage() completes
+    OledPanel panel(Wire, board.basic.display_address);
+    uint8_t sent[OledPanel::frame_size];
+    bool flushing = false;
+    uint32_t flushed = 0;
+    uint32_t panelMismatches = 0;
+    for (const auto &sequence : sequences)
+    {
+        measure(frames, sequence.update, [&](const TelemetrySnapshot &data) {
+            incremental.render(data);
+            if (!flushing)
+                memcpy(sent, incremental.frame(), OledPanel::frame_size);
+            flushing = !panel.flushPage(sent);
+            if (flushing)
+                return;
+            ++flushed;
+            panelMismatches += memcmp(sim_panel(), sent, OledPanel::frame_size) != 0;
+        });
+    }
+
+    printf("render_frames=%u\n", frames);
+    printf("render_mismatches=%u\n", mismatches);
+    printf("render_paged_flushes=%u\n", flushed);
+    printf("render_panel_mismatches=%u\n", panelMismatches);
+    return mismatches || panelMismatches ? 1 : 0;
+}
@@ -0,0 +1,9 @@
+#pragma once
+
+// Display rendering on the host: the incremental render() against the full renderFull() of every redraw before
+// the static layers, over synthetic update sequences. every incremental frame is compared with the full one, and
+// frames flushed a page per render must end up on the simulated panel.
+// the shim font rasterises differently from ArialMT_Plain_10, the ratio between the paths is what counts.
+
+
+int render_benchmark(unsigned frames);
@@ -0,0 +1,99 @@
+#include <check.h>
+#include <scheduler.h>
+#include <schedulercheck.h>
+
+static unsigned long s_now = 0; // [ms] clock of the checked scheduler
+static unsigned s_calls = 0;    // job function calls
+
+static unsigned long check_clock()
+{
+    return s_now;
+}
+
+static void count_call()
+{
+    ++s_calls;
+}
+
+/**
+ * @brief runs the checks, each on a new scheduler
+ *
+ * @return int exit code, 1 if a check failed
+ */
+int scheduler_check()
+{
+    CheckCount check;
+    constexpr unsigned long day = 24UL * 60 * 60 * 1000;
+
+    {
+        s_now = 1000;
+        Scheduler scheduler(check_clock);
+        check(scheduler.nextDeadline() == s_now + day, "empty_next_deadline");
+        SchedulerJob a("a", count_call);
+        scheduler.once(a, 2500);
+        check(scheduler.nextDeadline() == 3500, "before_first_run");
+        scheduler.run();
+        check(scheduler.nextDeadline() == 3500, "more_than_one_rotation_ahead");
+    }
+
+    // the job fell due after the last run(), a later one is in the slots of the walk from the current tick
+    {
+        s_now = 0;
+        Scheduler scheduler(check_clock);
+        SchedulerJob a("a", count_call);
+        SchedulerJob b("b", count_call);
+        scheduler.once(a, 15);
+        scheduler.once(b, 300);
+        scheduler.run();
+        s_now = 25;
+        check(scheduler.nextDeadline() == 15, "due_since_last_run");
+        s_calls = 0;
+        check(scheduler.run() == 1 && s_calls == 1 && a.runs == 1, "due_job_runs");
+        check(scheduler.nextDeadline() == 300, "next_after_run");
+    }
+
+    // the same across the wrap of the wheel
+    {
+        s_now = 630;
+        Scheduler scheduler(check_clock);
+        SchedulerJob a("a", count_call);
+        SchedulerJob b("b", count_call);
+        scheduler.run();
+        scheduler.once(a, 10);
+        scheduler.once(b, 50);
+        s_now = 700;
+        check(scheduler.nextDeadline() == 640, "due_across_wrap");
+    }
+
+    // armed into the tick the last run() swept, found by the next run() in the same tick
+    {
+        s_now = 100;
+        Scheduler scheduler(check_clock);
+        SchedulerJob a("a", count_call);
+        scheduler.run();
+        s_now = 103;
+        scheduler.once(a, 2);
+        check(scheduler.nextDeadline() == 105, "armed_into_swept_tick_deadline");
+        s_now = 106;
+        check(scheduler.run() == 1 && a.runs == 1, "armed_into_swept_tick_runs");
+    }
+
+    // a periodic job runs once when late and skips the periods it missed
+    {
+        s_now = 1000;
+        Scheduler scheduler(check_clock);
+        SchedulerJob a("a", count_call);
+        scheduler.every(a, 100);
+        scheduler.run();
+        s_now = 1100;
+        scheduler.run();
+        s_now = 1450;
+        scheduler.run();
+        check(a.runs == 3 && a.overruns == 2 && a.maxLateness == 250, "late_periodic_overruns");
+        check(a.deadline == 1500 && scheduler.nextDeadline() == 1500, "late_periodic_next_deadline");
+        scheduler.cancel(a);
+        check(scheduler.nextDeadline() == s_now + day, "cancelled");
+    }
+
+    return check.report("scheduler");
+}
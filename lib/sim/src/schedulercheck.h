@@ -0,0 +1,8 @@
+#pragma once
+
+// Scheduler on a clock of its own: due jobs run once, late periodic jobs count their overruns, a job armed into the
+// tick run() just swept runs on the next call, and nextDeadline() reports jobs that fell due since the last run()
+// before later ones, across the wrap of the wheel and more than one rotation ahead.
+
+
+int scheduler_check();
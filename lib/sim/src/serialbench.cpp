@@ -0,0 +1,217 @@
+#include <algorithm>
+#include <check.h>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <serialbench.h>
+#include <serialproto.h>
+#include <vector>
+
+struct FuzzMessage
+{
+    uint32_t command;
+    std::vector<uint8_t> payload;
+};
+
+/**
+ * @brief random message, the payload is either mostly zeros, without zeros (long cobs blocks) or random
+ */
+static FuzzMessage random_message(std::mt19937 &random)
+{
+    FuzzMessage message;
+    message.command = random() % 3 ? random() % 32 : random();
+    message.payload.resize(random() % (SerialProtocol::max_payload + 1));
+    const auto kind = random() % 3;
+    for (auto &byte : message.payload)
+    {
+        byte = static_cast<uint8_t>(random());
+        if (kind == 0 && random() % 4)
+            byte = 0;
+        if (kind == 1 && !byte)
+            byte = 1;
+    }
+    return message;
+}
+
+static std::vector<uint8_t> encode(const FuzzMessage &message)
+{
+    std::vector<uint8_t> frame(SerialProtocol::max_frame);
+    frame.resize(SerialProtocol::encode(message.command, message.payload.data(), message.payload.size(),
+                                        frame.data(), frame.size()));
+    return frame;
+}
+
+static bool same(const SerialProtocol &link, const FuzzMessage &message)
+{
+    return link.command() == message.command && link.payloadLength() == message.payload.size() &&
+           !memcmp(link.payload(), message.payload.data(), message.payload.size());
+}
+
+/**
+ * @brief messages fed one by one come out at their delimiter and only there
+ */
+static void roundtrip_checks(CheckCount &check, std::mt19937 &random, unsigned frames)
+{
+    const char *const vector = "123456789";
+    check(SerialProtocol::crc16(reinterpret_cast<const uint8_t *>(vector), 9) == 0x29B1, "crc16_check_value");
+
+    SerialProtocol link;
+    bool ok = true;
+    for (unsigned n = 0; n < frames && ok; ++n)
+    {
+        const auto message = random_message(random);
+        const auto frame = encode(message);
+        ok = !frame.empty() && frame.size() <= SerialProtocol::max_frame && frame.back() == 0 &&
+             std::count(frame.begin(), frame.end(), 0) == 1;
+        for (size_t i = 0; i < frame.size() && ok; ++i)
+            ok = link.feed(frame[i]) == (i == frame.size() - 1);
+        ok = ok && same(link, message);
+    }
+    check(ok, "roundtrip");
+    check(link.crcErrors() == 0 && link.framingErrors() == 0, "roundtrip_no_errors");
+
+    uint8_t out[SerialProtocol::max_frame];
+    uint8_t payload[SerialProtocol::max_payload + 1] = {};
+    check(!SerialProtocol::encode(1, payload, sizeof(payload), out, sizeof(out)), "encode_too_long");
+    check(!SerialProtocol::encode(1, payload, 8, out, 15), "encode_no_room");
+}
+
+/**
+ * @brief a stream with damaged frames and line noise, the intact frames must all come out and nothing else
+ */
+static void stream_checks(CheckCount &check, std::mt19937 &random, unsigned frames)
+{
+    std::vector<FuzzMessage> intact;
+    std::vector<uint8_t> stream;
+    unsigned damaged = 0;
+    for (unsigned n = 0; n < frames; ++n)
+    {
+        const auto message = random_message(random);
+        auto frame = encode(message);
+        const auto body = frame.size() - 1; // the delimiter stays, the damage ends with the frame
+        switch (random() % 8)
+        {
+        case 0: // bit flip
+            frame[random() % body] ^= static_cast<uint8_t>(1U << (random() % 8));
+            break;
+        case 1: // lost byte
+            frame.erase(frame.begin() + random() % body);
+            break;
+        case 2: // extra byte, a 0 splits the frame
+            frame.insert(frame.begin() + random() % body, static_cast<uint8_t>(random()));
+            break;
+        case 3: // cut off
+            frame.erase(frame.begin() + random() % body, frame.end() - 1);
+            break;
+        case 4: // noise on the idle line, ended by a delimiter
+        {
+            std::vector<uint8_t> noise(1 + random() % 40);
+            for (auto &byte : noise)
+                byte = static_cast<uint8_t>(random());
+            noise.push_back(0);
+            stream.insert(stream.end(), noise.begin(), noise.end());
+            intact.push_back(message);
+            break;
+        }
+        default:
+            intact.push_back(message);
+            break;
+        }
+        damaged += frame != encode(message);
+        stream.insert(stream.end(), frame.begin(), frame.end());
+    }
+
+    SerialProtocol link;
+    size_t next = 0;
+    unsigned unexpected = 0;
+    for (auto byte : stream)
+    {
+        if (!link.feed(byte))
+            continue;
+        if (next < intact.size() && same(link, intact[next]))
+            ++next;
+        else
+            ++unexpected; // damage the crc didn't catch, or an intact frame out of order
+    }
+    printf("fuzz_stream_frames=%u\n", frames);
+    printf("fuzz_stream_damaged=%u\n", damaged);
+    printf("fuzz_stream_crc_errors=%u\n", link.crcErrors());
+    printf("fuzz_stream_framing_errors=%u\n", link.framingErrors());
+    check(next == intact.size(), "stream_intact_frames");
+    check(unexpected == 0, "stream_damaged_frames_dropped");
+}
+
+/**
+ * @brief random bytes only, the parser must keep going, the crc lets about 1 in 65536 fragments through
+ */
+static void noise_checks(CheckCount &check, std::mt19937 &random, size_t bytes)
+{
+    SerialProtocol link;
+    uint32_t accepted = 0;
+    for (size_t i = 0; i < bytes; ++i)
+        accepted += link.feed(static_cast<uint8_t>(random()));
+    const auto fragments = link.frames() + link.crcErrors() + link.framingErrors();
+    printf("fuzz_noise_bytes=%zu\n", bytes);
+    printf("fuzz_noise_fragments=%u\n", fragments);
+    printf("fuzz_noise_accepted=%u\n", accepted);
+    check(accepted == link.frames() && accepted * 1000 <= fragments / 65 + 1000, "noise_crc_rate");
+}
+
+/**
+ * @brief encode and feed time of messages of a given payload length
+ */
+static void throughput(unsigned frames, size_t length)
+{
+    std::vector<uint8_t> payload(length);
+    for (size_t i = 0; i < length; ++i)
+        payload[i] = static_cast<uint8_t>(i * 37 % 7 ? i : 0);
+    std::vector<uint8_t> frame(SerialProtocol::max_frame);
+    size_t frameLength = 0;
+    uint32_t checksum = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned n = 0; n < frames; ++n)
+    {
+        payload[0] = static_cast<uint8_t>(n);
+        frameLength = SerialProtocol::encode(n % 32, payload.data(), length, frame.data(), frame.size());
+        checksum += frame[frameLength - 2];
+    }
+    const std::chrono::duration<double> encodeTime = std::chrono::steady_clock::now() - start;
+
+    SerialProtocol link;
+    start = std::chrono::steady_clock::now();
+    for (unsigned n = 0; n < frames; ++n)
+    {
+        for (size_t i = 0; i < frameLength; ++i)
+            checksum += link.feed(frame[i]);
+    }
+    const std::chrono::duration<double> feedTime = std::chrono::steady_clock::now() - start;
+
+    const auto bytes = static_cast<double>(frameLength) * frames;
+    printf("serial_%zu_frame_bytes=%zu\n", length, frameLength);
+    printf("serial_%zu_encode_ns=%.0f\n", length, frames ? encodeTime.count() * 1e9 / frames : 0);
+    printf("serial_%zu_encode_mbytes_per_s=%.1f\n", length,
+           encodeTime.count() > 0 ? bytes / encodeTime.count() / 1e6 : 0);
+    printf("serial_%zu_feed_ns=%.0f\n", length, frames ? feedTime.count() * 1e9 / frames : 0);
+    printf("serial_%zu_feed_mbytes_per_s=%.1f\n", length, feedTime.count() > 0 ? bytes / feedTime.count() / 1e6 : 0);
+    printf("serial_%zu_checksum=%u\n", length, checksum);
+}
+
+/**
+ * @brief fuzz test, then the throughput of small and of the largest messages
+ *
+ * @param frames per fuzz run and per throughput run
+ * @return int exit code, 1 if a check failed
+ */
+int serial_benchmark(unsigned frames)
+{
+    std::mt19937 random(5);
+    CheckCount check;
+    roundtrip_checks(check, random, frames);
+    stream_checks(check, random, frames);
+    noise_checks(check, random, 64 * static_cast<size_t>(frames));
+    throughput(frames, 28); // esp_get_response_message
+    throughput(frames, SerialProtocol::max_payload);
+    return check.report("serial");
+}
@@ -0,0 +1,10 @@
+#pragma once
+
+// the pc-compagnion link framing on the host: a fuzz test of SerialProtocol and its encode/feed throughput
+//
+// the fuzz test round trips random messages, then feeds a stream of frames with flipped, dropped and inserted
+// bytes, truncated frames and line noise. every intact frame must come out unchanged and in order, a damaged one
+// never. random bytes alone show how often noise passes the crc-16 (about 1 in 65536 noise fragments).
+
+
+int serial_benchmark(unsigned frames);
@@ -0,0 +1,339 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdarg>
+#include <cstdio>
+#include <sim.h>
+#include <vector>
+
+static constexpr int sim_rising = 0x01;  // Arduino.h RISING
+static constexpr int sim_falling = 0x02; // Arduino.h FALLING
+static constexpr int sim_change = 0x03;  // Arduino.h CHANGE
+static constexpr int sim_wake_timer = 1; // esp_sleep_wakeup_cause_t
+static constexpr int sim_wake_gpio = 2;
+static constexpr int sim_wake_uart = 3;
+static constexpr uint64_t dht_start_us = 18000; // shortest start signal the sensor answers
+
+
+Simulator &Simulator::instance()
+{
+    static Simulator simulator;
+    return simulator;
+}
+
+/**
+ * @brief virtual time since power up
+ *
+ * @return uint64_t [us]
+ */
+uint64_t Simulator::now() const
+{
+    return m_now;
+}
+
+/**
+ * @brief the firmware is busy for some time, events due meanwhile run in order (interrupts)
+ *
+ * @param us [us]
+ */
+void Simulator::advance(uint64_t us)
+{
+    const auto until = m_now + us;
+    metrics.busyUs += us;
+    while (run_next(until))
+        ;
+    m_now = until;
+}
+
+/**
+ * @brief blocks the loop task until a task notification or the timeout, never past the end of the run
+ *
+ * @param us [us] timeout
+ * @return true if notified
+ */
+bool Simulator::waitForWake(uint64_t us)
+{
+    const auto until = us >= m_end - m_now ? m_end : m_now + us;
+    while (!m_notified && run_next(until))
+        ;
+    if (!m_notified && until > m_now)
+        m_now = until;
+    return takeNotification();
+}
+
+/**
+ * @brief light sleep until the timer, a gpio wake level or uart traffic
+ * @note isrs don't run while asleep, uart bytes arriving during the sleep are lost like on the chip
+ *
+ * @param timerUs [us] timer wakeup
+ * @return int esp_sleep_wakeup_cause_t
+ */
+int Simulator::lightSleep(uint64_t timerUs)
+{
+    ++metrics.lightSleeps;
+    m_wakeCause = 0;
+    for (const auto &wake : m_wakeLevels)
+    {
+        if (m_levels[wake.first] == wake.second)
+            return sim_wake_gpio;
+    }
+    const auto until = timerUs >= m_end - m_now ? m_end : m_now + timerUs;
+    m_sleeping = true;
+    while (!m_wakeCause && run_next(until))
+        ;
+    m_sleeping = false;
+    if (m_wakeCause)
+        return m_wakeCause;
+    if (until > m_now)
+        m_now = until;
+    return sim_wake_timer;
+}
+
+/**
+ * @brief schedules an event of the simulated world
+ *
+ * @param time [us] absolute virtual time
+ */
+void Simulator::at(uint64_t time, std::function<void()> event)
+{
+    m_events.emplace(time, std::move(event));
+}
+
+/**
+ * @brief waits return at this time at the latest, the run ends there
+ *
+ * @param time [us]
+ */
+void Simulator::setEnd(uint64_t time)
+{
+    m_end = time;
+}
+
+uint64_t Simulator::end() const
+{
+    return m_end;
+}
+
+void Simulator::notify()
+{
+    m_notified = true;
+}
+
+bool Simulator::takeNotification()
+{
+    const auto notified = m_notified;
+    m_notified = false;
+    return notified;
+}
+
+/**
+ * @brief sets the level of a pin, runs a matching isr or ends a light sleep
+ */
+void Simulator::setPin(uint8_t pin, int level)
+{
+    level = level ? 1 : 0;
+    if (pin == m_board.tlm.dht11_pin)
+    {
+        if (!level && m_output[pin])
+        {
+            m_dhtLow = true;
+            m_dhtLowSince = m_now;
+        }
+        else if (level && m_dhtLow)
+        {
+            m_dhtLow = false;
+            m_dhtStart = m_now - m_dhtLowSince >= dht_start_us;
+        }
+    }
+    if (m_levels[pin] == level)
+        return;
+    m_levels[pin] = level;
+
+    if (m_sleeping)
+    {
+        const auto wake = m_wakeLevels.find(pin);
+        if (wake != m_wakeLevels.end() && wake->second == level)
+            m_wakeCause = sim_wake_gpio;
+        return;
+    }
+    const auto isr = m_isrs.find(pin);
+    if (isr == m_isrs.end())
+        return;
+    const auto mode = isr->second.mode;
+    if (mode == sim_change || (mode == sim_rising && level) || (mode == sim_falling && !level))
+        isr->second.function();
+}
+
+int Simulator::pin(uint8_t pin) const
+{
+    return m_levels[pin];
+}
+
+/**
+ * @brief pin direction, an input only changes by scenario events or simulated peripherals
+ */
+void Simulator::driven(uint8_t pin, bool output)
+{
+    m_output[pin] = output;
+}
+
+void Simulator::attach(uint8_t pin, void (*isr)(), int mode)
+{
+    m_isrs[pin] = Isr{isr, mode};
+    // the dht11 answers after its start signal, the firmware watches the line from now on
+    if (pin == m_board.tlm.dht11_pin && mode == sim_falling && m_dhtStart)
+    {
+        m_dhtStart = false;
+        if (dhtPresent)
+            dht_answer();
+    }
+}
+
+void Simulator::detach(uint8_t pin)
+{
+    m_isrs.erase(pin);
+}
+
+/**
+ * @brief gpio light sleep wakeup
+ *
+ * @param level level that wakes the chip, -1 disables the wakeup of the pin
+ */
+void Simulator::wakeOnLevel(uint8_t pin, int level)
+{
+    if (level < 0)
+        m_wakeLevels.erase(pin);
+    else
+        m_wakeLevels[pin] = level;
+}
+
+/**
+ * @brief xorshift32, deterministic for a given seed
+ */
+uint32_t Simulator::random()
+{
+    m_random ^= m_random << 13;
+    m_random ^= m_random >> 17;
+    m_random ^= m_random << 5;
+    return m_random;
+}
+
+void Simulator::seed(uint32_t value)
+{
+    m_random = value ? value : 1;
+}
+
+/**
+ * @brief bytes from the pc-compagnion arrive at the uart
+ */
+void Simulator::serialInput(const uint8_t *data, size_t length)
+{
+    if (m_sleeping)
+    {
+        metrics.serialRxLost += length;
+        m_wakeCause = sim_wake_uart;
+        return;
+    }
+    serialRx.insert(serialRx.end(), data, data + length);
+    metrics.serialRxBytes += length;
+    if (onSerialReceive)
+        onSerialReceive();
+}
+
+/**
+ * @brief bytes written by the firmware, frames end with the 0x00 delimiter of serialproto.h
+ */
+void Simulator::serialOutput(const uint8_t *data, size_t length)
+{
+    metrics.serialTxBytes += length;
+    metrics.serialTxFrames += std::count(data, data + length, 0);
+    if (onSerialOutput)
+        onSerialOutput(data, length);
+}
+
+/**
+ * @brief runs the next event due until the given time
+ *
+ * @return false if none is due
+ */
+bool Simulator::run_next(uint64_t until)
+{
+    if (m_events.empty() || m_events.begin()->first > until)
+        return false;
+    const auto event = m_events.begin();
+    const auto function = std::move(event->second);
+    m_now = std::max(m_now, event->first);
+    m_events.erase(event);
+    function();
+    return true;
+}
+
+/**
+ * @brief schedules the falling edges of a dht11 answer to the current temperature and humidity
+ * @note 80 us low, 80 us high, then per bit 50 us low and 27 us (0) or 70 us (1) high, damaged by dhtFault
+ */
+void Simulator::dht_answer()
+{
+    const auto tenths = static_cast<int>(std::lround(std::fabs(temperature) * 10));
+    uint8_t bytes[5]{humidity, 0, static_cast<uint8_t>(tenths / 10), static_cast<uint8_t>(tenths % 10)};
+    if (temperature < 0)
+        bytes[3] |= 0x80;
+    bytes[4] = static_cast<uint8_t>(bytes[0] + bytes[1] + bytes[2] + bytes[3]);
+    if (dhtFault == DhtFault::checksum)
+        ++bytes[4];
+
+    std::vector<uint64_t> times;
+    auto time = m_now + 30;
+    times.push_back(time);
+    time += 160;
+    times.push_back(time);
+    for (size_t bit = 0; bit < 40; ++bit)
+    {
+        const bool one = bytes[bit / 8] & (0x80 >> (bit % 8));
+        time += 50 + (one ? 70 : 27) + random() % 3 + (dhtFault == DhtFault::slow_bit && bit == 17 ? 120 : 0);
+        times.push_back(time);
+    }
+    switch (dhtFault)
+    {
+    case DhtFault::missing_edge:
+        times.erase(times.begin() + 20);
+        break;
+    case DhtFault::extra_edge:
+        times.insert(times.begin() + 20, times[19] + 30);
+        break;
+    case DhtFault::early_edge:
+        times.insert(times.begin(), m_now + 5);
+        break;
+    case DhtFault::truncated:
+        times.resize(22);
+        break;
+    default:
+        break;
+    }
+
+    const uint8_t pin = m_board.tlm.dht11_pin;
+    auto edge = [this, pin]() {
+        if (m_output[pin])
+            return;
+        setPin(pin, 0);
+        setPin(pin, 1);
+    };
+    for (const auto at_time : times)
+        at(at_time, edge);
+    ++metrics.dhtFrames;
+}
+
+/**
+ * @brief trace output of the simulation, only with -v
+ */
+void sim_log(const char *format, ...)
+{
+    auto &sim = Simulator::instance();
+    if (!sim.verbose)
+        return;
+    fprintf(stderr, "[%12.6f] ", sim.now() / 1e6);
+    va_list args;
+    va_start(args, format);
+    vfprintf(stderr, format, args);
+    va_end(args);
+    fputc('\n', stderr);
+}
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <config.h>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <string>
+
+// host simulation of the board described by config.h, used by env:native
+// the Arduino, ESP-IDF, FreeRTOS, LoRa and SSD1306 headers of this library are shims on top of this simulator.
+// time is virtual: it only moves when the firmware waits (delay, task notification, light sleep) and by a fixed
+// cost per loop() pass, so hours of uptime run in seconds.
+
+
+/**
+ * @brief measurements of one run
+ */
+struct SimMetrics
+{
+    uint64_t loopIterations{0};
+    uint64_t busyUs{0};           // loop cost and delays, everything but waits
+    uint32_t waits{0};            // task notification waits
+    uint32_t lightSleeps{0};
+    uint32_t radioFrames{0};
+    uint64_t radioBytes{0};       // on air, lora-aprs header included
+    uint64_t airtimeUs{0};
+    uint32_t radioRxFrames{0};    // taken by the listening radio
+    uint32_t radioRxLost{0};      // arrived while the radio was off the air or its fifo unread
+    uint64_t serialRxBytes{0};
+    uint32_t serialRxLost{0};     // bytes that only woke the chip from light sleep
+    uint64_t serialTxBytes{0};
+    uint32_t serialTxFrames{0};
+    uint32_t displayRefreshes{0}; // display() calls of the driver
+    uint64_t displayBytes{0};     // i2c bytes to the display
+    uint32_t flashErases{0};
+    uint64_t flashBytesWritten{0};
+    uint32_t dhtFrames{0};
+    uint32_t restarts{0};
+};
+
+/**
+ * @brief damage of a simulated dht11 answer
+ */
+enum class DhtFault
+{
+    none,
+    checksum,     // last byte off by one
+    missing_edge, // one data edge lost
+    extra_edge,   // a glitch inside a bit
+    early_edge,   // a glitch before the answer
+    truncated,    // the sensor stops after half of the bits
+    slow_bit,     // one bit stretched beyond bit_max_us
+};
+
+class Simulator
+{
+public:
+    static Simulator &instance();
+
+    // virtual clock
+    uint64_t now() const;
+    void advance(uint64_t us);
+    bool waitForWake(uint64_t us);
+    int lightSleep(uint64_t timerUs);
+    void at(uint64_t time, std::function<void()> event);
+    void setEnd(uint64_t time);
+    uint64_t end() const;
+
+    // task notification of the loop task
+    void notify();
+    bool takeNotification();
+
+    // gpio
+    void setPin(uint8_t pin, int level);
+    int pin(uint8_t pin) const;
+    void driven(uint8_t pin, bool output);
+    void attach(uint8_t pin, void (*isr)(), int mode);
+    void detach(uint8_t pin);
+    void wakeOnLevel(uint8_t pin, int level);
+
+    // sensors
+    uint16_t battery_mv{4100};
+    float temperature{21.0f}; // [°C]
+    uint8_t humidity{45};     // [%]
+    bool dhtPresent{true};
+    DhtFault dhtFault{DhtFault::none};
+    uint16_t adcNoise{0};     // [counts] peak
+    uint32_t random();
+    void seed(uint32_t value);
+
+    // serial link to the pc-compagnion
+    void serialInput(const uint8_t *data, size_t length);
+    std::deque<uint8_t> serialRx;
+    std::function<void()> onSerialReceive;
+    void serialOutput(const uint8_t *data, size_t length);
+    std::function<void(const uint8_t *, size_t)> onSerialOutput;
+    unsigned long serialBaud{0}; // the uart tx fifo drains at this rate instead of the firmware's baud, a slow host
+
+    // lora frames put on air, lora-aprs header included
+    std::function<void(const uint8_t *, size_t)> onRadioOutput;
+
+    bool verbose{false};
+    bool hostCycles{false}; // ESP.getCycleCount() counts host cpu time, the probes then time the firmware code
+    SimMetrics metrics;
+
+private:
+    struct Isr
+    {
+        void (*function)();
+        int mode;
+    };
+
+    uint64_t m_now{0};
+    uint64_t m_end{~0ULL};
+    std::multimap<uint64_t, std::function<void()>> m_events;
+    bool m_notified{false};
+    int m_levels[40]{};
+    bool m_output[40]{};
+    std::map<uint8_t, Isr> m_isrs;
+    std::map<uint8_t, int> m_wakeLevels;
+    bool m_sleeping{false};
+    int m_wakeCause{0};
+    const Settings m_board;
+    uint64_t m_dhtLowSince{0};
+    bool m_dhtLow{false};   // start signal in progress
+    bool m_dhtStart{false}; // start signal long enough, the sensor answers once the line is watched
+    uint32_t m_random{1};
+
+    bool run_next(uint64_t until);
+    void dht_answer();
+};
+
+void sim_log(const char *format, ...);
+const uint8_t *sim_panel();
+void sim_partition_missing(const char *label, bool missing);
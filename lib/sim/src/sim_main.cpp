@@ -0,0 +1,597 @@
+#include <Arduino.h>
+#include <LoRa.h>
+#include <airtimecheck.h>
+#include <aprsbench.h>
+#include <aprscheck.h>
+#include <batterybench.h>
+#include <chrono>
+#include <corpusgen.h>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <dhtcheck.h>
+#include <fstream>
+#include <historybench.h>
+#include <interface.h>
+#include <map>
+#include <parsebench.h>
+#include <renderbench.h>
+#include <schedulercheck.h>
+#include <serialbench.h>
+#include <serialproto.h>
+#include <sim.h>
+#include <sstream>
+#include <storecheck.h>
+#include <telemetrycheck.h>
+#include <threadcheck.h>
+#include <txcheck.h>
+#include <vector>
+
+// entry point of env:native: runs the firmware's setup() and loop() against a scenario and prints the metrics
+//
+// usage: program [-v] [scenario]
+//        program --parse <corpus> [passes]   AprsParser throughput and round trips, see parsebench.h, '-' reads stdin
+//        program --corpus [frames] [seed]     writes a synthetic aprs-is feed for --parse, see corpusgen.h
+//        program --aprs [frames]              AprsFrame time and allocations per frame, see aprsbench.h
+//        program --serial [frames]            SerialProtocol fuzz test and throughput, see serialbench.h
+//        program --history [samples]          HistoryLog bytes per sample and query time, see historybench.h
+//        program --battery [trace]            BatteryMonitor filter cost and accuracy, see batterybench.h
+//        program --render [frames]            Display render time per frame, see renderbench.h
+//        program --tx                         LoRa tx queue and tx done checks, see txcheck.h
+//        program --telemetry                  telemetry channel table checks, see telemetrycheck.h
+//        program --airtime                    time on air and duty cycle budget checks, see airtimecheck.h
+//        program --store                      CounterStore checks on the simulated flash, see storecheck.h
+//        program --dht                        AsyncDht checks on damaged dht11 answers, see dhtcheck.h
+//        program --threads [items]            SpscQueue and Seqlock under real threads, see threadcheck.h
+//        program --compressed                 compressed aprs against a reference decoder, see aprscheck.h
+//        program --scheduler                  timer wheel runs and next deadline checks, see schedulercheck.h
+//
+// scenario lines, '#' starts a comment:
+//   duration <s>                     length of the run, default 23 h
+//   loopcost <us>                    cpu time of one loop() pass besides the simulated peripherals, default 200
+//   seed <n>                         random seed for adc noise and dht11 timing
+//   adcnoise <counts>                peak noise of the battery adc
+//   cycles virtual|host              what the latency probes measure: virtual time (default) or host cpu time
+//   serialbaud <baud>                rate the pc-compagnion takes the uart output at, default the firmware's baud
+//   <t> battery <mV>                 from <t> seconds on
+//   <t> climate <°C> <%> | off       dht11 values or no sensor
+//   <t> usb|mains <0|1>              power pins
+//   <t> send <message> [args]        pc-compagnion frame: keepalive, link <uplink> <echolink>, get, airtime, idle,
+//                                    tasks, probes [reset], subscribe <enable> <%> <mV> <0.1°C> <heartbeat s>, history <from> <to>,
+//                                    rx, display, serial, radio <receive> <digipeat>, reboot
+//   <t> rx <tnc2 frame>              a lora-aprs frame ends on air
+//   <t> rxstream <stations> <dupe %> a synthetic frame of one of the stations, or with the given chance one of the
+//                                    recent frames again via another digipeater
+//   <t> every <s> [until <t>] <command> [args]
+//                                    repeats any of the timed commands
+//
+// the firmware's answers to "send rx", "send display", "send serial" and "send probes" end up in the metrics as
+// rx_*, display_*, serial_queue_* and probe_* values, every frame put on air is parsed back and counted by type as tx_* values
+
+
+static constexpr uint64_t default_duration = 23ULL * 3600; // [s]
+static constexpr uint64_t default_loop_cost = 200;         // [us]
+
+static const Settings board;
+static uint64_t s_loopCost = default_loop_cost;
+static SerialProtocol s_pcSide; // decodes what the firmware sends for the trace and the metrics
+static esp_get_rx_response_message s_rxStats;
+static bool s_rxStatsSeen = false;
+static esp_get_display_response_message s_displayStats;
+static bool s_displayStatsSeen = false;
+static esp_get_serial_response_message s_serialStats;
+static bool s_serialStatsSeen = false;
+static uint32_t s_rxForwarded = 0;
+static std::map<std::string, esp_get_probes_response_message> s_probes;
+static uint32_t s_txTypes[aprs_telemetry_bits + 1] = {};
+static uint32_t s_txUnparsed = 0;
+static uint32_t s_txRepeated = 0; // frames of other stations, digipeated
+static std::deque<std::string> s_recentFrames; // of rxstream, for the duplicates
+static uint32_t s_streamCount = 0;
+
+
+template <typename T>
+static std::vector<uint8_t> frame(const T &msg, size_t length = sizeof(T))
+{
+    std::vector<uint8_t> out(SerialProtocol::max_frame);
+    out.resize(SerialProtocol::encode(T::command, &msg, length, out.data(), out.size()));
+    return out;
+}
+
+/**
+ * @brief encodes a pc-compagnion message from its scenario arguments
+ *
+ * @return std::vector<uint8_t> frame, empty for an unknown message
+ */
+static std::vector<uint8_t> message(const std::string &name, std::istringstream &args)
+{
+    if (name == "keepalive")
+        return frame(esp_get_keepAlive_message{});
+    if (name == "get")
+        return frame(esp_get_message{});
+    if (name == "airtime")
+        return frame(esp_get_airtime_message{});
+    if (name == "reboot")
+        return frame(esp_get_reboot_message{});
+    if (name == "idle")
+        return frame(esp_get_idle_message{}, 0);
+    if (name == "tasks")
+        return frame(esp_get_tasks_message{}, 0);
+    if (name == "rx")
+        return frame(esp_get_rx_message{}, 0);
+    if (name == "display")
+        return frame(esp_get_display_message{}, 0);
+    if (name == "serial")
+        return frame(esp_get_serial_message{}, 0);
+    if (name == "probes")
+    {
+        unsigned reset = 0;
+        args >> reset;
+        esp_get_probes_message msg{};
+        msg.reset = static_cast<uint8_t>(reset);
+        return frame(msg);
+    }
+    if (name == "link")
+    {
+        unsigned uplink = 0, echolink = 0;
+        args >> uplink >> echolink;
+        pc_link_message msg{};
+        msg.UplinkStatus = static_cast<uint8_t>(uplink);
+        msg.EcholinkStatus = static_cast<uint8_t>(echolink);
+        return frame(msg);
+    }
+    if (name == "subscribe")
+    {
+        unsigned enable = 1, humidity = 0, voltage = 0, temperature = 0, heartbeat = 0;
+        args >> enable >> humidity >> voltage >> temperature >> heartbeat;
+        esp_subscribe_message msg{};
+        msg.enable = static_cast<uint8_t>(enable);
+        msg.humidityThreshold = static_cast<uint8_t>(humidity);
+        msg.voltageThreshold = static_cast<uint16_t>(voltage);
+        msg.temperatureThreshold = static_cast<uint16_t>(temperature);
+        msg.heartbeatInterval = static_cast<uint16_t>(heartbeat);
+        return frame(msg);
+    }
+    if (name == "history")
+    {
+        esp_get_history_message msg{};
+        args >> msg.from >> msg.to;
+        return frame(msg);
+    }
+    if (name == "radio")
+    {
+        unsigned receive = 0, digipeat = 0;
+        args >> receive >> digipeat;
+        esp_set_radio_message msg{};
+        msg.receive = static_cast<uint8_t>(receive);
+        msg.digipeat = static_cast<uint8_t>(digipeat);
+        return frame(msg);
+    }
+    return {};
+}
+
+/**
+ * @brief puts a tnc2 frame on air with the lora-aprs header
+ */
+static void transmit(const std::string &text)
+{
+    sim_log("air: %s", text.c_str());
+    const std::string frame = std::string("<\xFF\x01") + text;
+    sim_lora_receive(reinterpret_cast<const uint8_t *>(frame.data()), frame.size(), -105, 6.5f);
+}
+
+/**
+ * @brief next frame of the synthetic packet stream
+ *
+ * @param stations number of stations heard
+ * @param dupes [%] chance of a recent frame heard again through another digipeater
+ */
+static std::string streamFrame(unsigned stations, unsigned dupes)
+{
+    auto &sim = Simulator::instance();
+    if (!s_recentFrames.empty() && sim.random() % 100 < dupes)
+    {
+        const auto &recent = s_recentFrames[sim.random() % s_recentFrames.size()];
+        const auto path = recent.find(",WIDE1-1:");
+        if (path != std::string::npos)
+            return recent.substr(0, path) + ",HB9XX-10,WIDE1*" + recent.substr(path + 8);
+    }
+    char text[128];
+    snprintf(text, sizeof(text), "SIM%u-%u>APLRT1,WIDE1-1:!4704.%02uN/00903.%02uE>stream frame %u",
+             sim.random() % stations, sim.random() % 16, sim.random() % 100, sim.random() % 100, ++s_streamCount);
+    s_recentFrames.push_back(text);
+    if (s_recentFrames.size() > 4)
+        s_recentFrames.pop_front();
+    return text;
+}
+
+/**
+ * @brief schedules an event and its repetitions
+ *
+ * @param until [us] last repetition, 0 for the end of the run
+ */
+static void repeat(std::function<void()> event, uint64_t time, uint64_t period, uint64_t until)
+{
+    if (until && time > until)
+        return;
+    Simulator::instance().at(time, [event, time, period, until]() {
+        event();
+        repeat(event, time + period, period, until);
+    });
+}
+
+/**
+ * @brief turns one timed scenario command into a simulator event
+ *
+ * @param period [us] repeats the event, 0 for once
+ * @param until [us] last repetition, 0 for the end of the run
+ * @return false on a syntax error
+ */
+static bool schedule(uint64_t time, uint64_t period, uint64_t until, const std::string &command,
+                     const std::string &rest)
+{
+    auto &sim = Simulator::instance();
+    std::istringstream args(rest);
+    std::function<void()> event;
+    if (command == "battery")
+    {
+        unsigned millivolts;
+        if (!(args >> millivolts))
+            return false;
+        event = [millivolts]() { Simulator::instance().battery_mv = static_cast<uint16_t>(millivolts); };
+    }
+    else if (command == "climate")
+    {
+        std::string temperature;
+        unsigned humidity = 0;
+        args >> temperature >> humidity;
+        if (temperature == "off")
+        {
+            event = []() { Simulator::instance().dhtPresent = false; };
+        }
+        else
+        {
+            const auto celsius = strtof(temperature.c_str(), nullptr);
+            event = [celsius, humidity]() {
+                auto &sim = Simulator::instance();
+                sim.dhtPresent = true;
+                sim.temperature = celsius;
+                sim.humidity = static_cast<uint8_t>(humidity);
+            };
+        }
+    }
+    else if (command == "usb" || command == "mains")
+    {
+        int level;
+        if (!(args >> level))
+            return false;
+        const uint8_t pin = command == "usb" ? board.tlm.usb_power_pin : board.tlm.ext_power_pin;
+        event = [pin, level]() { Simulator::instance().setPin(pin, level); };
+    }
+    else if (command == "rx")
+    {
+        std::string text;
+        std::getline(args >> std::ws, text);
+        if (text.empty())
+            return false;
+        event = [text]() { transmit(text); };
+    }
+    else if (command == "rxstream")
+    {
+        unsigned stations = 0, dupes = 0;
+        if (!(args >> stations >> dupes) || !stations)
+            return false;
+        event = [stations, dupes]() { transmit(streamFrame(stations, dupes)); };
+    }
+    else if (command == "send")
+    {
+        std::string name;
+        args >> name;
+        const auto bytes = message(name, args);
+        if (bytes.empty())
+            return false;
+        event = [bytes, name]() {
+            sim_log("pc sends %s", name.c_str());
+            Simulator::instance().serialInput(bytes.data(), bytes.size());
+        };
+    }
+    else
+    {
+        return false;
+    }
+
+    if (period)
+        repeat(event, time, period, until);
+    else
+        sim.at(time, event);
+    return true;
+}
+
+/**
+ * @brief reads the scenario file into simulator settings and events
+ */
+static bool load(const char *path)
+{
+    auto &sim = Simulator::instance();
+    std::ifstream file(path);
+    if (!file)
+    {
+        fprintf(stderr, "sim: can't open %s\n", path);
+        return false;
+    }
+    std::string line;
+    size_t number = 0;
+    while (std::getline(file, line))
+    {
+        ++number;
+        line = line.substr(0, line.find('#'));
+        std::istringstream words(line);
+        std::string first;
+        if (!(words >> first))
+            continue;
+
+        bool ok = true;
+        if (first == "duration")
+        {
+            double seconds;
+            ok = static_cast<bool>(words >> seconds);
+            sim.setEnd(static_cast<uint64_t>(seconds * 1e6));
+        }
+        else if (first == "loopcost")
+        {
+            ok = static_cast<bool>(words >> s_loopCost);
+        }
+        else if (first == "seed")
+        {
+            uint32_t seed;
+            ok = static_cast<bool>(words >> seed);
+            sim.seed(seed);
+        }
+        else if (first == "adcnoise")
+        {
+            ok = static_cast<bool>(words >> sim.adcNoise);
+        }
+        else if (first == "serialbaud")
+        {
+            ok = static_cast<bool>(words >> sim.serialBaud) && sim.serialBaud > 0;
+        }
+        else if (first == "cycles")
+        {
+            std::string clock;
+            ok = static_cast<bool>(words >> clock) && (clock == "virtual" || clock == "host");
+            sim.hostCycles = clock == "host";
+        }
+        else
+        {
+            const auto time = static_cast<uint64_t>(strtod(first.c_str(), nullptr) * 1e6);
+            std::string command;
+            words >> command;
+            double period = 0;
+            double until = 0;
+            if (command == "every")
+            {
+                ok = static_cast<bool>(words >> period >> command) && period > 0;
+                if (ok && command == "until")
+                    ok = static_cast<bool>(words >> until >> command);
+            }
+            std::string rest;
+            std::getline(words, rest);
+            ok = ok && schedule(time, static_cast<uint64_t>(period * 1e6), static_cast<uint64_t>(until * 1e6),
+                                command, rest);
+        }
+        if (!ok)
+        {
+            fprintf(stderr, "sim: %s:%zu: can't parse '%s'\n", path, number, line.c_str());
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief decodes the frames the pc-compagnion receives, keeps the figures of the metrics and logs them
+ */
+static void trace(const uint8_t *data, size_t length)
+{
+    for (size_t i = 0; i < length; ++i)
+    {
+        if (!s_pcSide.feed(data[i]))
+            continue;
+        sim_log("pc receives command %u, %zu bytes", s_pcSide.command(), s_pcSide.payloadLength());
+        esp_get_probes_response_message probe;
+        switch (s_pcSide.command())
+        {
+        case esp_get_rx_response_message::command:
+            s_rxStatsSeen = s_pcSide.decode(s_rxStats);
+            break;
+        case esp_get_display_response_message::command:
+            s_displayStatsSeen = s_pcSide.decode(s_displayStats);
+            break;
+        case esp_get_serial_response_message::command:
+            s_serialStatsSeen = s_pcSide.decode(s_serialStats);
+            break;
+        case esp_rx_frame_message::command:
+            ++s_rxForwarded;
+            break;
+        case esp_get_probes_response_message::command:
+            if (s_pcSide.decode(probe))
+                s_probes[std::string(probe.name, strnlen(probe.name, sizeof(probe.name)))] = probe;
+            break;
+        }
+    }
+}
+
+/**
+ * @brief parses the frames the firmware puts on air
+ */
+static void onAir(const uint8_t *data, size_t length)
+{
+    constexpr size_t lora_header = 3; // "<\xFF\x01"
+    AprsPacket packet;
+    if (length < lora_header ||
+        !AprsParser::parse(std::string_view(reinterpret_cast<const char *>(data) + lora_header, length - lora_header),
+                           packet))
+    {
+        ++s_txUnparsed;
+        return;
+    }
+    ++s_txTypes[packet.type];
+    sim_log("tx frame: %s from %.*s", packet_type_name(packet.type), static_cast<int>(packet.source.size()),
+            packet.source.data());
+    if (packet.source != board.tlm.callsign)
+    {
+        ++s_txRepeated;
+        sim_log("tx repeated: %.*s", static_cast<int>(length - lora_header), data + lora_header);
+    }
+}
+
+static void report(double wallMs)
+{
+    const auto &sim = Simulator::instance();
+    const auto &metrics = sim.metrics;
+    const auto seconds = sim.now() / 1e6;
+    printf("sim_time_s=%.3f\n", seconds);
+    printf("wall_time_ms=%.1f\n", wallMs);
+    printf("loop_iterations=%llu\n", static_cast<unsigned long long>(metrics.loopIterations));
+    printf("loop_iterations_per_s=%.2f\n", seconds > 0 ? metrics.loopIterations / seconds : 0);
+    printf("busy_ms=%.3f\n", metrics.busyUs / 1e3);
+    printf("duty_cycle_permille=%.2f\n", sim.now() ? 1000.0 * metrics.busyUs / sim.now() : 0);
+    printf("waits=%u\n", metrics.waits);
+    printf("light_sleeps=%u\n", metrics.lightSleeps);
+    printf("radio_frames=%u\n", metrics.radioFrames);
+    printf("radio_bytes=%llu\n", static_cast<unsigned long long>(metrics.radioBytes));
+    printf("airtime_ms=%.3f\n", metrics.airtimeUs / 1e3);
+    printf("radio_rx_frames=%u\n", metrics.radioRxFrames);
+    printf("radio_rx_lost=%u\n", metrics.radioRxLost);
+    printf("serial_rx_bytes=%llu\n", static_cast<unsigned long long>(metrics.serialRxBytes));
+    printf("serial_rx_lost=%u\n", metrics.serialRxLost);
+    printf("serial_tx_bytes=%llu\n", static_cast<unsigned long long>(metrics.serialTxBytes));
+    printf("serial_tx_frames=%u\n", metrics.serialTxFrames);
+    printf("display_refreshes=%u\n", metrics.displayRefreshes);
+    printf("display_bytes=%llu\n", static_cast<unsigned long long>(metrics.displayBytes));
+    printf("flash_erases=%u\n", metrics.flashErases);
+    printf("flash_bytes_written=%llu\n", static_cast<unsigned long long>(metrics.flashBytesWritten));
+    printf("dht_frames=%u\n", metrics.dhtFrames);
+    printf("restarts=%u\n", metrics.restarts);
+    printf("pc_rx_frames=%u\n", s_rxForwarded);
+    for (size_t i = 0; i <= aprs_telemetry_bits; ++i)
+    {
+        if (s_txTypes[i])
+            printf("tx_%s=%u\n", packet_type_name(static_cast<AprsPacketType>(i)), s_txTypes[i]);
+    }
+    printf("tx_unparsed=%u\n", s_txUnparsed);
+    printf("tx_repeated=%u\n", s_txRepeated);
+    if (s_rxStatsSeen)
+    {
+        const auto &rx = s_rxStats;
+        printf("rx_frames=%u\n", rx.framesReceived);
+        printf("rx_invalid=%u\n", rx.framesInvalid);
+        printf("rx_duplicates=%u\n", rx.duplicates);
+        printf("rx_dupe_rate_pct=%.1f\n", rx.framesReceived ? 100.0 * rx.duplicates / rx.framesReceived : 0);
+        printf("rx_digipeated=%u\n", rx.digipeated);
+        printf("rx_forwarded=%u\n", rx.forwarded);
+        printf("rx_pool_drops=%u\n", rx.poolDrops);
+        printf("rx_cache_entries=%u/%u\n", rx.cacheEntries, rx.cacheCapacity);
+        printf("rx_cache_evictions=%u\n", rx.cacheEvictions);
+        printf("rx_memory_bytes=%u\n", rx.memory);
+        printf("rx_receive=%u\n", rx.receive);
+        printf("rx_digipeat=%u\n", rx.digipeat);
+    }
+    if (s_displayStatsSeen)
+    {
+        const auto &display = s_displayStats;
+        printf("display_redraws=%u\n", display.redraws);
+        printf("display_redraws_skipped=%u\n", display.redrawsSkipped);
+        printf("display_frames_dropped=%u\n", display.framesDropped);
+        printf("display_flush_latency_p99_us=%u\n", display.flushLatencyP99);
+        printf("display_flush_latency_max_us=%u\n", display.flushLatencyMax);
+        printf("display_flushes_unchanged=%u\n", display.flushesUnchanged);
+        printf("display_windows=%u\n", display.windows);
+        printf("display_panel_bytes=%u\n", display.bytes);
+    }
+    if (s_serialStatsSeen)
+    {
+        const auto &serial = s_serialStats;
+        printf("serial_queue_frames=%u\n", serial.frames);
+        printf("serial_queue_frames_dropped=%u\n", serial.framesDropped);
+        printf("serial_queue_bytes_dropped=%u\n", serial.bytesDropped);
+        printf("serial_queue_writes=%u\n", serial.writes);
+        printf("serial_queue_high_water=%u/%u\n", serial.highWater, serial.capacity);
+    }
+    for (const auto &probe : s_probes)
+    {
+        const auto name = probe.first.c_str();
+        printf("probe_%s_count=%u\n", name, probe.second.count);
+        printf("probe_%s_p99_us=%u\n", name, probe.second.p99);
+        printf("probe_%s_max_us=%u\n", name, probe.second.max);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    if (argc >= 3 && !strcmp(argv[1], "--parse"))
+        return parse_benchmark(argv[2], argc >= 4 ? static_cast<unsigned>(atoi(argv[3])) : 1000);
+    if (argc >= 2 && !strcmp(argv[1], "--corpus"))
+        return corpus_generate(argc >= 3 ? static_cast<unsigned>(atoi(argv[2])) : 100000,
+                               argc >= 4 ? static_cast<unsigned>(atoi(argv[3])) : 1);
+    if (argc >= 2 && !strcmp(argv[1], "--aprs"))
+        return aprs_benchmark(argc >= 3 ? static_cast<unsigned>(atoi(argv[2])) : 100000);
+    if (argc >= 2 && !strcmp(argv[1], "--serial"))
+        return serial_benchmark(argc >= 3 ? static_cast<unsigned>(atoi(argv[2])) : 20000);
+    if (argc >= 2 && !strcmp(argv[1], "--history"))
+        return history_benchmark(argc >= 3 ? static_cast<unsigned>(atoi(argv[2])) : 100000);
+    if (argc >= 2 && !strcmp(argv[1], "--battery"))
+        return battery_benchmark(argc >= 3 ? argv[2] : nullptr);
+    if (argc >= 2 && !strcmp(argv[1], "--render"))
+        return render_benchmark(argc >= 3 ? static_cast<unsigned>(atoi(argv[2])) : 10000);
+    if (argc >= 2 && !strcmp(argv[1], "--tx"))
+        return tx_check();
+    if (argc >= 2 && !strcmp(argv[1], "--telemetry"))
+        return telemetry_check();
+    if (argc >= 2 && !strcmp(argv[1], "--airtime"))
+        return airtime_check();
+    if (argc >= 2 && !strcmp(argv[1], "--store"))
+        return store_check();
+    if (argc >= 2 && !strcmp(argv[1], "--dht"))
+        return dht_check();
+    if (argc >= 2 && !strcmp(argv[1], "--compressed"))
+        return aprs_check();
+    if (argc >= 2 && !strcmp(argv[1], "--scheduler"))
+        return scheduler_check();
+    if (argc >= 2 && !strcmp(argv[1], "--threads"))
+        return thread_check(argc >= 3 ? static_cast<unsigned>(atoi(argv[2])) : 1000000);
+
+    auto &sim = Simulator::instance();
+    sim.setEnd(default_duration * 1000000);
+    for (int i = 1; i < argc; ++i)
+    {
+        if (!strcmp(argv[i], "-v"))
+            sim.verbose = true;
+        else if (!load(argv[i]))
+            return 1;
+    }
+
+    sim.onSerialOutput = trace;
+    sim.onRadioOutput = onAir;
+
+    const auto wallStart = std::chrono::steady_clock::now();
+    try
+    {
+        // power pins and sensors of t=0 are in place at power up
+        sim.advance(0);
+        setup();
+        while (sim.now() < sim.end())
+        {
+            loop();
+            ++sim.metrics.loopIterations;
+            sim.advance(s_loopCost);
+        }
+    }
+    catch (const SimRestart &)
+    {
+        // the run ends with the firmware's restart
+    }
+    const std::chrono::duration<double, std::milli> wall = std::chrono::steady_clock::now() - wallStart;
+    report(wall.count());
+    return 0;
+}
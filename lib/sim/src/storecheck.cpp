@@ -0,0 +1,154 @@
+#include <EEPROM.h>
+#include <check.h>
+#include <counterstore.h>
+#include <sim.h>
+#include <storecheck.h>
+
+static constexpr uint8_t batch = 8;                        // settings.basic.seq_commit_batch
+static constexpr int eeprom_address = 0;                   // settings.basic.EEPROMaddress
+static constexpr size_t sector_size = 4096;                // flash erase unit
+static constexpr size_t slots_per_sector = sector_size / 8; // {value, ~value} records
+
+static const esp_partition_t *seqlog()
+{
+    return esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, "seqlog");
+}
+
+/**
+ * @brief flash erases counted by the simulator
+ */
+static uint32_t flash_erases()
+{
+    return Simulator::instance().metrics.flashErases;
+}
+
+/**
+ * @brief value after a reboot, init() of a new store
+ */
+static uint32_t reboot(bool *restored = nullptr)
+{
+    CounterStore store(batch, eeprom_address);
+    const auto ok = store.init();
+    if (restored)
+        *restored = ok;
+    return store.value();
+}
+
+/**
+ * @brief runs the checks on a fresh "seqlog" partition
+ *
+ * @return int exit code, 1 if a check failed
+ */
+int store_check()
+{
+    CheckCount check;
+    const auto partition = seqlog();
+    if (!check(partition && partition->size % sector_size == 0, "partition"))
+        return check.report("store");
+    const auto sectors = partition->size / sector_size;
+    esp_partition_erase_range(partition, 0, partition->size);
+
+    // first boot: no record, the migrated value is the first one
+    {
+        CounterStore store(batch, eeprom_address);
+        check(!store.init(), "fresh_no_record");
+        auto erases = flash_erases();
+        store.set(42);
+        check(store.value() == 42 && store.commits() == 1, "fresh_set");
+        check(store.erases() == 1 && flash_erases() - erases == 1, "fresh_set_erases_first_sector");
+    }
+    bool restored = false;
+    auto value = reboot(&restored);
+    check(restored && value == 42 + batch, "reboot_skips_a_batch");
+
+    // batched commits, a sector is erased when the log enters it
+    {
+        CounterStore store(batch, eeprom_address);
+        store.init();
+        const auto erases = flash_erases();
+        const auto commits = store.commits();
+        const auto increments = 3 * partition->size / 8 * batch; // the ring three times around
+        for (size_t n = 0; n < increments; ++n)
+            store.increment();
+        const auto records = store.commits() - commits;
+        check(records == increments / batch, "increment_commits_per_batch");
+        check(flash_erases() - erases == store.erases(), "increment_erases_counted");
+        check(store.erases() + 1 >= records / slots_per_sector && store.erases() <= records / slots_per_sector + 1,
+              "increment_one_erase_per_sector");
+        value = store.value();
+    }
+    const auto resumed = reboot();
+    check(resumed > value && resumed <= value + batch, "reboot_never_repeats");
+
+    // a torn record, only the value reached the flash, is skipped
+    {
+        CounterStore store(batch, eeprom_address);
+        store.init();
+        value = store.value();
+        for (size_t offset = 0; offset < partition->size; offset += 8)
+        {
+            uint32_t record[2];
+            esp_partition_read(partition, offset, record, sizeof(record));
+            if (record[0] == 0xFFFFFFFF && record[1] == 0xFFFFFFFF)
+            {
+                record[0] = value + 1000;
+                esp_partition_write(partition, offset, record, sizeof(record));
+                break;
+            }
+        }
+    }
+    check(reboot() == value + batch, "torn_record_skipped");
+
+    // a lower value starts a new log, before the fix the reboot restored the higher records
+    {
+        CounterStore store(batch, eeprom_address);
+        store.init();
+        const auto erases = flash_erases();
+        store.set(5);
+        check(store.value() == 5 && flash_erases() - erases == sectors, "set_lower_erases_log");
+        for (int n = 0; n < 3; ++n)
+            store.increment();
+    }
+    check(reboot() == 5 + batch, "set_lower_survives_reboot");
+    {
+        CounterStore store(batch, eeprom_address);
+        store.init();
+        const auto erases = flash_erases();
+        store.set(0);
+        check(flash_erases() - erases == sectors, "set_zero_erases_log");
+    }
+    check(reboot() == batch, "set_zero_survives_reboot");
+
+    // a higher value is appended
+    {
+        CounterStore store(batch, eeprom_address);
+        store.init();
+        const auto erases = flash_erases();
+        store.set(1000000);
+        check(flash_erases() - erases <= 1, "set_higher_appends");
+    }
+    check(reboot() == 1000000 + batch, "set_higher_survives_reboot");
+
+    // a partition table without "seqlog": the counter keeps its low byte in the eeprom cell of older firmware
+    sim_partition_missing("seqlog", true);
+    uint32_t used = 0;
+    {
+        CounterStore store(batch, eeprom_address);
+        check(store.init() && store.eeprom(), "eeprom_fallback");
+        for (int n = 0; n < 20; ++n)
+            store.increment();
+        used = store.value();
+        check(store.commits() == 3 && EEPROM.read(eeprom_address) == static_cast<uint8_t>(used - used % batch),
+              "eeprom_batched_commits");
+    }
+    {
+        bool restored = false;
+        const auto value = reboot(&restored);
+        check(restored && static_cast<uint8_t>(value - used) > 0 && static_cast<uint8_t>(value - used) <= batch,
+              "eeprom_survives_reboot");
+    }
+    sim_partition_missing("seqlog", false);
+
+    printf("store_flash_erases=%u\n", flash_erases());
+    return check.report("store");
+}
@@ -0,0 +1,8 @@
+#pragma once
+
+// CounterStore on the simulated "seqlog" flash: restore after a reboot, batched commits, the erases of the sector
+// ring, torn records and set() to a lower value, which must survive a reboot although the log keeps higher records.
+// without the partition the counter falls back to the eeprom cell of older firmware.
+
+
+int store_check();
@@ -0,0 +1,140 @@
+#include <check.h>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <telemetry.h>
+#include <telemetrycheck.h>
+#include <vector>
+
+/**
+ * @brief the comma separated fields after the "XXXX." prefix
+ */
+static std::vector<std::string> fields(const char *text)
+{
+    std::vector<std::string> result;
+    std::string rest(text + 5);
+    for (size_t comma; (comma = rest.find(',')) != std::string::npos; rest.erase(0, comma + 1))
+        result.push_back(rest.substr(0, comma));
+    result.push_back(rest);
+    return result;
+}
+
+/**
+ * @brief encode() by known values: scaling, rounding and clamping to 0..255
+ */
+static void encode_checks(CheckCount &check)
+{
+    const struct
+    {
+        const char *name;
+        TelemetryAnalogId id;
+        float value;
+        int raw;
+    } cases[] = {
+        {"vbatt_scaled", tlm_vbatt, 3.70f, 120}, // (3.7 - 2.5) / 0.01
+        {"vbatt_rounded", tlm_vbatt, 4.1071f, 161},
+        {"vbatt_offset", tlm_vbatt, 2.5f, 0},
+        {"vbatt_clamped_low", tlm_vbatt, 1.8f, 0},
+        {"vbatt_top", tlm_vbatt, 5.05f, 255},
+        {"vbatt_clamped_high", tlm_vbatt, 6.0f, 255},
+        {"capacity", tlm_capacity, 85, 85},
+        {"capacity_clamped_high", tlm_capacity, 300, 255},
+        {"capacity_clamped_low", tlm_capacity, -3, 0},
+        {"temperature_offset", tlm_temperature, 21.6f, 122}, // 21.6 + 100, rounded
+        {"temperature_rounded", tlm_temperature, -7.6f, 92},
+        {"temperature_clamped_low", tlm_temperature, -120, 0},
+        {"temperature_clamped_high", tlm_temperature, 180, 255},
+        {"humidity", tlm_humidity, 45, 45},
+    };
+    for (const auto &entry : cases)
+    {
+        const auto raw = TelemetryTable::encode(entry.id, entry.value);
+        if (!check(raw == entry.raw, entry.name))
+            printf("encode_%s=%d expected %d\n", entry.name, raw, entry.raw);
+    }
+
+    // what a receiver computes with the generated EQNS gives back the value within half a step
+    const auto eqns = fields(telemetry_eqns.text);
+    bool inverse = eqns.size() == 3 * tlm_analog_count;
+    for (size_t id = 0; inverse && id < tlm_analog_count; ++id)
+    {
+        const auto a = strtod(eqns[3 * id].c_str(), nullptr);
+        const auto b = strtod(eqns[3 * id + 1].c_str(), nullptr);
+        const auto c = strtod(eqns[3 * id + 2].c_str(), nullptr);
+        for (int raw = TelemetryTable::raw_min; raw <= TelemetryTable::raw_max; ++raw)
+        {
+            for (const auto offset : {-0.4, 0.4})
+            {
+                const auto value = static_cast<float>(c + b * (raw + offset));
+                const auto encoded = TelemetryTable::encode(static_cast<TelemetryAnalogId>(id), value);
+                const auto decoded = a * encoded * encoded + b * encoded + c;
+                inverse = inverse && encoded == raw && fabs(decoded - value) <= fabs(b) / 2;
+            }
+        }
+    }
+    check(inverse, "encode_inverts_eqns");
+}
+
+/**
+ * @brief the generated metadata texts
+ */
+static void text_checks(CheckCount &check)
+{
+    check(!strcmp(telemetry_parm.text,
+                  "PARM.Vbatt,Capacity,Temperature,Humidity,,USBPower,240V,PCconn,Uplink,Echolink"),
+          "parm_text");
+    check(!strcmp(telemetry_unit.text, "UNIT.Vdc,%,Celsius,%,,UP,UP,UP,UP,UP"), "unit_text");
+    check(!strcmp(telemetry_eqns.text, "EQNS.0,0.01,2.5,0,1,0,0,1,-100,0,1,0"), "eqns_text");
+    check(!strcmp(telemetry_bits.text, "BITS.11111111,HB9GL-R telemetry by HB9HDG"), "bits_text");
+
+    // lengths known at compile time, a field per channel
+    const struct
+    {
+        const char *name;
+        const char *text;
+        size_t length;
+        size_t fields;
+    } texts[] = {
+        {"parm", telemetry_parm.text, telemetry_parm.length,
+         TelemetryTable::aprs_analog_channels + tlm_digital_count},
+        {"unit", telemetry_unit.text, telemetry_unit.length,
+         TelemetryTable::aprs_analog_channels + tlm_digital_count},
+        {"eqns", telemetry_eqns.text, telemetry_eqns.length, 3 * tlm_analog_count},
+        {"bits", telemetry_bits.text, telemetry_bits.length, 2},
+    };
+    for (const auto &text : texts)
+    {
+        const std::string name(text.name);
+        check(strlen(text.text) == text.length, (name + "_length").c_str());
+        check(fields(text.text).size() == text.fields, (name + "_fields").c_str());
+    }
+
+    // labels and equations in channel order
+    const auto parm = fields(telemetry_parm.text);
+    const auto eqns = fields(telemetry_eqns.text);
+    bool order = true;
+    for (size_t id = 0; id < tlm_analog_count; ++id)
+    {
+        const auto &channel = TelemetryTable::analog[id];
+        order = order && parm[id] == channel.name && strtod(eqns[3 * id].c_str(), nullptr) == channel.a.value() &&
+                strtod(eqns[3 * id + 1].c_str(), nullptr) == channel.b.value() &&
+                strtod(eqns[3 * id + 2].c_str(), nullptr) == channel.c.value();
+    }
+    for (size_t id = 0; id < tlm_digital_count; ++id)
+        order = order && parm[TelemetryTable::aprs_analog_channels + id] == TelemetryTable::digital[id].name;
+    check(order, "channel_order");
+}
+
+/**
+ * @brief runs the checks
+ *
+ * @return int exit code, 1 if a check failed
+ */
+int telemetry_check()
+{
+    CheckCount check;
+    encode_checks(check);
+    text_checks(check);
+    return check.report("telemetry");
+}
@@ -0,0 +1,7 @@
+#pragma once
+
+// the telemetry channel table on the host: TelemetryTable::encode() scaling and clamping by known values and by the
+// round trip through the generated EQNS coefficients, and the generated PARM/UNIT/EQNS/BITS texts
+
+
+int telemetry_check();
@@ -0,0 +1,177 @@
+#include <atomic>
+#include <check.h>
+#include <cstdio>
+#include <cstring>
+#include <seqlock.h>
+#include <snapshot.h>
+#include <string>
+#include <spscqueue.h>
+#include <thread>
+#include <threadcheck.h>
+#include <vector>
+
+/**
+ * @brief queue item larger than a word, every field follows from the sequence so a torn copy shows
+ */
+struct ThreadItem
+{
+    uint32_t sequence;
+    uint32_t square;
+    uint64_t inverted;
+    uint8_t bytes[12];
+};
+
+static ThreadItem make_item(uint32_t sequence)
+{
+    ThreadItem item;
+    item.sequence = sequence;
+    item.square = sequence * sequence;
+    item.inverted = ~static_cast<uint64_t>(sequence);
+    for (size_t i = 0; i < sizeof(item.bytes); ++i)
+        item.bytes[i] = static_cast<uint8_t>(sequence + i);
+    return item;
+}
+
+static bool intact(const ThreadItem &item)
+{
+    const auto expected = make_item(item.sequence);
+    return item.square == expected.square && item.inverted == expected.inverted &&
+           !memcmp(item.bytes, expected.bytes, sizeof(item.bytes));
+}
+
+/**
+ * @brief one producer and one consumer thread over a small queue
+ *
+ * @param wait true: the producer retries until there is room, false: it drops like requestRadio()
+ */
+static void spsc_checks(CheckCount &check, unsigned items, bool wait, const char *name)
+{
+    SpscQueue<ThreadItem, 8> queue;
+    std::atomic<bool> produced{false};
+    uint32_t accepted = 0;
+    uint32_t received = 0;
+    uint32_t torn = 0;
+    uint32_t disorder = 0;
+
+    std::thread consumer([&]() {
+        uint32_t next = 0; // lowest sequence still possible
+        ThreadItem item;
+        for (;;)
+        {
+            if (!queue.pop(item))
+            {
+                if (produced.load(std::memory_order_acquire) && queue.empty())
+                    break;
+                std::this_thread::yield();
+                continue;
+            }
+            torn += !intact(item);
+            disorder += wait ? item.sequence != next : item.sequence < next;
+            next = item.sequence + 1;
+            ++received;
+        }
+    });
+    for (uint32_t sequence = 0; sequence < items; ++sequence)
+    {
+        const auto item = make_item(sequence);
+        bool pushed;
+        while (!(pushed = queue.push(item)) && wait)
+            std::this_thread::yield();
+        accepted += pushed;
+        if (!wait && sequence % 16 == 0)
+            std::this_thread::yield(); // let the consumer keep up with some of the items
+    }
+    produced.store(true, std::memory_order_release);
+    consumer.join();
+
+    printf("threads_%s_items=%u\n", name, items);
+    printf("threads_%s_full=%u\n", name, queue.drops());
+    printf("threads_%s_received=%u\n", name, received);
+    check(received == accepted && queue.empty(), (std::string(name) + "_received").c_str());
+    check(wait ? accepted == items : accepted + queue.drops() == items, (std::string(name) + "_drops").c_str());
+    check(torn == 0, (std::string(name) + "_intact").c_str());
+    check(disorder == 0, (std::string(name) + "_order").c_str());
+}
+
+/**
+ * @brief snapshot number n, every field follows from n so a mix of two writes shows
+ */
+static TelemetrySnapshot make_snapshot(uint32_t n)
+{
+    TelemetrySnapshot snapshot;
+    snapshot.timestamp = n;
+    snapshot.climateTime = ~n;
+    snapshot.intvoltage = static_cast<uint16_t>(n * 3);
+    snapshot.temperature = static_cast<int16_t>(-static_cast<int32_t>(n & 0x3FFF));
+    snapshot.humidity = static_cast<uint8_t>(n * 7);
+    snapshot.battPercent = static_cast<uint8_t>(n >> 8);
+    snapshot.status = static_cast<uint8_t>(n >> 16);
+    snapshot.aprsPacketSeq = static_cast<uint8_t>(n * 5);
+    snapshot.climateValid = static_cast<uint8_t>(n & 1);
+    return snapshot;
+}
+
+/**
+ * @brief one writer and several reader threads on a Seqlock<TelemetrySnapshot>, like acquire() and the tasks
+ */
+static void seqlock_checks(CheckCount &check, unsigned writes, unsigned readers)
+{
+    Seqlock<TelemetrySnapshot> lock;
+    lock.write(make_snapshot(0));
+    std::atomic<bool> written{false};
+    std::vector<uint32_t> reads(readers), torn(readers), backwards(readers);
+
+    std::vector<std::thread> threads;
+    for (unsigned r = 0; r < readers; ++r)
+    {
+        threads.emplace_back([&, r]() {
+            uint32_t last = 0;
+            bool done;
+            do
+            {
+                done = written.load(std::memory_order_acquire);
+                const auto snapshot = lock.read();
+                const auto expected = make_snapshot(snapshot.timestamp);
+                torn[r] += memcmp(&snapshot, &expected, sizeof(snapshot)) != 0;
+                backwards[r] += snapshot.timestamp < last;
+                last = snapshot.timestamp;
+                if (++reads[r] % 64 == 0)
+                    std::this_thread::yield();
+            } while (!done || last != writes);
+        });
+    }
+    // the writer never yields, on a single core the readers only run when it was preempted, maybe within a write
+    for (uint32_t n = 1; n <= writes; ++n)
+        lock.write(make_snapshot(n));
+    written.store(true, std::memory_order_release);
+    for (auto &thread : threads)
+        thread.join();
+
+    uint32_t readCount = 0, tornCount = 0, backwardsCount = 0;
+    for (unsigned r = 0; r < readers; ++r)
+    {
+        readCount += reads[r];
+        tornCount += torn[r];
+        backwardsCount += backwards[r];
+    }
+    printf("threads_seqlock_writes=%u\n", writes);
+    printf("threads_seqlock_reads=%u\n", readCount);
+    check(lock.version() == writes + 1, "seqlock_version");
+    check(tornCount == 0, "seqlock_intact");
+    check(backwardsCount == 0, "seqlock_order");
+}
+
+/**
+ * @brief runs the checks
+ *
+ * @param items per run
+ * @return int exit code, 1 if a check failed
+ */
+int thread_check(unsigned items)
+{
+    CheckCount check;
+    spsc_checks(check, items, true, "spsc_wait");
+    spsc_checks(check, items, false, "spsc_drop");
+    seqlock_checks(check, items, 3);
+    return check.report("threads");
+}
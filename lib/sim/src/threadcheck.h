@@ -0,0 +1,9 @@
+#pragma once
+
+// the lock free structures between the DUALCORE tasks under real threads on the host: an SpscQueue producer and
+// consumer running flat out, with a producer that waits for room and with one that drops when the queue is full,
+// then a Seqlock writer against several readers. the consumer must see every accepted item once, in order and
+// never half written, a reader never a mix of two writes or an older one after a newer.
+
+
+int thread_check(unsigned items);
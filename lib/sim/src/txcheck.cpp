@@ -0,0 +1,134 @@
+#include <check.h>
+#include <cstring>
+#include <mylora.h>
+#include <sim.h>
+#include <string>
+#include <txcheck.h>
+#include <vector>
+
+/**
+ * @brief queues a frame whose text is its name
+ */
+static bool push(TxQueue &queue, const char *text, TxPriority priority)
+{
+    return queue.push(reinterpret_cast<const uint8_t *>(text), strlen(text), priority);
+}
+
+static bool is(const TxFrame *frame, const char *text)
+{
+    return frame && frame->length == strlen(text) && !memcmp(frame->data, text, frame->length);
+}
+
+/**
+ * @brief order, drops and in flight handling of the queue alone
+ */
+static void queue_checks(CheckCount &check)
+{
+    TxQueue queue;
+    check(queue.empty() && !queue.peek() && !queue.begin_tx(), "queue_empty");
+
+    push(queue, "data1", tx_priority_data);
+    push(queue, "meta1", tx_priority_metadata);
+    push(queue, "status1", tx_priority_status);
+    push(queue, "data2", tx_priority_data);
+    push(queue, "status2", tx_priority_status);
+    check(queue.depth() == 5 && queue.drops() == 0, "queue_depth");
+    check(is(queue.peek(), "status1"), "queue_peek_most_urgent");
+
+    // one frame in flight at a time, it stays queued until tx done
+    check(is(queue.begin_tx(), "status1") && is(queue.inFlight(), "status1"), "queue_begin_tx");
+    check(!queue.begin_tx() && !queue.peek(), "queue_one_in_flight");
+    check(queue.depth() == 5, "queue_depth_in_flight");
+    queue.complete_tx();
+    check(!queue.inFlight() && queue.depth() == 4 && queue.sent() == 1, "queue_complete_tx");
+
+    // by priority, fifo within a priority
+    std::vector<std::string> order;
+    while (const auto frame = queue.begin_tx())
+    {
+        order.emplace_back(reinterpret_cast<const char *>(frame->data), frame->length);
+        queue.complete_tx();
+    }
+    check(order == std::vector<std::string>{"status2", "data1", "data2", "meta1"}, "queue_order");
+    check(queue.empty() && queue.sent() == 5, "queue_drained");
+
+    // a full queue drops its least urgent waiting frame for a more urgent one, never the frame in flight
+    for (size_t i = 0; i < TxQueue::capacity; ++i)
+        push(queue, i ? "meta" : "inflight", tx_priority_metadata);
+    queue.begin_tx();
+    check(!push(queue, "meta_late", tx_priority_metadata) && queue.drops() == 1, "queue_full_same_priority");
+    check(push(queue, "status", tx_priority_status) && queue.drops() == 2, "queue_full_displaces");
+    check(queue.depth() == TxQueue::capacity && is(queue.inFlight(), "inflight"), "queue_full_in_flight_kept");
+    queue.complete_tx();
+    check(is(queue.peek(), "status"), "queue_displacing_frame_next");
+
+    uint8_t long_frame[TxFrame::max_length + 1] = {};
+    check(!queue.push(long_frame, sizeof(long_frame)) && queue.drops() == 3, "queue_too_long");
+}
+
+/**
+ * @brief MyLora::service() against the LoRa shim
+ */
+static void radio_checks(CheckCount &check)
+{
+    auto &sim = Simulator::instance();
+    std::vector<std::string> onAir;
+    sim.onRadioOutput = [&onAir](const uint8_t *data, size_t length) {
+        onAir.emplace_back(reinterpret_cast<const char *>(data) + 3, length - 3); // without the lora-aprs header
+    };
+
+    static MyLora radio;
+    radio.init();
+    const auto text = [](const char *text) { return reinterpret_cast<const uint8_t *>(text); };
+    radio.tx(text("HB9HDG-13>APRS::meta"), 20, tx_priority_metadata);
+    radio.tx(text("HB9HDG-13>APRS:T#001"), 20, tx_priority_data);
+    radio.tx(text("HB9HDG-13>APRS:>status"), 22, tx_priority_status);
+    check(radio.queue().depth() == 3 && radio.busy(), "radio_queued");
+
+    // the most urgent frame goes on air, service() returns without waiting for it
+    auto start = sim.now();
+    radio.service();
+    check(sim.now() == start, "radio_service_no_wait");
+    check(onAir.size() == 1 && onAir.back() == "HB9HDG-13>APRS:>status", "radio_first_status");
+    check(is(radio.queue().inFlight(), "HB9HDG-13>APRS:>status"), "radio_in_flight");
+
+    // nothing more while the frame is on air
+    sim.advance(radio.airtime(25) / 2);
+    radio.service();
+    check(onAir.size() == 1 && radio.queue().depth() == 3, "radio_on_air");
+
+    // tx done raises DIO0, the next service() completes the frame and starts the next one
+    sim.advance(radio.airtime(25));
+    start = sim.now();
+    radio.service();
+    check(sim.now() == start, "radio_tx_done_no_wait");
+    check(radio.queue().sent() == 1 && radio.queue().depth() == 2, "radio_tx_done");
+    check(onAir.size() == 2 && onAir.back() == "HB9HDG-13>APRS:T#001", "radio_second_data");
+
+    for (int i = 0; i < 4; ++i)
+    {
+        sim.advance(radio.airtime(25) + 1000);
+        radio.service();
+    }
+    check(onAir.size() == 3 && onAir.back() == "HB9HDG-13>APRS::meta", "radio_third_metadata");
+    check(radio.queue().empty() && radio.queue().sent() == 3 && !radio.queue().inFlight(), "radio_drained");
+
+    // the stats read by the loop are the ones published by the last service()
+    const AirtimeStats stats = radio.airtimeStats();
+    check(stats.framesSent == 3 && stats.queueDepth == 0 && stats.total_ms >= 3 * radio.airtime(20) / 1000,
+          "radio_stats_published");
+    sim.onRadioOutput = nullptr;
+}
+
+/**
+ * @brief runs the checks
+ *
+ * @return int exit code, 1 if a check failed
+ */
+int tx_check()
+{
+    CheckCount check;
+    queue_checks(check);
+    radio_checks(check);
+    return check.report("tx");
+}
@@ -0,0 +1,8 @@
+#pragma once
+
+// the asynchronous LoRa tx path on the host: TxQueue ordering, drops and the in flight frame, then MyLora::service()
+// against the LoRa shim, which raises DIO0 when a frame is on air. service() must return at once while a frame is
+// on air and start the next frame after tx done.
+
+
+int tx_check();
@@ -0,0 +1,127 @@
+#include <airtime.h>
+
+
+AirtimeModel::AirtimeModel(const Settings::LoRa_settings &lora) :
+    m_sf(lora.SpreadingFactor),
+    m_bw(lora.SignalBandwidth),
+    m_cr(lora.CodingRate4 - 4),
+    m_preamble(lora.PreambleLength),
+    m_crc(true),
+    m_implicit(false),
+    // same rule and integer math as LoRaClass::setLdoFlag()
+    m_lowDataRate(1000L / (lora.SignalBandwidth / (1L << lora.SpreadingFactor)) > 16)
+{
+}
+
+/**
+ * @brief duration of one symbol 2^SF / BW
+ *
+ * @return uint32_t [us]
+ */
+uint32_t AirtimeModel::symbol_us() const
+{
+    return static_cast<uint32_t>((1000000ULL << m_sf) / m_bw);
+}
+
+/**
+ * @brief time on air of a frame
+ * @note preamble: (n + 4.25) symbols
+ * @note payload: 8 + max(ceil((8PL - 4SF + 28 + 16CRC - 20IH) / (4(SF - 2DE))) * (CR + 4), 0) symbols
+ *
+ * @param payloadLength lora payload length in bytes (including the lora-aprs header)
+ * @return uint32_t [us]
+ */
+uint32_t AirtimeModel::frame_us(size_t payloadLength) const
+{
+    const int32_t numerator = 8 * static_cast<int32_t>(payloadLength) - 4 * m_sf + 28 + (m_crc ? 16 : 0) -
+                              (m_implicit ? 20 : 0);
+    const int32_t denominator = 4 * (m_sf - (m_lowDataRate ? 2 : 0));
+    int32_t blocks = 0;
+    if (numerator > 0)
+        blocks = (numerator + denominator - 1) / denominator;
+    const uint32_t payloadSymbols = 8 + blocks * (m_cr + 4);
+
+    // count in quarter symbols to keep the 4.25 preamble tail exact
+    const uint64_t quarterSymbols = 4ULL * m_preamble + 17 + 4ULL * payloadSymbols;
+    return static_cast<uint32_t>((quarterSymbols * (1000000ULL << m_sf)) / (4ULL * m_bw));
+}
+
+/**
+ * @brief time on air of a frame, rounded up
+ *
+ * @param payloadLength lora payload length in bytes
+ * @return uint32_t [ms]
+ */
+uint32_t AirtimeModel::frame_ms(size_t payloadLength) const
+{
+    return (frame_us(payloadLength) + 999) / 1000;
+}
+
+
+AirtimeBudget::AirtimeBudget(const Settings::LoRa_settings &lora) :
+    m_bucketLength(lora.DutyCycleWindow * 1000UL / buckets),
+    m_budget(lora.DutyCycleWindow * 10UL * lora.DutyCyclePercent)
+{
+}
+
+/**
+ * @brief moves the current bucket forward, buckets that left the window are cleared
+ */
+void AirtimeBudget::rotate(unsigned long now)
+{
+    auto steps = (now - m_currentStart) / m_bucketLength;
+    if (steps == 0)
+        return;
+    if (steps > buckets)
+        steps = buckets;
+    for (size_t i = 0; i < steps; ++i)
+    {
+        m_current = (m_current + 1) % buckets;
+        m_buckets[m_current] = 0;
+    }
+    m_currentStart = now - (now - m_currentStart) % m_bucketLength;
+}
+
+/**
+ * @brief books airtime
+ *
+ * @param now [ms]
+ * @param airtime_ms airtime of the frame
+ */
+void AirtimeBudget::charge(unsigned long now, uint32_t airtime_ms)
+{
+    rotate(now);
+    m_buckets[m_current] += airtime_ms;
+}
+
+/**
+ * @brief true if a frame with the given airtime fits into the rolling window
+ */
+bool AirtimeBudget::allows(unsigned long now, uint32_t airtime_ms)
+{
+    return used(now) + airtime_ms <= m_budget;
+}
+
+/**
+ * @brief airtime spent within the rolling window
+ *
+ * @return uint32_t [ms]
+ */
+uint32_t AirtimeBudget::used(unsigned long now)
+{
+    rotate(now);
+    uint32_t sum = 0;
+    for (auto bucket : m_buckets)
+        sum += bucket;
+    return sum;
+}
+
+/**
+ * @brief airtime allowed per window
+ *
+ * @return uint32_t [ms]
+ */
+uint32_t AirtimeBudget::budget() const
+{
+    return m_budget;
+}
@@ -0,0 +1,311 @@
+#include <aprs.h>
+#include <cmath>
+#include <cstring>
+
+
+void AprsFrame::clear()
+{
+    m_length = 0;
+    m_overflow = false;
+}
+
+/**
+ * @brief writes the tnc2 header "SOURCE>DEST:"
+ *
+ * @param source source callsign
+ * @param destination destination callsign
+ * @return AprsFrame&
+ */
+AprsFrame &AprsFrame::header(const char *source, const char *destination)
+{
+    return append(source).append('>').append(destination).append(':');
+}
+
+/**
+ * @brief writes the message prefix ":ADDRESSEE:" with the addressee padded to 9 characters
+ *
+ * @param addressee addressee callsign
+ * @return AprsFrame&
+ */
+AprsFrame &AprsFrame::message(const char *addressee)
+{
+    return append(':').appendPadded(addressee, addressee_length).append(':');
+}
+
+/**
+ * @brief writes a telemetry report "T#sss,aaa,aaa,aaa,aaa,aaa,bbbbb"
+ *
+ * @param sequence packet sequence number
+ * @param analog analog values (clamped to 0..999), missing channels are left empty
+ * @param analogCount number of analog values
+ * @param bits digital channels, bit 0 is the first channel
+ * @param bitCount number of digital channels
+ * @return AprsFrame&
+ */
+AprsFrame &AprsFrame::telemetry(uint16_t sequence, const int *analog, size_t analogCount, uint8_t bits, size_t bitCount)
+{
+    append("T#").appendNumber(sequence % 1000, 3);
+    for (size_t i = 0; i < analog_channels; ++i)
+    {
+        append(',');
+        if (i < analogCount)
+        {
+            auto value = analog[i];
+            if (value < 0)
+                value = 0;
+            if (value > 999)
+                value = 999;
+            appendNumber(static_cast<uint32_t>(value), 3);
+        }
+    }
+    append(',');
+    for (size_t i = 0; i < bitCount; ++i)
+        append((bits & (1U << i)) ? '1' : '0');
+    return *this;
+}
+
+/**
+ * @brief writes base-91 comment telemetry "|ss1122334455bb|", two characters per value
+ * @note the bits follow the fifth analog value, so missing analog channels are sent as 0 when there are bits
+ *
+ * @param sequence packet sequence number
+ * @param analog analog values (clamped to 0..8280)
+ * @param analogCount number of analog values, at most 5
+ * @param bits digital channels, bit 0 is the first channel
+ * @param bitCount number of digital channels, at most 8, 0 leaves out the bits
+ * @return AprsFrame&
+ */
+AprsFrame &AprsFrame::compressedTelemetry(uint16_t sequence, const int *analog, size_t analogCount, uint8_t bits,
+                                          size_t bitCount)
+{
+    append('|').appendBase91(sequence % (base91_max + 1), 2);
+    // a report carries at least one value
+    auto channels = bitCount ? analog_channels : analogCount;
+    if (!channels)
+        channels = 1;
+    if (channels > analog_channels)
+        channels = analog_channels;
+    for (size_t i = 0; i < channels; ++i)
+    {
+        auto value = i < analogCount ? analog[i] : 0;
+        if (value < 0)
+            value = 0;
+        if (static_cast<uint32_t>(value) > base91_max)
+            value = base91_max;
+        appendBase91(static_cast<uint32_t>(value), 2);
+    }
+    if (bitCount)
+        appendBase91(bits & ((1U << bitCount) - 1), 2);
+    return append('|');
+}
+
+/**
+ * @brief writes an uncompressed position "DDMM.hhN/DDDMM.hhEr", to a hundredth of a minute
+ *
+ * @param latitude [°] south negative
+ * @param longitude [°] west negative
+ * @param table symbol table, '/' primary or '\\' alternate
+ * @param symbol symbol code
+ * @return AprsFrame&
+ */
+AprsFrame &AprsFrame::position(double latitude, double longitude, char table, char symbol)
+{
+    const auto lat = static_cast<uint32_t>(lround(fabs(latitude) * 6000));
+    const auto lon = static_cast<uint32_t>(lround(fabs(longitude) * 6000));
+    appendNumber(lat / 6000, 2).appendNumber(lat % 6000 / 100, 2).append('.').appendNumber(lat % 100, 2);
+    append(latitude < 0 ? 'S' : 'N').append(table);
+    appendNumber(lon / 6000, 3).appendNumber(lon % 6000 / 100, 2).append('.').appendNumber(lon % 100, 2);
+    return append(longitude < 0 ? 'W' : 'E').append(symbol);
+}
+
+/**
+ * @brief writes a compressed position "/YYYYXXXXrcsT" with the altitude in the cs bytes
+ * @note resolution is about 0.3 m in latitude and 0.6 m in longitude at the equator, altitude is within 0.1 %
+ *
+ * @param latitude [°] south negative
+ * @param longitude [°] west negative
+ * @param altitude [m] above sea level
+ * @param table symbol table, '/' primary or '\\' alternate
+ * @param symbol symbol code
+ * @return AprsFrame&
+ */
+AprsFrame &AprsFrame::compressedPosition(double latitude, double longitude, double altitude, char table,
+                                         char symbol)
+{
+    constexpr double base91_4 = 91.0 * 91 * 91 * 91 - 1;
+    // T byte: current fix, GGA source (required for the altitude in cs), generated by software
+    constexpr char compression_type = 0x32 + '!';
+    const auto y = fmin(fmax(380926.0 * (90.0 - latitude), 0), base91_4);
+    const auto x = fmin(fmax(190463.0 * (180.0 + longitude), 0), base91_4);
+    const auto feet = altitude / 0.3048;
+    const auto cs = feet < 1 ? 0 : fmin(lround(log(feet) / log(1.002)), base91_max);
+    append(table).appendBase91(static_cast<uint32_t>(y), 4).appendBase91(static_cast<uint32_t>(x), 4);
+    return append(symbol).appendBase91(static_cast<uint32_t>(cs), 2).append(compression_type);
+}
+
+/**
+ * @brief writes the comment altitude "/A=aaaaaa" in feet
+ *
+ * @param altitude [m] above sea level, clamped to 0..999999 ft
+ * @return AprsFrame&
+ */
+AprsFrame &AprsFrame::altitude(double altitude)
+{
+    const auto feet = fmin(fmax(lround(altitude / 0.3048), 0), 999999);
+    return append("/A=").appendNumber(static_cast<uint32_t>(feet), 6);
+}
+
+AprsFrame &AprsFrame::append(char c)
+{
+    if (m_length < capacity)
+        m_buffer[m_length++] = static_cast<uint8_t>(c);
+    else
+        m_overflow = true;
+    return *this;
+}
+
+AprsFrame &AprsFrame::append(const char *str)
+{
+    return append(str, strlen(str));
+}
+
+/**
+ * @brief appends at most length characters
+ *
+ * @param str input string
+ * @param length number of characters
+ * @return AprsFrame&
+ */
+AprsFrame &AprsFrame::append(const char *str, size_t length)
+{
+    auto len = strnlen(str, length);
+    if (len > capacity - m_length)
+    {
+        len = capacity - m_length;
+        m_overflow = true;
+    }
+    memcpy(m_buffer + m_length, str, len);
+    m_length += len;
+    return *this;
+}
+
+/**
+ * @brief appends a string and adds trailing characters up to the given width
+ *
+ * @param str input string
+ * @param width final width
+ * @param paddedChar padded character (default: space)
+ * @return AprsFrame&
+ */
+AprsFrame &AprsFrame::appendPadded(const char *str, size_t width, char paddedChar)
+{
+    const auto len = strlen(str);
+    append(str, len);
+    for (auto i = len; i < width; ++i)
+        append(paddedChar);
+    return *this;
+}
+
+/**
+ * @brief appends a decimal number with leading characters up to the given width
+ *
+ * @param value number
+ * @param width minimal width
+ * @param paddedChar padded character (default: '0')
+ * @return AprsFrame&
+ */
+AprsFrame &AprsFrame::appendNumber(uint32_t value, size_t width, char paddedChar)
+{
+    char digits[10];
+    size_t count = 0;
+    do
+    {
+        digits[count++] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value);
+    for (auto i = count; i < width; ++i)
+        append(paddedChar);
+    while (count)
+        append(digits[--count]);
+    return *this;
+}
+
+/**
+ * @brief appends a number as base-91 digits ('!' is 0), most significant first
+ *
+ * @param value number, must fit into width digits
+ * @param width number of digits
+ * @return AprsFrame&
+ */
+AprsFrame &AprsFrame::appendBase91(uint32_t value, size_t width)
+{
+    char digits[5];
+    if (width > sizeof(digits))
+        width = sizeof(digits);
+    for (auto i = width; i--;)
+    {
+        digits[i] = static_cast<char>('!' + value % 91);
+        value /= 91;
+    }
+    return append(digits, width);
+}
+
+const uint8_t *AprsFrame::data() const
+{
+    return m_buffer;
+}
+
+size_t AprsFrame::length() const
+{
+    return m_length;
+}
+
+bool AprsFrame::overflow() const
+{
+    return m_overflow;
+}
+
+
+/**
+ * @brief encodes the position part of the beacon, the altitude goes into the comment when uncompressed
+ *
+ * @param latitude [°] south negative
+ * @param longitude [°] west negative
+ * @param altitude [m] above sea level
+ * @param table symbol table
+ * @param symbol symbol code
+ * @param compressed base-91 compressed position
+ */
+void AprsPosition::encode(double latitude, double longitude, double altitude, char table, char symbol,
+                          bool compressed)
+{
+    AprsFrame frame;
+    if (compressed)
+        frame.compressedPosition(latitude, longitude, altitude, table, symbol);
+    else
+        frame.position(latitude, longitude, table, symbol);
+    memcpy(m_position, frame.data(), frame.length());
+    m_position[frame.length()] = '\0';
+
+    frame.clear();
+    if (!compressed)
+        frame.altitude(altitude);
+    memcpy(m_altitude, frame.data(), frame.length());
+    m_altitude[frame.length()] = '\0';
+}
+
+/**
+ * @brief position to follow the '!' data type
+ */
+const char *AprsPosition::position() const
+{
+    return m_position;
+}
+
+/**
+ * @brief altitude to follow the comment, empty for a compressed position
+ */
+const char *AprsPosition::altitude() const
+{
+    return m_altitude;
+}
@@ -0,0 +1,331 @@
+#include <aprsparser.h>
+#include <cmath>
+
+static constexpr double feet = 0.3048; // [m]
+
+
+/**
+ * @brief value of fixed width decimal digits, a space counts as 0 (position ambiguity)
+ *
+ * @return false if a character is neither digit nor space
+ */
+static bool digits(std::string_view text, uint32_t &value)
+{
+    value = 0;
+    for (const auto c : text)
+    {
+        if (c != ' ' && (c < '0' || c > '9'))
+            return false;
+        value = value * 10 + (c == ' ' ? 0 : c - '0');
+    }
+    return true;
+}
+
+/**
+ * @brief value of base-91 digits, '!' is 0
+ *
+ * @return false if a character is outside '!'..'{'
+ */
+static bool base91(std::string_view text, uint32_t &value)
+{
+    value = 0;
+    for (const auto c : text)
+    {
+        if (c < '!' || c > '{')
+            return false;
+        value = value * 91 + (c - '!');
+    }
+    return true;
+}
+
+/**
+ * @brief decimal number with optional sign and fraction, e.g. "-12.5"
+ *
+ * @return false if the text is empty or not a number
+ */
+static bool number(std::string_view text, float &value)
+{
+    if (text.empty())
+        return false;
+    size_t i = 0;
+    const bool negative = text[0] == '-';
+    if (negative || text[0] == '+')
+        ++i;
+    double result = 0;
+    double scale = 0;
+    bool any = false;
+    for (; i < text.size(); ++i)
+    {
+        const auto c = text[i];
+        if (c == '.' && !scale)
+        {
+            scale = 1;
+            continue;
+        }
+        if (c < '0' || c > '9')
+            return false;
+        any = true;
+        result = result * 10 + (c - '0');
+        scale *= 10;
+    }
+    if (!any)
+        return false;
+    if (scale > 1)
+        result /= scale;
+    value = static_cast<float>(negative ? -result : result);
+    return true;
+}
+
+/**
+ * @brief splits the frame and classifies the payload
+ *
+ * @param frame tnc2 frame, without the lora-aprs header
+ * @param packet views into frame and the decoded values
+ * @return false if the frame has no "SOURCE>DEST:" header, a payload that is not understood is aprs_unknown
+ */
+bool AprsParser::parse(std::string_view frame, AprsPacket &packet)
+{
+    if (!header(frame, packet))
+        return false;
+
+    const auto payload = packet.payload;
+    bool ok = false;
+    switch (payload.empty() ? '\0' : payload[0])
+    {
+    case '!':
+    case '=':
+        ok = position(payload.substr(1), packet);
+        break;
+    case '/':
+    case '@':
+        // 7 character timestamp first
+        ok = payload.size() > 8 && position(payload.substr(8), packet);
+        break;
+    case ':':
+        ok = message(payload, packet);
+        break;
+    case 'T':
+        ok = telemetry(payload, packet);
+        break;
+    case '>':
+        packet.text = payload.substr(1);
+        ok = compressedTelemetry(packet.text, packet);
+        if (!ok)
+        {
+            packet.type = aprs_status;
+            ok = true;
+        }
+        break;
+    }
+    if (!ok)
+        packet.type = aprs_unknown;
+    return true;
+}
+
+/**
+ * @brief splits the frame into source, destination, path and payload, leaves the payload alone
+ *
+ * @param frame tnc2 frame
+ * @param packet header views, everything else cleared
+ * @return false without "SOURCE>DEST:"
+ */
+bool AprsParser::header(std::string_view frame, AprsPacket &packet)
+{
+    packet = AprsPacket{};
+    const auto colon = frame.find(':');
+    const auto gt = frame.substr(0, colon).find('>');
+    if (colon == std::string_view::npos || gt == std::string_view::npos || !gt)
+        return false;
+    auto addresses = frame.substr(gt + 1, colon - gt - 1);
+    packet.source = frame.substr(0, gt);
+    packet.destination = nextPathElement(addresses);
+    packet.path = addresses;
+    packet.payload = frame.substr(colon + 1);
+    return !packet.destination.empty();
+}
+
+/**
+ * @brief takes the first element off a comma separated path
+ *
+ * @param path remaining path, shortened by the element and its comma
+ * @return std::string_view element, empty at the end of the path
+ */
+std::string_view AprsParser::nextPathElement(std::string_view &path)
+{
+    const auto comma = path.find(',');
+    const auto element = path.substr(0, comma);
+    path = comma == std::string_view::npos ? std::string_view() : path.substr(comma + 1);
+    return element;
+}
+
+/**
+ * @brief position without data type and timestamp, "DDMM.hhN/DDDMM.hhEs" or "/YYYYXXXXscsT", then the comment
+ * @note the altitude comes from the cs bytes of a compressed position with a GGA source or "/A=" in the comment
+ */
+bool AprsParser::position(std::string_view data, AprsPacket &packet)
+{
+    packet.type = aprs_position;
+    if (data.size() >= 19 && (data[0] == ' ' || (data[0] >= '0' && data[0] <= '9')))
+    {
+        uint32_t latDegrees, latMinutes, latHundredths, lonDegrees, lonMinutes, lonHundredths;
+        if (!digits(data.substr(0, 2), latDegrees) || !digits(data.substr(2, 2), latMinutes) || data[4] != '.' ||
+            !digits(data.substr(5, 2), latHundredths) || !digits(data.substr(9, 3), lonDegrees) ||
+            !digits(data.substr(12, 2), lonMinutes) || data[14] != '.' || !digits(data.substr(15, 2), lonHundredths))
+            return false;
+        const auto ns = data[7];
+        const auto ew = data[17];
+        if ((ns != 'N' && ns != 'S') || (ew != 'E' && ew != 'W') || latDegrees > 90 || lonDegrees > 180)
+            return false;
+        packet.latitude = latDegrees + (latMinutes + latHundredths / 100.0) / 60;
+        packet.longitude = lonDegrees + (lonMinutes + lonHundredths / 100.0) / 60;
+        if (ns == 'S')
+            packet.latitude = -packet.latitude;
+        if (ew == 'W')
+            packet.longitude = -packet.longitude;
+        packet.symbolTable = data[8];
+        packet.symbolCode = data[18];
+        packet.text = data.substr(19);
+
+        const auto altitude = packet.text.find("/A=");
+        float value;
+        if (altitude != std::string_view::npos && number(packet.text.substr(altitude + 3, 6), value))
+        {
+            packet.altitude = value * feet;
+            packet.hasAltitude = true;
+        }
+        return true;
+    }
+
+    const auto table = data.size() >= 13 ? data[0] : '\0';
+    if (table != '/' && table != '\\' && !(table >= 'A' && table <= 'Z') && !(table >= 'a' && table <= 'j'))
+        return false;
+    uint32_t y, x;
+    if (!base91(data.substr(1, 4), y) || !base91(data.substr(5, 4), x))
+        return false;
+    packet.compressed = true;
+    packet.symbolTable = table;
+    packet.latitude = 90 - y / 380926.0;
+    packet.longitude = -180 + x / 190463.0;
+    packet.symbolCode = data[9];
+    packet.text = data.substr(13);
+
+    uint32_t cs;
+    const auto compressionType = data[12] - '!';
+    if (data[10] != ' ' && (compressionType & 0x18) == 0x10 && base91(data.substr(10, 2), cs))
+    {
+        packet.altitude = pow(1.002, cs) * feet;
+        packet.hasAltitude = true;
+    }
+    return true;
+}
+
+/**
+ * @brief ":ADDRESSEE:text{id", the telemetry metadata messages get their own types
+ */
+bool AprsParser::message(std::string_view data, AprsPacket &packet)
+{
+    if (data.size() < 11 || data[10] != ':')
+        return false;
+    auto addressee = data.substr(1, 9);
+    while (!addressee.empty() && addressee.back() == ' ')
+        addressee.remove_suffix(1);
+    packet.type = aprs_message;
+    packet.addressee = addressee;
+    packet.text = data.substr(11);
+    const auto id = packet.text.rfind('{');
+    if (id != std::string_view::npos)
+    {
+        packet.messageId = packet.text.substr(id + 1);
+        packet.text = packet.text.substr(0, id);
+    }
+
+    static constexpr struct
+    {
+        const char *prefix;
+        AprsPacketType type;
+    } metadata[] = {{"PARM.", aprs_telemetry_parm},
+                    {"UNIT.", aprs_telemetry_unit},
+                    {"EQNS.", aprs_telemetry_eqns},
+                    {"BITS.", aprs_telemetry_bits}};
+    for (const auto &entry : metadata)
+    {
+        if (packet.text.substr(0, 5) == entry.prefix)
+        {
+            packet.type = entry.type;
+            packet.text.remove_prefix(5);
+            break;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief "T#sss,a,a,a,a,a,bbbbbbbb", empty analog fields are left out of analogMask
+ */
+bool AprsParser::telemetry(std::string_view data, AprsPacket &packet)
+{
+    if (data.substr(0, 2) != "T#")
+        return false;
+    data.remove_prefix(2);
+    auto field = nextPathElement(data);
+    uint32_t sequence = 0;
+    // "MIC" instead of a number in old trackers
+    if (field != "MIC" && (field.empty() || !digits(field, sequence)))
+        return false;
+    packet.type = aprs_telemetry;
+    packet.sequence = static_cast<uint16_t>(sequence);
+    for (size_t i = 0; i < AprsPacket::analog_channels && !data.empty(); ++i)
+    {
+        field = nextPathElement(data);
+        if (field.empty())
+            continue;
+        if (!number(field, packet.analog[i]))
+            return false;
+        packet.analogMask |= 1U << i;
+    }
+    field = nextPathElement(data);
+    if (field.size() > 8)
+        return false;
+    for (size_t i = 0; i < field.size(); ++i)
+    {
+        if (field[i] != '0' && field[i] != '1')
+            return false;
+        packet.bits |= field[i] == '1' ? 1U << i : 0;
+    }
+    packet.bitCount = static_cast<uint8_t>(field.size());
+    return true;
+}
+
+/**
+ * @brief base-91 telemetry "|ss1122334455bb|" of a status report: sequence, 1 to 5 analog values, 8 bits
+ */
+bool AprsParser::compressedTelemetry(std::string_view data, AprsPacket &packet)
+{
+    if (data.size() < 6 || data[0] != '|')
+        return false;
+    const auto end = data.find('|', 1);
+    if (end == std::string_view::npos || (end - 1) % 2 || end - 1 < 4 || end - 1 > 14)
+        return false;
+    const auto values = (end - 1) / 2;
+    uint32_t decoded[1 + AprsPacket::analog_channels + 1];
+    for (size_t i = 0; i < values; ++i)
+    {
+        if (!base91(data.substr(1 + 2 * i, 2), decoded[i]))
+            return false;
+    }
+    packet.sequence = static_cast<uint16_t>(decoded[0]);
+    for (size_t i = 1; i < values && i <= AprsPacket::analog_channels; ++i)
+    {
+        packet.analog[i - 1] = static_cast<float>(decoded[i]);
+        packet.analogMask |= 1U << (i - 1);
+    }
+    if (values > 1 + AprsPacket::analog_channels)
+    {
+        packet.bits = static_cast<uint8_t>(decoded[values - 1]);
+        packet.bitCount = 8;
+    }
+    packet.type = aprs_telemetry;
+    packet.compressed = true;
+    packet.text = data.substr(end + 1);
+    return true;
+}
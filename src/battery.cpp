@@ -0,0 +1,130 @@
+#include <Arduino.h>
+#include <battery.h>
+#include <esp_adc_cal.h>
+
+#define SERIALDEBUG false // use usb/serial for debug instead communication with PC-Compagnion
+
+static constexpr uint32_t battery_default_vref = 1100; // [mV] used if the eFuse holds no calibration
+
+
+/**
+ * @brief builds the raw to millivolt table from the eFuse calibration and takes the first sample
+ */
+void BatteryMonitor::init()
+{
+    esp_adc_cal_characteristics_t characteristics;
+    const auto source = esp_adc_cal_characterize(ADC_UNIT_1, ADC_ATTEN_DB_11, ADC_WIDTH_BIT_12,
+                                                 battery_default_vref, &characteristics);
+    for (size_t i = 0; i < lut_size; ++i)
+    {
+        const uint32_t raw = i << lut_shift;
+        m_lut[i] = static_cast<uint16_t>(esp_adc_cal_raw_to_voltage(raw > 4095 ? 4095 : raw, &characteristics));
+    }
+#if SERIALDEBUG
+    Serial.print("adc calibration source: ");
+    Serial.println(static_cast<int>(source));
+#else
+    (void)source;
+#endif
+    sample();
+}
+
+/**
+ * @brief reads a burst and feeds its median into the filter
+ */
+void BatteryMonitor::sample()
+{
+    uint16_t reads[burst];
+    for (auto &read : reads)
+        read = analogRead(m_pin);
+    const auto value = static_cast<uint16_t>(to_millivolts(median(reads, burst)) * divider);
+
+    if (!m_primed)
+    {
+        m_filtered = static_cast<uint32_t>(value) << 16;
+        m_primed = true;
+    }
+    else
+    {
+        m_filtered = ema(m_filtered, value);
+    }
+    m_millivolts = static_cast<uint16_t>((m_filtered + 0x8000) >> 16);
+    m_percent = to_percent(m_millivolts);
+}
+
+/**
+ * @brief filtered battery voltage
+ *
+ * @return uint16_t [mV]
+ */
+uint16_t BatteryMonitor::millivolts() const
+{
+    return m_millivolts;
+}
+
+/**
+ * @brief charge estimate, linear between empty_mv and full_mv
+ *
+ * @return uint8_t [%]
+ */
+uint8_t BatteryMonitor::percent() const
+{
+    return m_percent;
+}
+
+/**
+ * @brief median by insertion sort, the burst is short
+ *
+ * @param values reads, sorted in place
+ * @param count number of reads
+ * @return uint16_t
+ */
+uint16_t BatteryMonitor::median(uint16_t *values, size_t count)
+{
+    for (size_t i = 1; i < count; ++i)
+    {
+        const auto value = values[i];
+        size_t j = i;
+        for (; j > 0 && values[j - 1] > value; --j)
+            values[j] = values[j - 1];
+        values[j] = value;
+    }
+    return values[count / 2];
+}
+
+/**
+ * @brief one ema step
+ *
+ * @param filtered previous output, Q16
+ * @param value new input
+ * @return uint32_t new output, Q16
+ */
+uint32_t BatteryMonitor::ema(uint32_t filtered, uint16_t value)
+{
+    const auto target = static_cast<int32_t>(static_cast<uint32_t>(value) << 16);
+    return filtered + ((target - static_cast<int32_t>(filtered)) >> ema_shift);
+}
+
+uint8_t BatteryMonitor::to_percent(uint16_t millivolts)
+{
+    if (millivolts <= empty_mv)
+        return 0;
+    if (millivolts >= full_mv)
+        return 100;
+    return static_cast<uint8_t>((millivolts - empty_mv) * 100U / (full_mv - empty_mv));
+}
+
+/**
+ * @brief pin voltage of a raw read, linear between the calibration points
+ *
+ * @param raw 12 bit read
+ * @return uint16_t [mV]
+ */
+uint16_t BatteryMonitor::to_millivolts(uint16_t raw) const
+{
+    const auto index = raw >> lut_shift;
+    const auto fraction = raw & ((1U << lut_shift) - 1);
+    const int32_t low = m_lut[index];
+    const int32_t high = m_lut[index + 1];
+    return static_cast<uint16_t>(low + (((high - low) * static_cast<int32_t>(fraction)) >> lut_shift));
+}
@@ -0,0 +1,140 @@
+#include <EEPROM.h>
+#include <counterstore.h>
+#include <probe.h>
+
+static constexpr size_t counter_sector_size = 4096; // flash erase unit
+static constexpr size_t counter_eeprom_size = 512;  // EEPROM.begin() of older firmware
+
+
+/**
+ * @brief finds the newest record of the "seqlog" partition, or falls back to the eeprom cell without it
+ *
+ * @return false if the partition holds no record yet
+ */
+bool CounterStore::init()
+{
+    m_partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, "seqlog");
+    if (!m_partition)
+    {
+        m_eeprom = true;
+        EEPROM.begin(counter_eeprom_size);
+        m_committed = EEPROM.read(m_eepromAddress);
+        m_hasRecord = true;
+        m_value = m_committed + m_batch;
+        commit();
+        return true;
+    }
+
+    const auto slots = m_partition->size / sizeof(Record);
+    bool found = false;
+    for (size_t slot = 0; slot < slots; ++slot)
+    {
+        Record record;
+        esp_partition_read(m_partition, slot * sizeof(Record), &record, sizeof(record));
+        // skips erased and torn records
+        if ((record.value ^ record.inverted) != 0xFFFFFFFF || record.inverted == 0)
+            continue;
+        if (!found || record.value >= m_committed)
+        {
+            m_committed = record.value;
+            m_nextSlot = (slot + 1) % slots;
+        }
+        found = true;
+    }
+    if (!found)
+        return false;
+    m_hasRecord = true;
+
+    // increments after the last commit may have been sent, skip them
+    m_value = m_committed + m_batch;
+    commit();
+    return true;
+}
+
+/**
+ * @brief sets the counter, e.g. when migrating an old value, and commits it
+ * @note init() restores the highest record, so a lower value erases the log first. the sector of slot 0 is erased
+ * last by commit(), a reset in between restores an older record or, without one, starts over like a first boot.
+ */
+void CounterStore::set(uint32_t value)
+{
+    if (m_partition && m_hasRecord && value < m_committed)
+    {
+        for (size_t offset = counter_sector_size; offset < m_partition->size; offset += counter_sector_size)
+        {
+            esp_partition_erase_range(m_partition, offset, counter_sector_size);
+            ++m_erases;
+        }
+        m_hasRecord = false;
+        m_nextSlot = 0;
+    }
+    m_value = value;
+    commit();
+}
+
+uint32_t CounterStore::value() const
+{
+    return m_value;
+}
+
+/**
+ * @brief increments the counter, every batch-th increment is committed to flash
+ */
+void CounterStore::increment()
+{
+    ++m_value;
+    if (m_value - m_committed >= m_batch)
+        commit();
+}
+
+/**
+ * @brief appends the current value to the log
+ * @note a sector is erased when the first slot of it is reached, the previous sector still holds the last record
+ */
+void CounterStore::commit()
+{
+    if ((!m_partition && !m_eeprom) || (m_hasRecord && m_value == m_committed))
+        return;
+    PROBE(probe_commit);
+
+    if (m_eeprom)
+    {
+        EEPROM.write(m_eepromAddress, static_cast<uint8_t>(m_value));
+        EEPROM.commit();
+        m_committed = m_value;
+        ++m_commits;
+        return;
+    }
+
+    const auto slots = m_partition->size / sizeof(Record);
+    const auto offset = m_nextSlot * sizeof(Record);
+    if (offset % counter_sector_size == 0)
+    {
+        esp_partition_erase_range(m_partition, offset, counter_sector_size);
+        ++m_erases;
+    }
+    const Record record{m_value, ~m_value};
+    esp_partition_write(m_partition, offset, &record, sizeof(record));
+    m_committed = m_value;
+    m_hasRecord = true;
+    m_nextSlot = (m_nextSlot + 1) % slots;
+    ++m_commits;
+}
+
+uint32_t CounterStore::commits() const
+{
+    return m_commits;
+}
+
+uint32_t CounterStore::erases() const
+{
+    return m_erases;
+}
+
+/**
+ * @brief the "seqlog" partition is missing, the counter lives in the eeprom cell of older firmware
+ */
+bool CounterStore::eeprom() const
+{
+    return m_eeprom;
+}
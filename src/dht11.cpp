@@ -0,0 +1,145 @@
+#include <Arduino.h>
+#include <dht11.h>
+
+#define SERIALDEBUG false // use usb/serial for debug instead communication with PC-Compagnion
+
+
+volatile uint32_t AsyncDht::s_edges[AsyncDht::max_edges];
+volatile size_t AsyncDht::s_edgeCount = 0;
+
+/**
+ * @brief records the time of a falling edge, the isr does nothing else
+ */
+void IRAM_ATTR AsyncDht::onFallingEdge()
+{
+    const auto count = s_edgeCount;
+    if (count < max_edges)
+    {
+        s_edges[count] = micros();
+        s_edgeCount = count + 1;
+    }
+}
+
+/**
+ * @brief idle line state, call once. the first read should start power_up_ms later.
+ */
+void AsyncDht::begin()
+{
+    pinMode(m_pin, INPUT_PULLUP);
+}
+
+/**
+ * @brief first step of a read: start signal, call release() start_ms later
+ */
+void AsyncDht::start()
+{
+    m_busy = true;
+    pinMode(m_pin, OUTPUT);
+    digitalWrite(m_pin, LOW);
+}
+
+/**
+ * @brief second step: releases the line and captures the answer, call finish() frame_ms later
+ */
+void AsyncDht::release()
+{
+    s_edgeCount = 0;
+    pinMode(m_pin, INPUT_PULLUP);
+    attachInterrupt(digitalPinToInterrupt(m_pin), onFallingEdge, FALLING);
+}
+
+/**
+ * @brief last step: stops the capture and publishes the decoded frame
+ *
+ * @param now [ms] timestamp of the measurement
+ * @return true if the frame was valid, reading() keeps the previous values otherwise
+ */
+bool AsyncDht::finish(unsigned long now)
+{
+    detachInterrupt(digitalPinToInterrupt(m_pin));
+    m_busy = false;
+    ++m_reads;
+
+    uint32_t edges[max_edges];
+    const auto count = s_edgeCount;
+    for (size_t i = 0; i < count; ++i)
+        edges[i] = s_edges[i];
+
+    ClimateReading reading;
+    if (!decode(edges, count, reading))
+    {
+        ++m_errors;
+#if SERIALDEBUG
+        Serial.print("dht11 frame rejected, edges: ");
+        Serial.println(count);
+#endif
+        return false;
+    }
+    reading.timestamp = now;
+    m_reading = reading;
+    return true;
+}
+
+/**
+ * @brief true between start() and finish()
+ */
+bool AsyncDht::busy() const
+{
+    return m_busy;
+}
+
+const ClimateReading &AsyncDht::reading() const
+{
+    return m_reading;
+}
+
+uint32_t AsyncDht::reads() const
+{
+    return m_reads;
+}
+
+/**
+ * @brief frames rejected by decode()
+ */
+uint32_t AsyncDht::errors() const
+{
+    return m_errors;
+}
+
+/**
+ * @brief decodes the falling edge times of a dht11 answer
+ * @note uses the last frame_edges edges, so a spurious edge before the frame does no harm. a missing or
+ * @note extra edge inside the frame fails the spacing or the checksum test.
+ *
+ * @param edges [us] falling edge times in capture order
+ * @param count number of edges
+ * @param reading decoded values, valid set, timestamp untouched
+ * @return true if the frame passed all checks
+ */
+bool AsyncDht::decode(const uint32_t *edges, size_t count, ClimateReading &reading)
+{
+    if (count < frame_edges)
+        return false;
+    const auto frame = edges + count - frame_edges;
+
+    uint8_t bytes[5]{};
+    for (size_t bit = 0; bit < 40; ++bit)
+    {
+        const auto spacing = frame[bit + 1] - frame[bit];
+        if (spacing < bit_min_us || spacing > bit_max_us)
+            return false;
+        if (spacing > bit_threshold_us)
+            bytes[bit / 8] |= 0x80 >> (bit % 8);
+    }
+    if (static_cast<uint8_t>(bytes[0] + bytes[1] + bytes[2] + bytes[3]) != bytes[4])
+        return false;
+    if (bytes[0] > 100)
+        return false;
+
+    // byte 3 bit 7 flags a negative temperature on newer dht11 parts
+    const auto tenths = bytes[2] * 10 + (bytes[3] & 0x7F) % 10;
+    reading.temperature = static_cast<int16_t>((bytes[3] & 0x80) ? -tenths : tenths);
+    reading.humidity = bytes[0];
+    reading.valid = true;
+    return true;
+}
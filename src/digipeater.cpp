@@ -0,0 +1,93 @@
+#include <aprsparser.h>
+#include <digipeater.h>
+
+
+/**
+ * @brief builds the frame to repeat
+ *
+ * @param frame received tnc2 frame
+ * @param length frame length
+ * @param out repeated frame
+ * @return false if the frame is not ours to repeat: own frame, no unused path element for us, malformed
+ */
+bool Digipeater::rewrite(const uint8_t *frame, size_t length, AprsFrame &out) const
+{
+    AprsPacket packet;
+    if (!AprsParser::header(std::string_view(reinterpret_cast<const char *>(frame), length), packet) ||
+        packet.source == m_callsign)
+        return false;
+
+    std::string_view elements[max_path];
+    size_t count = 0;
+    for (auto path = packet.path; !path.empty();)
+    {
+        if (count == max_path)
+            return false;
+        elements[count++] = AprsParser::nextPathElement(path);
+    }
+
+    // the first element without '*' after the last used one
+    size_t used = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (!elements[i].empty() && elements[i].back() == '*')
+            used = i + 1;
+    }
+    if (used >= count)
+        return false;
+    const auto element = elements[used];
+
+    const bool own = element == m_callsign;
+    uint8_t hops = 0;
+    if (!own)
+    {
+        if (!matches(element))
+            return false;
+        hops = element.back() - '0';
+        // WIDEn-N takes a slot for our callsign
+        if (count == max_path)
+            return false;
+    }
+
+    const auto append = [&out](std::string_view text) -> AprsFrame & {
+        return out.append(text.data(), text.size());
+    };
+    out.clear();
+    append(packet.source).append('>');
+    append(packet.destination);
+    for (size_t i = 0; i < used; ++i)
+    {
+        auto previous = elements[i];
+        if (!previous.empty() && previous.back() == '*')
+            previous.remove_suffix(1);
+        out.append(',');
+        append(previous);
+    }
+    out.append(',').append(m_callsign);
+    if (own)
+        out.append('*');
+    else if (hops > 1)
+        out.append("*,").append(element.data(), element.size() - 1).append(static_cast<char>('0' + hops - 1));
+    else
+        out.append(',').append(element.data(), element.size() - 2).append('*');
+    for (size_t i = used + 1; i < count; ++i)
+    {
+        out.append(',');
+        append(elements[i]);
+    }
+    out.append(':');
+    append(packet.payload);
+    return !out.overflow();
+}
+
+/**
+ * @brief WIDEn-N with 1 <= N <= n <= maxWide
+ */
+bool Digipeater::matches(std::string_view element) const
+{
+    if (element.size() != 7 || element.substr(0, 4) != "WIDE" || element[5] != '-')
+        return false;
+    const auto n = element[4] - '0';
+    const auto hops = element[6] - '0';
+    return n >= 1 && n <= m_maxWide && hops >= 1 && hops <= n;
+}
@@ -0,0 +1,110 @@
+#include <aprsparser.h>
+#include <dupecache.h>
+
+static_assert((DupeCache::capacity & (DupeCache::capacity - 1)) == 0, "capacity must be a power of two");
+
+
+/**
+ * @brief looks a frame up and remembers it, the window starts when a frame is first heard
+ *
+ * @param digest digest() of the frame
+ * @param now [ms]
+ * @return true if the frame was heard within the window
+ */
+bool DupeCache::seen(uint32_t digest, unsigned long now)
+{
+    ++m_lookups;
+    if (!digest)
+        digest = 1;
+    Entry *free = nullptr;
+    Entry *oldest = nullptr;
+    for (size_t i = 0; i < max_probe; ++i)
+    {
+        auto &entry = m_entries[(digest + i) & (capacity - 1)];
+        if (!entry.digest || expired(entry, now))
+        {
+            if (!free)
+                free = &entry;
+            continue;
+        }
+        if (entry.digest == digest)
+        {
+            ++m_hits;
+            return true;
+        }
+        if (!oldest || static_cast<long>(entry.time - oldest->time) < 0)
+            oldest = &entry;
+    }
+    if (!free)
+    {
+        ++m_evictions;
+        free = oldest;
+    }
+    free->digest = digest;
+    free->time = now;
+    return false;
+}
+
+/**
+ * @brief live entries
+ */
+size_t DupeCache::size(unsigned long now) const
+{
+    size_t count = 0;
+    for (const auto &entry : m_entries)
+        count += entry.digest && !expired(entry, now) ? 1 : 0;
+    return count;
+}
+
+uint32_t DupeCache::lookups() const
+{
+    return m_lookups;
+}
+
+uint32_t DupeCache::hits() const
+{
+    return m_hits;
+}
+
+uint32_t DupeCache::evictions() const
+{
+    return m_evictions;
+}
+
+/**
+ * @brief FNV-1a over "SOURCE>DEST:payload" of a tnc2 frame, the digipeater path is left out
+ * @note a frame without header is hashed as a whole
+ *
+ * @param frame tnc2 frame
+ * @param length frame length
+ * @return uint32_t digest
+ */
+uint32_t DupeCache::digest(const uint8_t *frame, size_t length)
+{
+    uint32_t hash = 2166136261UL;
+    auto add = [&hash](std::string_view text) {
+        for (const auto c : text)
+        {
+            hash ^= static_cast<uint8_t>(c);
+            hash *= 16777619UL;
+        }
+    };
+    const std::string_view text(reinterpret_cast<const char *>(frame), length);
+    AprsPacket packet;
+    if (!AprsParser::header(text, packet))
+    {
+        add(text);
+        return hash;
+    }
+    add(packet.source);
+    add(">");
+    add(packet.destination);
+    add(":");
+    add(packet.payload);
+    return hash;
+}
+
+bool DupeCache::expired(const Entry &entry, unsigned long now) const
+{
+    return now - entry.time >= m_window;
+}
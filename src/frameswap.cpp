@@ -0,0 +1,70 @@
+#include <cstring>
+#include <frameswap.h>
+
+
+/**
+ * @brief ui side, hands over a copy of the frame
+ *
+ * @param frame composed frame, the ui keeps drawing on it
+ * @param now [us] micros()
+ */
+void FrameSwap::publish(const uint8_t *frame, uint32_t now)
+{
+    memcpy(m_frames[m_back], frame, frame_size);
+    m_times[m_back] = now;
+    const auto previous = m_pending.exchange(m_back | fresh, std::memory_order_acq_rel);
+    if (previous & fresh)
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+    m_back = previous & ~fresh;
+    m_published.fetch_add(1, std::memory_order_relaxed);
+}
+
+/**
+ * @brief flush side, takes the newest frame
+ *
+ * @param published [us] micros() of its publication
+ * @return const uint8_t* frame, valid until the next take(), nullptr if none was published since the last take()
+ */
+const uint8_t *FrameSwap::take(uint32_t &published)
+{
+    if (!(m_pending.load(std::memory_order_acquire) & fresh))
+        return nullptr;
+    m_front = m_pending.exchange(m_front, std::memory_order_acq_rel) & ~fresh;
+    published = m_times[m_front];
+    return m_frames[m_front];
+}
+
+/**
+ * @brief flush side, the frame of take() is on the panel
+ *
+ * @param published [us] as returned by take()
+ * @param now [us] micros()
+ */
+void FrameSwap::flushed(uint32_t published, uint32_t now)
+{
+    m_latency.record(now - published);
+    m_flushed.write({m_latency.count(), m_latency.percentile(990), m_latency.max()});
+}
+
+/**
+ * @brief a published frame waits for take()
+ */
+bool FrameSwap::pending() const
+{
+    return m_pending.load(std::memory_order_acquire) & fresh;
+}
+
+/**
+ * @brief counters, from any task
+ */
+FrameSwapStats FrameSwap::stats() const
+{
+    const auto flushed = m_flushed.read();
+    FrameSwapStats stats;
+    stats.published = m_published.load(std::memory_order_relaxed);
+    stats.dropped = m_dropped.load(std::memory_order_relaxed);
+    stats.flushed = flushed.count;
+    stats.latencyP99 = flushed.latencyP99;
+    stats.latencyMax = flushed.latencyMax;
+    return stats;
+}
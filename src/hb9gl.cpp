@@ -1,4 +1,6 @@
 #include <hb9gl.h>
+#include <probe.h>
+#include <telemetry.h>
 #define SERIALDEBUG false // use usb/serial for debug instead communication with PC-Compagnion
 #define SERIALDATA !SERIALDEBUG
 
@@ -9,116 +11,130 @@ void Data::init()
     Serial.println("Data::Init");
 #endif
 
-    // read aprs sequence counter from eeprom
-    EEPROM.begin(512);
-    m_aprsPacketSeq = EEPROM.read(settings.basic.EEPROMaddress);
-    if (isnan(m_aprsPacketSeq))
-        m_aprsPacketSeq = 0;
-        // if (m_aprsPacketSeq < 146)
-        //     m_aprsPacketSeq = 146;
+    // restore aprs sequence counter from the seqlog partition, the eeprom without it
+    if (!m_seqStore.init())
+    {
+        // first boot with the seqlog, take over the counter older firmware kept in the eeprom
+        EEPROM.begin(512);
+        m_seqStore.set(EEPROM.read(settings.basic.EEPROMaddress));
+    }
+    m_aprsPacketSeq = static_cast<uint8_t>(m_seqStore.value());
 #if SERIALDEBUG
-    Serial.println("EEPROM initiated");
+    if (m_seqStore.eeprom())
+        Serial.println("no seqlog partition, flash the current partition table. sequence kept in the eeprom");
+    Serial.println("sequence store initiated");
     Serial.print("stored last APRS packet sequence#: ");
     Serial.println(m_aprsPacketSeq);
 #endif
 
 
     // read internal battery status
-    m_intvoltage = float(analogRead(settings.tlm.hall_sensor_pin)) / 4095 * 2 * 3.3 * 1.1;
-    m_battPercent = 100 * (m_intvoltage - 3.3) / (4.2 - 3.3);
-    if (m_battPercent > 100)
-        m_battPercent = 100;
-    if (m_battPercent < 0)
-        m_battPercent = 0;
+    m_battery.init();
+    sampleBattery();
 #if SERIALDEBUG
     Serial.print("internal battery percent: ");
     Serial.println(m_battPercent);
 #endif
 
-    // read dht22 sensor
-    m_dht.setup(settings.tlm.dht11_pin);
-    delay(1000);
-    auto currentTime = millis();
-    m_dhtTimeStamp = currentTime;
-    m_temperature = m_dht.getTemperature();
-    m_humidity = m_dht.getHumidity();
-    if (isnan(m_temperature))
-        m_temperature = 0.0f;
-    if (isnan(m_humidity))
-        m_humidity = 0.0f;
-
+    // dht11 sensor, the first read is scheduled once it has powered up
+    m_dht.begin();
 #if SERIALDEBUG
     Serial.println("DHT initiated");
-    Serial.print("Temp: ");
-    Serial.print(m_temperature);
-    Serial.print("°C Humidity: ");
-    Serial.print(m_humidity);
-    Serial.println("%");
 #endif
 }
 
-void Data::fetchSensorData()
+/**
+ * @brief the one acquisition step: reads the power pins and publishes a snapshot of all values
+ * @note getters and snapshot() never touch the hardware, call from the loop task only
+ */
+void Data::acquire()
 {
-#if SERIALDEBUG
-    // Serial.println("{Data::fetchSensorData}");
-#endif
-    get_intVoltage();
-    get_temperature();
-    get_statusMainsPower();
-    get_statusPCUSBpower();
+    PROBE(probe_acquire);
+    m_statusPCUSBpower = digitalRead(settings.tlm.usb_power_pin);
+    m_statusMainsPower = digitalRead(settings.tlm.ext_power_pin);
+
+    const auto &climate = m_dht.reading();
+    TelemetrySnapshot snapshot;
+    snapshot.timestamp = millis();
+    snapshot.climateTime = climate.timestamp;
+    snapshot.intvoltage = m_battery.millivolts();
+    snapshot.temperature = climate.temperature;
+    snapshot.humidity = climate.humidity;
+    snapshot.battPercent = m_battery.percent();
+    snapshot.status = get_statusBits();
+    snapshot.aprsPacketSeq = m_aprsPacketSeq;
+    snapshot.climateValid = climate.valid ? 1 : 0;
+    m_snapshot.write(snapshot);
 }
 
-void Data::updateData()
+/**
+ * @brief consistent copy of the values published by the last acquire(), safe from any task
+ */
+TelemetrySnapshot Data::snapshot() const
 {
-    fetchSensorData();
+    return m_snapshot.read();
 }
 
-float Data::get_temperature()
+/**
+ * @brief reads a burst of battery voltage samples, run by the scheduler every battery_interval
+ */
+void Data::sampleBattery()
 {
-    // read dht sensor data
-    const auto currentTime = millis();
-    if (currentTime - m_dhtTimeStamp >= m_dhtWaitTime)
-    {
-        m_dhtTimeStamp = currentTime;
-        m_temperature = m_dht.getTemperature();
-        if (isnan(m_temperature))
-            m_temperature = 0.0f;
-        m_humidity = m_dht.getHumidity();
-        if (isnan(m_humidity))
-            m_humidity = 0.0f;
-    }
+    m_battery.sample();
+    m_intvoltage = m_battery.millivolts() / 1000.0f;
+    m_battPercent = m_battery.percent();
+}
 
+/**
+ * @brief starts a dht sensor read, run by the scheduler every dht11_interval
+ * @note continue with releaseClimate() AsyncDht::start_ms and finishClimate() AsyncDht::frame_ms later
+ */
+void Data::sampleClimate()
+{
+    m_dht.start();
+}
+
+void Data::releaseClimate()
+{
+    m_dht.release();
+}
+
+/**
+ * @brief takes over the values of a valid dht frame, the previous ones are kept otherwise
+ */
+void Data::finishClimate()
+{
+    if (!m_dht.finish(millis()))
+        return;
+    const auto &reading = m_dht.reading();
+    m_temperature = reading.temperature / 10.0f;
+    m_humidity = reading.humidity;
+#if SERIALDEBUG
+    Serial.print("Temp: ");
+    Serial.print(m_temperature);
+    Serial.print("°C Humidity: ");
+    Serial.print(m_humidity);
+    Serial.println("%");
+#endif
+}
+
+float Data::get_temperature()
+{
     return m_temperature;
 }
 
 float Data::get_humidity()
 {
-    // read dht sensor data
-    get_temperature();
     return m_humidity;
 }
 
 float Data::get_intVoltage()
 {
-    // read internal voltage
-    const auto currentTime = millis();
-    if (currentTime - m_battTimeStamp >= m_battWaitTime)
-    {
-        m_battTimeStamp = currentTime;
-        m_intvoltage = float(analogRead(settings.tlm.hall_sensor_pin)) / 4095 * 2 * 3.3 * 1.1;
-    }
     return m_intvoltage;
 }
 
 int Data::get_battPercent()
 {
-    get_intVoltage();
-    m_battPercent = 100 * (m_intvoltage - 3.3) / (4.2 - 3.3);
-    if (m_battPercent > 100)
-        m_battPercent = 100;
-    if (m_battPercent < 0)
-        m_battPercent = 0;
-
     return m_battPercent;
 }
 
@@ -129,34 +145,60 @@ uint8_t Data::get_aprsPacketSeq()
 
 void Data::set_aprsPacketSeq(uint8_t count)
 {
+    m_seqStore.set(count);
     m_aprsPacketSeq = count;
 }
 
+/**
+ * @brief next aprs sequence number, persisted in batches by the sequence store
+ * @note loop task only, the radio task gets the number with its request and acquire() publishes it
+ */
 void Data::inc_aprsPacketSeq()
 {
-    ++m_aprsPacketSeq;
-    if (m_aprsPacketSeq > 999)
-        m_aprsPacketSeq = 0;
+    m_seqStore.increment();
+    m_aprsPacketSeq = static_cast<uint8_t>(m_seqStore.value());
 }
 
+/**
+ * @brief commits pending state to flash, call before a restart or when running on battery
+ */
+void Data::flush()
+{
+    m_seqStore.commit();
+}
+
+/**
+ * @brief usb power state of the last acquire()
+ */
 bool Data::get_statusPCUSBpower()
 {
-#if SERIALDEBUG
-    // Serial.println("{Data::get_statusPCUSBPower}");
-#endif
-    m_statusPCUSBpower = digitalRead(settings.tlm.usb_power_pin);
     return m_statusPCUSBpower;
 }
 
+/**
+ * @brief mains power state of the last acquire()
+ */
 bool Data::get_statusMainsPower()
 {
-#if SERIALDEBUG
-    // Serial.println("{Data::get_statusMainsPower}");
-#endif
-    m_statusMainsPower = digitalRead(settings.tlm.ext_power_pin);
     return m_statusMainsPower;
 }
 
+/**
+ * @brief all status flags packed in the order of the aprs telemetry digital channels
+ *
+ * @return uint8_t bit n is TelemetryDigitalId n
+ */
+uint8_t Data::get_statusBits()
+{
+    uint8_t bits = 0;
+    bits |= get_statusPCUSBpower() ? 1U << tlm_usbpower : 0;
+    bits |= get_statusMainsPower() ? 1U << tlm_mainspower : 0;
+    bits |= get_statusPCConnected() ? 1U << tlm_pcconnected : 0;
+    bits |= get_statusUpLink() ? 1U << tlm_uplink : 0;
+    bits |= get_statusEchoLink() ? 1U << tlm_echolink : 0;
+    return bits;
+}
+
 bool Data::get_statusChanged()
 {
     auto statusChanged =
@@ -220,6 +262,13 @@ void Display::init()
     m_lcd.init();
     m_lcd.flipScreenVertically();
     m_lcd.setBrightness(67);
+
+    // the static layers, rendered through the same path as a full frame
+    drawStatic(0);
+    memcpy(m_layers[0], m_lcd.buffer, OledPanel::frame_size);
+    drawStatic((1U << tlm_digital_count) - 1);
+    memcpy(m_layers[1], m_lcd.buffer, OledPanel::frame_size);
+
     char tmpStr[30]{""};
     m_lcd.clear();
     m_lcd.setTextAlignment(TEXT_ALIGN_LEFT);
@@ -231,8 +280,19 @@ void Display::init()
     m_lcd.drawString(0, 0, tmpStr);
     m_lcd.drawHorizontalLine(0, 11, 128);
     m_lcd.display();
+    // from here on only the changed pages are sent
+    m_panel.sync(m_lcd.buffer);
 }
 
+// the status boxes in the order they are drawn
+const Display::Box Display::s_boxes[tlm_digital_count] = {
+    {0, 37, 62, 13, &Texts::usb_pwr, tlm_usbpower},
+    {63, 37, 127 - 63, 13, &Texts::ext_pwr, tlm_mainspower},
+    {0, 50, 42, 13, &Texts::pc_conn, tlm_pcconnected},
+    {42, 50, 42, 13, &Texts::net_uplink, tlm_uplink},
+    {84, 50, 42, 13, &Texts::net_echolink, tlm_echolink},
+};
+
 /**
  * @brief Draws a string inside a box at the given location
  *
@@ -253,11 +313,169 @@ void Display::printBox(int16_t x, int16_t y, int16_t width, int16_t height, cons
     m_lcd.drawString(x + (width >> 1), y + (height >> 1), text); // >> 1 eq divide by 2
 }
 
+/**
+ * @brief redraws if a displayed field changed and hands the frame to refresh()
+ * @note never waits for the i2c bus, call from the task that owns the ui
+ */
 void Display::displayData()
 {
+    PROBE(probe_display);
 #if SERIALDEBUG
     // Serial.println("{Display::displayData}");
 #endif
+    if (!render(snapshot()))
+    {
+        ++m_skipped;
+        return;
+    }
+    m_frames.publish(m_lcd.buffer, micros());
+    ++m_redraws;
+}
+
+/**
+ * @brief sends the newest frame of displayData() to the panel, frames published meanwhile are dropped
+ * @note call from one task only, the display task in DUALCORE mode
+ *
+ * @return true if a frame was sent
+ */
+bool Display::refresh()
+{
+    bool sent = false;
+    while (refreshPage())
+        sent = true;
+    return sent;
+}
+
+/**
+ * @brief sends one page of the newest frame, takes the next frame once the current one is complete
+ * @note lets a single task flush between its other work, frames published before the flush took them are dropped
+ *
+ * @return true if a page was sent
+ */
+bool Display::refreshPage()
+{
+    if (!m_flushFrame)
+    {
+        m_flushFrame = m_frames.take(m_flushPublished);
+        if (!m_flushFrame)
+            return false;
+    }
+    if (m_panel.flushPage(m_flushFrame))
+    {
+        m_frames.flushed(m_flushPublished, micros());
+        m_panelStats.write(m_panel.stats());
+        m_flushFrame = nullptr;
+    }
+    return true;
+}
+
+/**
+ * @brief a frame is partly on the panel or waits for refreshPage()
+ */
+bool Display::flushing() const
+{
+    return m_flushFrame || m_frames.pending();
+}
+
+/**
+ * @brief brings the frame up to date: the text lines if one changed, the boxes whose status changed
+ * @note the static layers have to be rendered, see init()
+ *
+ * @param data values to show
+ * @return false if nothing displayed changed, the frame is left alone
+ */
+bool Display::render(const TelemetrySnapshot &data)
+{
+    auto fields = m_shown;
+    format(data, fields);
+    if (m_shownValid && fields == m_shown)
+        return false;
+
+    if (!m_shownValid)
+        memcpy(m_lcd.buffer, m_layers[0], OledPanel::frame_size);
+    if (!m_shownValid || strcmp(fields.battery, m_shown.battery) || strcmp(fields.climate, m_shown.climate))
+    {
+        // both lines share rows, they are drawn together
+        clearRows(battery_y, climate_y + text_height - 1);
+        m_lcd.setTextAlignment(TEXT_ALIGN_LEFT);
+        m_lcd.setFont(ArialMT_Plain_10);
+        m_lcd.setColor(WHITE);
+        m_lcd.drawString(0, battery_y, fields.battery);
+        m_lcd.drawString(0, climate_y, fields.climate);
+#if SERIALDEBUG
+        // Serial.println(fields.battery);
+        // Serial.println(fields.climate);
+#endif
+    }
+    const uint8_t changed = m_shownValid ? fields.status ^ m_shown.status : fields.status;
+    for (const auto &box : s_boxes)
+    {
+        if (changed & (1U << box.bit))
+            blitBox(box, fields.status & (1U << box.bit));
+    }
+    m_shown = fields;
+    m_shownValid = true;
+    return true;
+}
+
+/**
+ * @brief renders the whole frame from scratch, the way every redraw used to
+ */
+void Display::renderFull(const TelemetrySnapshot &data)
+{
+    char tmpStr[30]{""};
+    drawStatic(data.status);
+    m_lcd.setTextAlignment(TEXT_ALIGN_LEFT);
+    m_lcd.setColor(WHITE);
+    sprintf(tmpStr, m_txt.battery.c_str(), data.intvoltage / 1000.0f, data.battPercent);
+    m_lcd.drawString(0, battery_y, tmpStr);
+    sprintf(tmpStr, m_txt.temp_hum.c_str(), data.temperature / 10.0f, static_cast<float>(data.humidity));
+    m_lcd.drawString(0, climate_y, tmpStr);
+}
+
+/**
+ * @brief the frame render() and renderFull() compose, byte x + page * 128 holds the 8 rows of column x
+ */
+const uint8_t *Display::frame() const
+{
+    return m_lcd.buffer;
+}
+
+/**
+ * @brief redraw counters of the ui task, the flush figures as of the last frame the flush task completed
+ */
+DisplayStats Display::stats() const
+{
+    return {m_redraws, m_skipped, m_frames.stats(), m_panelStats.read()};
+}
+
+/**
+ * @brief formats the text lines, a value that was already formatted keeps its text
+ */
+void Display::format(const TelemetrySnapshot &data, Fields &fields) const
+{
+    const uint32_t battery = static_cast<uint32_t>(data.intvoltage) << 8 | data.battPercent;
+    const uint32_t climate = static_cast<uint32_t>(static_cast<uint16_t>(data.temperature)) << 8 | data.humidity;
+    if (!m_shownValid || battery != fields.batteryValue)
+    {
+        sprintf(fields.battery, m_txt.battery.c_str(), data.intvoltage / 1000.0f, data.battPercent);
+        fields.batteryValue = battery;
+    }
+    if (!m_shownValid || climate != fields.climateValue)
+    {
+        sprintf(fields.climate, m_txt.temp_hum.c_str(), data.temperature / 10.0f, static_cast<float>(data.humidity));
+        fields.climateValue = climate;
+    }
+    fields.status = data.status;
+}
+
+/**
+ * @brief title and status boxes without the text lines
+ *
+ * @param status bit n set draws the box of TelemetryDigitalId n inverse
+ */
+void Display::drawStatic(uint8_t status)
+{
     char tmpStr[30]{""};
     m_lcd.clear();
     m_lcd.setTextAlignment(TEXT_ALIGN_LEFT);
@@ -269,47 +487,46 @@ void Display::displayData()
     strcat(tmpStr, settings.basic.version.c_str());
     m_lcd.drawString(0, 0, tmpStr);
 
-    sprintf(tmpStr, m_txt.battery.c_str(), m_intvoltage, m_battPercent);
-    m_lcd.drawString(0, 13, tmpStr);
-#if SERIALDEBUG
-    // Serial.println(tmpStr);
-#endif
-
-    sprintf(tmpStr, m_txt.temp_hum.c_str(), m_temperature, m_humidity);
-    m_lcd.drawString(0, 24, tmpStr);
-#if SERIALDEBUG
-    // Serial.println(tmpStr);
-#endif
-
-    sprintf(tmpStr, m_txt.usb_pwr.c_str());
-    printBox(0, 37, 62, 13, tmpStr, m_statusPCUSBpower);
-#if SERIALDEBUG
-    // Serial.println(tmpStr);
-#endif
-
-    sprintf(tmpStr, m_txt.ext_pwr.c_str());
-    printBox(63, 37, 127 - 63, 13, tmpStr, m_statusMainsPower);
-#if SERIALDEBUG
-    // Serial.println(tmpStr);
-#endif
-
-    sprintf(tmpStr, m_txt.pc_conn.c_str());
-    printBox(0, 50, 42, 13, tmpStr, m_statusPCconnected);
-#if SERIALDEBUG
-    // Serial.println(tmpStr);
-#endif
+    for (const auto &box : s_boxes)
+        printBox(box.x, box.y, box.width, box.height, (m_txt.*box.label).c_str(), status & (1U << box.bit));
+}
 
-    sprintf(tmpStr, m_txt.net_uplink.c_str());
-    printBox(42, 50, 42, 13, tmpStr, m_statusUpLink);
+/**
+ * @brief copies the box from the static layer of its state, rows outside the box are left alone
+ */
+void Display::blitBox(const Box &box, bool inverse)
+{
+    const auto layer = m_layers[inverse ? 1 : 0];
+    const int16_t last = box.y + box.height - 1;
+    for (int16_t page = box.y / 8; page <= last / 8; ++page)
+    {
+        const auto first = page * 8 > box.y ? page * 8 : box.y;
+        const auto end = page * 8 + 7 < last ? page * 8 + 7 : last;
+        const uint8_t mask = (0xFF << (first - page * 8)) & (0xFF >> (page * 8 + 7 - end));
+        for (int16_t x = box.x; x < box.x + box.width; ++x)
+        {
+            const auto index = x + page * OledPanel::width;
+            m_lcd.buffer[index] = (m_lcd.buffer[index] & ~mask) | (layer[index] & mask);
+        }
+    }
+}
 
-#if SERIALDEBUG
-    // Serial.println(tmpStr);
-#endif
+/**
+ * @brief clears the rows first to last over the full width
+ */
+void Display::clearRows(int16_t first, int16_t last)
+{
+    for (int16_t page = first / 8; page <= last / 8; ++page)
+    {
+        const auto from = page * 8 > first ? page * 8 : first;
+        const auto to = page * 8 + 7 < last ? page * 8 + 7 : last;
+        const uint8_t mask = (0xFF << (from - page * 8)) & (0xFF >> (page * 8 + 7 - to));
+        for (int16_t x = 0; x < OledPanel::width; ++x)
+            m_lcd.buffer[x + page * OledPanel::width] &= ~mask;
+    }
+}
 
-    sprintf(tmpStr, m_txt.net_echolink.c_str());
-    printBox(84, 50, 42, 13, tmpStr, m_statusEchoLink);
-#if SERIALDEBUG
-    // Serial.println(tmpStr);
-#endif
-    m_lcd.display();
+bool Display::Fields::operator==(const Fields &other) const
+{
+    return status == other.status && !strcmp(battery, other.battery) && !strcmp(climate, other.climate);
 }
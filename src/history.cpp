@@ -0,0 +1,408 @@
+#include <Arduino.h>
+#include <cstring>
+#include <history.h>
+#include <probe.h>
+#include <serialproto.h>
+
+#define SERIALDEBUG false // use usb/serial for debug instead communication with PC-Compagnion
+
+static_assert(sizeof(HistoryBlock) == HistoryBlock::size, "history block layout");
+
+static constexpr size_t history_sector_size = 4096; // flash erase unit
+static constexpr size_t history_max_record = 16;    // longest encoded sample
+
+
+static size_t put_varint(uint8_t *out, uint32_t value)
+{
+    size_t n = 0;
+    while (value >= 0x80)
+    {
+        out[n++] = static_cast<uint8_t>(value | 0x80);
+        value >>= 7;
+    }
+    out[n++] = static_cast<uint8_t>(value);
+    return n;
+}
+
+static size_t get_varint(const uint8_t *in, uint32_t &value)
+{
+    size_t n = 0;
+    value = 0;
+    for (int shift = 0; shift < 35; shift += 7)
+    {
+        const auto byte = in[n++];
+        value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80))
+            break;
+    }
+    return n;
+}
+
+static uint32_t zigzag(int32_t value)
+{
+    return (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31);
+}
+
+static int32_t unzigzag(uint32_t value)
+{
+    return static_cast<int32_t>(value >> 1) ^ -static_cast<int32_t>(value & 1);
+}
+
+
+/**
+ * @brief looks for the "history" partition and restores the persisted blocks
+ */
+void HistoryLog::init()
+{
+    m_partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, "history");
+    if (m_partition)
+        restore();
+#if SERIALDEBUG
+    Serial.print("history restored, samples: ");
+    Serial.println(samples());
+#endif
+}
+
+/**
+ * @brief history clock, continues from the last persisted sample after a reboot
+ *
+ * @return uint32_t [sec]
+ */
+uint32_t HistoryLog::now() const
+{
+    return m_timeBase + millis() / 1000;
+}
+
+HistoryBlock &HistoryLog::block(uint32_t sequence)
+{
+    return m_blocks[sequence % blocks];
+}
+
+const HistoryBlock &HistoryLog::block(uint32_t sequence) const
+{
+    return m_blocks[sequence % blocks];
+}
+
+/**
+ * @brief encodes a sample
+ * @note absolute: varint time, voltage, temperature (little endian), humidity, status
+ * @note delta: flags, varint time delta, zigzag varint deltas of the fields named in flags, status
+ *
+ * @param sample sample to encode
+ * @param previous preceding sample of the block, nullptr for the absolute first sample
+ * @param out at least history_max_record bytes
+ * @return size_t encoded length
+ */
+size_t HistoryLog::encode(const HistorySample &sample, const HistorySample *previous, uint8_t *out)
+{
+    size_t n = 0;
+    if (!previous)
+    {
+        n += put_varint(out, sample.time);
+        out[n++] = static_cast<uint8_t>(sample.intvoltage);
+        out[n++] = static_cast<uint8_t>(sample.intvoltage >> 8);
+        out[n++] = static_cast<uint8_t>(sample.temperature);
+        out[n++] = static_cast<uint8_t>(sample.temperature >> 8);
+        out[n++] = sample.humidity;
+        out[n++] = sample.status;
+        return n;
+    }
+
+    uint8_t flags = 0;
+    flags |= sample.intvoltage != previous->intvoltage ? 0x01 : 0;
+    flags |= sample.temperature != previous->temperature ? 0x02 : 0;
+    flags |= sample.humidity != previous->humidity ? 0x04 : 0;
+    flags |= sample.status != previous->status ? 0x08 : 0;
+    out[n++] = flags;
+    n += put_varint(out + n, sample.time - previous->time);
+    if (flags & 0x01)
+        n += put_varint(out + n, zigzag(sample.intvoltage - previous->intvoltage));
+    if (flags & 0x02)
+        n += put_varint(out + n, zigzag(sample.temperature - previous->temperature));
+    if (flags & 0x04)
+        n += put_varint(out + n, zigzag(sample.humidity - previous->humidity));
+    if (flags & 0x08)
+        out[n++] = sample.status;
+    return n;
+}
+
+/**
+ * @brief decodes a sample written by encode()
+ *
+ * @return size_t consumed length
+ */
+size_t HistoryLog::decode(const uint8_t *in, const HistorySample *previous, HistorySample &sample)
+{
+    size_t n = 0;
+    uint32_t value;
+    if (!previous)
+    {
+        n += get_varint(in, sample.time);
+        sample.intvoltage = in[n] | (in[n + 1] << 8);
+        n += 2;
+        sample.temperature = static_cast<int16_t>(in[n] | (in[n + 1] << 8));
+        n += 2;
+        sample.humidity = in[n++];
+        sample.status = in[n++];
+        return n;
+    }
+
+    sample = *previous;
+    const auto flags = in[n++];
+    n += get_varint(in + n, value);
+    sample.time += value;
+    if (flags & 0x01)
+    {
+        n += get_varint(in + n, value);
+        sample.intvoltage += unzigzag(value);
+    }
+    if (flags & 0x02)
+    {
+        n += get_varint(in + n, value);
+        sample.temperature += unzigzag(value);
+    }
+    if (flags & 0x04)
+    {
+        n += get_varint(in + n, value);
+        sample.humidity += unzigzag(value);
+    }
+    if (flags & 0x08)
+        sample.status = in[n++];
+    return n;
+}
+
+/**
+ * @brief appends a sample, the oldest block is dropped when the ring is full
+ *
+ * @param sample sample, time is clamped to be monotonic
+ */
+void HistoryLog::record(HistorySample sample)
+{
+    PROBE(probe_history);
+    if (m_open && sample.time < m_last.time)
+        sample.time = m_last.time;
+    if (!m_open)
+    {
+        open_block(sample);
+        return;
+    }
+
+    auto &current = block(m_nextSequence - 1);
+    uint8_t record[history_max_record];
+    const auto length = encode(sample, &m_last, record);
+    if (current.used + length > sizeof(current.data))
+    {
+        close_block();
+        open_block(sample);
+        return;
+    }
+    memcpy(current.data + current.used, record, length);
+    current.used += length;
+    ++current.count;
+    current.lastTime = sample.time;
+    m_last = sample;
+}
+
+/**
+ * @brief starts a new block with an absolute sample
+ */
+void HistoryLog::open_block(const HistorySample &sample)
+{
+    if (m_nextSequence - m_firstSequence >= blocks)
+        ++m_firstSequence;
+    auto &current = block(m_nextSequence);
+    current.magic = HistoryBlock::magic_value;
+    current.check = 0;
+    current.sequence = m_nextSequence;
+    current.firstTime = sample.time;
+    current.lastTime = sample.time;
+    current.used = encode(sample, nullptr, current.data);
+    current.count = 1;
+    ++m_nextSequence;
+    m_open = true;
+    m_last = sample;
+}
+
+/**
+ * @brief closes the open block and persists it
+ */
+void HistoryLog::close_block()
+{
+    if (!m_open)
+        return;
+    m_open = false;
+    persist(block(m_nextSequence - 1));
+}
+
+/**
+ * @brief persists the open block, e.g. before a restart. the next sample starts a new block.
+ */
+void HistoryLog::flush()
+{
+    close_block();
+}
+
+/**
+ * @brief writes a closed block to its slot of the "history" partition
+ * @note the partition is used as a ring of block slots, a sector is erased when its first slot is written
+ */
+void HistoryLog::persist(HistoryBlock &block)
+{
+    if (!m_partition)
+        return;
+    const auto slots = m_partition->size / HistoryBlock::size;
+    const auto offset = (block.sequence % slots) * HistoryBlock::size;
+    if (offset % history_sector_size == 0)
+        esp_partition_erase_range(m_partition, offset, history_sector_size);
+    block.check = 0;
+    block.check = SerialProtocol::crc16(reinterpret_cast<const uint8_t *>(&block), sizeof(block));
+    esp_partition_write(m_partition, offset, &block, sizeof(block));
+}
+
+/**
+ * @brief reads a persisted block of the ring and verifies it
+ *
+ * @param sequence block
+ * @param out block read, also when it is invalid
+ * @return false if the slot doesn't hold this block or it fails its crc
+ */
+bool HistoryLog::read_block(uint32_t sequence, HistoryBlock &out) const
+{
+    const auto slots = m_partition->size / HistoryBlock::size;
+    esp_partition_read(m_partition, (sequence % slots) * HistoryBlock::size, &out, sizeof(out));
+    const auto check = out.check;
+    out.check = 0;
+    const auto ok = out.magic == HistoryBlock::magic_value && out.sequence == sequence &&
+                    SerialProtocol::crc16(reinterpret_cast<const uint8_t *>(&out), sizeof(out)) == check;
+    out.check = check;
+    return ok;
+}
+
+/**
+ * @brief loads the newest persisted blocks into RAM and continues the history clock
+ * @note the newest block is the newest one that passes its crc, a block torn by a reset or damaged in flash is
+ * skipped together with everything older than it
+ */
+void HistoryLog::restore()
+{
+    const auto slots = m_partition->size / HistoryBlock::size;
+    bool found = false;
+    uint32_t newest = 0;
+    for (size_t slot = 0; slot < slots; ++slot)
+    {
+        HistoryBlock header;
+        esp_partition_read(m_partition, slot * HistoryBlock::size, &header, offsetof(HistoryBlock, data));
+        if (header.magic != HistoryBlock::magic_value || header.sequence % slots != slot)
+            continue;
+        if (found && header.sequence <= newest)
+            continue;
+        HistoryBlock candidate;
+        if (!read_block(header.sequence, candidate))
+            continue;
+        newest = header.sequence;
+        found = true;
+    }
+    if (!found)
+        return;
+
+    m_nextSequence = newest + 1;
+    m_firstSequence = m_nextSequence;
+    // keep one RAM block free for the samples of this boot
+    for (uint32_t sequence = newest; m_nextSequence - sequence < blocks; --sequence)
+    {
+        if (!read_block(sequence, block(sequence)))
+            break;
+        m_firstSequence = sequence;
+        if (sequence == 0)
+            break;
+    }
+    m_timeBase = block(newest).lastTime + 1;
+}
+
+/**
+ * @brief starts a range query
+ *
+ * @param from [sec] history clock, inclusive
+ * @param to [sec] history clock, inclusive
+ * @return HistoryCursor pass to next()
+ */
+HistoryCursor HistoryLog::query(uint32_t from, uint32_t to) const
+{
+    HistoryCursor cursor{};
+    cursor.from = from;
+    cursor.to = to;
+    cursor.sequence = m_firstSequence;
+    // skip whole blocks which end before the range
+    while (cursor.sequence < m_nextSequence && block(cursor.sequence).lastTime < from)
+        ++cursor.sequence;
+    return cursor;
+}
+
+/**
+ * @brief fetches the next sample of a range query
+ * @note the cursor stays valid while samples are recorded, blocks dropped in the meantime are skipped
+ *
+ * @param cursor cursor from query()
+ * @param sample next sample within the range
+ * @return false if the query is complete
+ */
+bool HistoryLog::next(HistoryCursor &cursor, HistorySample &sample) const
+{
+    while (!cursor.done)
+    {
+        if (cursor.sequence < m_firstSequence)
+        {
+            cursor.sequence = m_firstSequence;
+            cursor.offset = 0;
+            cursor.index = 0;
+        }
+        if (cursor.sequence >= m_nextSequence)
+            break;
+        const auto &current = block(cursor.sequence);
+        if (current.firstTime > cursor.to)
+            break;
+        if (cursor.index >= current.count)
+        {
+            ++cursor.sequence;
+            cursor.offset = 0;
+            cursor.index = 0;
+            continue;
+        }
+        cursor.offset += decode(current.data + cursor.offset, cursor.index ? &cursor.previous : nullptr, sample);
+        ++cursor.index;
+        cursor.previous = sample;
+        if (sample.time > cursor.to)
+            break;
+        if (sample.time >= cursor.from)
+            return true;
+    }
+    cursor.done = true;
+    return false;
+}
+
+/**
+ * @brief number of samples held in RAM
+ */
+uint32_t HistoryLog::samples() const
+{
+    uint32_t count = 0;
+    for (auto sequence = m_firstSequence; sequence < m_nextSequence; ++sequence)
+        count += block(sequence).count;
+    return count;
+}
+
+/**
+ * @brief encoded bytes held in RAM
+ */
+uint32_t HistoryLog::bytesUsed() const
+{
+    uint32_t used = 0;
+    for (auto sequence = m_firstSequence; sequence < m_nextSequence; ++sequence)
+        used += block(sequence).used;
+    return used;
+}
+
+bool HistoryLog::persistent() const
+{
+    return m_partition != nullptr;
+}
@@ -0,0 +1,175 @@
+#include <Arduino.h>
+#include <driver/gpio.h>
+#include <driver/uart.h>
+#include <esp_sleep.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <idle.h>
+
+#define SERIALDEBUG false // use usb/serial for debug instead communication with PC-Compagnion
+
+static constexpr int idle_uart_wakeup_edges = 3; // rx edges that end a light sleep, the bytes themselves are lost
+
+
+void *IdleWait::s_task = nullptr;
+volatile uint8_t IdleWait::s_sources = 0;
+
+/**
+ * @brief registers the wake sources, call from the loop task
+ */
+void IdleWait::init()
+{
+    s_task = xTaskGetCurrentTaskHandle();
+    Serial.onReceive(onUartReceive);
+    attachInterrupt(digitalPinToInterrupt(m_settings.tlm.usb_power_pin), onPowerEdge, CHANGE);
+    attachInterrupt(digitalPinToInterrupt(m_settings.tlm.ext_power_pin), onPowerEdge, CHANGE);
+}
+
+/**
+ * @brief wakes a waiting loop task, task context
+ *
+ * @param source IdleWakeSource
+ */
+void IdleWait::wake(uint8_t source)
+{
+    s_sources |= source;
+    if (s_task)
+        xTaskNotifyGive(static_cast<TaskHandle_t>(s_task));
+}
+
+/**
+ * @brief wakes a waiting loop task, interrupt context
+ *
+ * @param source IdleWakeSource
+ */
+void IRAM_ATTR IdleWait::wakeFromIsr(uint8_t source)
+{
+    s_sources |= source;
+    if (!s_task)
+        return;
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(static_cast<TaskHandle_t>(s_task), &woken);
+    portYIELD_FROM_ISR(woken);
+}
+
+void IRAM_ATTR IdleWait::onPowerEdge()
+{
+    wakeFromIsr(idle_wake_power);
+}
+
+/**
+ * @brief called by the uart event task, not an isr
+ */
+void IdleWait::onUartReceive()
+{
+    wake(idle_wake_uart);
+}
+
+/**
+ * @brief waits until the deadline or a wake source fires
+ * @note returns at once if a wake source fired since the last wait
+ *
+ * @param deadline [ms] absolute millis() time
+ * @param lightSleep allow a light sleep, only when no serial traffic is expected and the radio is idle
+ */
+void IdleWait::wait(unsigned long deadline, bool lightSleep)
+{
+    const auto now = millis();
+    const long timeout = static_cast<long>(deadline - now);
+    if (timeout <= 0)
+        return;
+
+    const auto start = esp_timer_get_time();
+    uint8_t sources;
+    if (lightSleep)
+    {
+        sources = light_sleep(timeout);
+        ++m_lightSleeps;
+        // a pending notification is stale after the sleep
+        ulTaskNotifyTake(pdTRUE, 0);
+    }
+    else
+    {
+        sources = ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(timeout)) ? 0 : idle_wake_timer;
+    }
+    m_idleUs += esp_timer_get_time() - start;
+    ++m_waits;
+
+    noInterrupts();
+    sources |= s_sources;
+    s_sources = 0;
+    interrupts();
+    count(sources);
+}
+
+/**
+ * @brief light sleep with timer, power pin and uart wakeup
+ * @note gpio wakeup is level triggered, so the power pins wake on the level they don't have now
+ *
+ * @return uint8_t IdleWakeSource bits
+ */
+uint8_t IdleWait::light_sleep(unsigned long timeout)
+{
+    const gpio_num_t pins[] = {static_cast<gpio_num_t>(m_settings.tlm.usb_power_pin),
+                               static_cast<gpio_num_t>(m_settings.tlm.ext_power_pin)};
+    for (auto pin : pins)
+        gpio_wakeup_enable(pin, digitalRead(pin) ? GPIO_INTR_LOW_LEVEL : GPIO_INTR_HIGH_LEVEL);
+    esp_sleep_enable_gpio_wakeup();
+    esp_sleep_enable_timer_wakeup(static_cast<uint64_t>(timeout) * 1000);
+    uart_set_wakeup_threshold(UART_NUM_0, idle_uart_wakeup_edges);
+    esp_sleep_enable_uart_wakeup(UART_NUM_0);
+    Serial.flush();
+
+    esp_light_sleep_start();
+
+    // back to the edge interrupts of init()
+    for (auto pin : pins)
+    {
+        gpio_wakeup_disable(pin);
+        gpio_set_intr_type(pin, GPIO_INTR_ANYEDGE);
+    }
+    switch (esp_sleep_get_wakeup_cause())
+    {
+    case ESP_SLEEP_WAKEUP_GPIO:
+        return idle_wake_power;
+    case ESP_SLEEP_WAKEUP_UART:
+        return idle_wake_uart;
+    default:
+        return idle_wake_timer;
+    }
+}
+
+void IdleWait::count(uint8_t sources)
+{
+    for (size_t bit = 0; bit < sizeof(m_wakes) / sizeof(m_wakes[0]); ++bit)
+    {
+        if (sources & (1U << bit))
+            ++m_wakes[bit];
+    }
+#if SERIALDEBUG
+    Serial.print("idle wake: ");
+    Serial.println(sources);
+#endif
+}
+
+/**
+ * @brief wake and duty cycle counters
+ *
+ * @return IdleStats
+ */
+IdleStats IdleWait::stats() const
+{
+    IdleStats stats;
+    const uint64_t uptimeUs = esp_timer_get_time();
+    stats.uptime_ms = static_cast<uint32_t>(uptimeUs / 1000);
+    stats.idle_ms = static_cast<uint32_t>(m_idleUs / 1000);
+    stats.waits = m_waits;
+    stats.lightSleeps = m_lightSleeps;
+    stats.wakeTimer = m_wakes[0];
+    stats.wakeUart = m_wakes[1];
+    stats.wakePower = m_wakes[2];
+    stats.wakeRadio = m_wakes[3];
+    stats.dutyCycle = uptimeUs > m_idleUs ? static_cast<uint16_t>((uptimeUs - m_idleUs) * 1000 / uptimeUs) : 0;
+    return stats;
+}
@@ -1,18 +1,31 @@
 #include <Arduino.h>
-#include <config.h>    // our configuration file
-#include <hb9gl.h>     // data and display handling
-#include <interface.h> // USB communication definition with PC-Compagnion
-#include <mylora.h>    // lora handling
+#include <config.h>       // our configuration file
+#include <freertos/task.h>
+#include <hb9gl.h>        // data and display handling
+#include <history.h>      // telemetry history ring
+#include <idle.h>         // wait for the next deadline
+#include <interface.h>    // USB communication definition with PC-Compagnion
+#include <mylora.h>       // lora handling
+#include <probe.h>        // loop stage latency histograms
+#include <reportpolicy.h> // change driven telemetry
+#include <scheduler.h>    // periodic jobs
+#include <serialproto.h>  // framing of the interface.h messages
+#include <serialtx.h>     // non blocking output to the pc-compagnion
+#include <spscqueue.h>    // queues between the DUALCORE tasks
+#include <subscription.h> // push mode for the pc-compagnion
+#include <taskmonitor.h>  // stack and latency figures of the tasks
 
 // defines for debugging purpuoses
 #define LORA true         // enable LoRa tx
 #define SERIALDEBUG false // use usb/serial for debug instead communication with PC-Compagnion
+#define IDLEWAIT true     // wait for the next deadline or event instead of spinning through loop()
+#define DUALCORE false    // radio on core 0, display and pc link in their own tasks on core 1
 #define SERIALDATA !SERIALDEBUG
 
 const Settings settings;
 
 EspClass esp;
-DHT dht;
+AsyncDht dht(settings.tlm.dht11_pin);
 SSD1306 lcd(settings.basic.display_address, settings.basic.display_sda, settings.basic.display_scl);
 Display display(lcd, dht);
 MyLora lora;
@@ -22,25 +35,557 @@ static time_t lastIgBeacon = 0;
 static time_t lastMtBeacon = 0;
 static time_t lastUpload = 0;
 
-unsigned long lastSerialPacketReceived = 0;
 unsigned long KeepAliveInterval = settings.tlm.pc_timeout * 1000L;
+unsigned long lastAPRSData = 0;   // [ms] last scheduled aprs telemetry
+unsigned long lastAPRSStatus = 0; // [ms] last scheduled aprs status
 
-// basic timer struct
-struct TIMER
+Scheduler scheduler(millis);
+IdleWait idle;
+ReportPolicy report(settings.tlm);
+bool statusBlink{false};
+
+unsigned long currentTime;
+
+SerialProtocol pcLink;
+SerialTx pcOutput(Serial, settings.basic.serial_baud);
+SerialMessage pcMessage;
+Subscription subscription;
+HistoryLog history;
+HistoryCursor historyQuery;
+bool historyQueryActive{false};
+uint32_t rxForwarded{0};
+
+// work for the radio, done by the radio task in DUALCORE mode, directly otherwise
+enum RadioRequestKind : uint8_t
+{
+    radio_beacon,
+    radio_data,
+    radio_receive, // receive path on or off
+    radio_digipeat,
+    radio_silent,
+};
+
+struct RadioRequest
 {
-    unsigned long stamp;
-    unsigned long duration;
-    bool state;
+    RadioRequestKind kind;
+    TxPriority priority;
+    uint8_t sequence;  // aprs sequence number of radio_data, counted by the loop task which owns the store
+    uint32_t enqueued; // [us]
 };
 
-TIMER statusBlink{0, 1000, 0};                                         // timer to control LED blinking with 1000 msec
-TIMER tmrAPRSsendData{0, settings.tlm.beacon_interval * 60 * 1000, 0}; // timer to tx APRS Data
-TIMER tmrAPRSsendStatus{0, 1 * settings.tlm.status_interval * 60 * 1000, 0}; // timer to tx APRS Status
-TIMER tmrGetDHT11Data{0,
-                      settings.tlm.dht11_interval * 1000,
-                      0}; // timer to get new environmental data from DHT11 sensor
+TaskMonitor loopMonitor{"loop"};
+#if DUALCORE
+constexpr uint32_t task_stack = 4096;       // [bytes]
+constexpr unsigned long radio_poll_ms = 10; // tx done poll, dio0 only wakes the loop task
+constexpr unsigned long pc_poll_ms = 5;
 
-unsigned long currentTime;
+TaskMonitor radioMonitor{"radio"};
+TaskMonitor displayMonitor{"display"};
+TaskMonitor pcMonitor{"pc"};
+SpscQueue<RadioRequest, 8> radioQueue; // loop -> radio task
+SpscQueue<uint32_t, 2> displayQueue;   // loop -> display task, flush requests
+SpscQueue<SerialMessage, 4> pcInbox;   // pc task -> loop
+#endif
+
+/**
+ * @brief queues a framed message to the pc-compagnion, the loop pass drains the queue
+ *
+ * @tparam T interface.h message
+ * @param msg message
+ */
+template <typename T>
+void sendMessage(const T &msg)
+{
+    uint8_t frame[SerialProtocol::max_frame];
+    const auto length = SerialProtocol::encode(T::command, &msg, sizeof(msg), frame, sizeof(frame));
+    pcOutput.queue(frame, length);
+}
+
+/**
+ * @brief executes a radio request
+ */
+void serveRadio(const RadioRequest &request)
+{
+    switch (request.kind)
+    {
+    case radio_beacon:
+        lora.tx_telemetry_beacon(display);
+        break;
+    case radio_data:
+        lora.tx_telemetry_data(display, request.sequence, request.priority);
+        break;
+    case radio_receive:
+        lora.mode(true, false);
+        break;
+    case radio_digipeat:
+        lora.mode(true, true);
+        break;
+    case radio_silent:
+        lora.mode(false, false);
+        break;
+    }
+}
+
+/**
+ * @brief hands work to the radio
+ *
+ * @param kind request
+ * @param priority transmit priority of radio_data
+ */
+void requestRadio(RadioRequestKind kind, TxPriority priority = tx_priority_data)
+{
+    // radio_data takes the next sequence number, it is counted once the request is accepted so a drop leaves no gap
+    const auto sequence = static_cast<uint8_t>(display.get_aprsPacketSeq() + (kind == radio_data ? 1 : 0));
+    const RadioRequest request{kind, priority, sequence, static_cast<uint32_t>(micros())};
+#if DUALCORE
+    if (!radioQueue.push(request))
+        return;
+    xTaskNotifyGive(static_cast<TaskHandle_t>(radioMonitor.handle()));
+#else
+    serveRadio(request);
+#endif
+    if (kind == radio_data)
+        display.inc_aprsPacketSeq();
+}
+
+/**
+ * @brief redraws the display, the frame goes to the panel on the display task in DUALCORE mode, a page per loop pass
+ * otherwise
+ */
+void requestRedraw()
+{
+    display.displayData();
+#if DUALCORE
+    // a full queue already holds a pending flush, it sends the newest frame
+    if (displayQueue.push(micros()))
+        xTaskNotifyGive(static_cast<TaskHandle_t>(displayMonitor.handle()));
+#endif
+}
+
+/**
+ * @brief appends the current values to the history
+ */
+void recordHistory()
+{
+    const auto data = display.snapshot();
+    HistorySample sample;
+    sample.time = history.now();
+    sample.intvoltage = data.intvoltage;
+    sample.temperature = data.temperature;
+    sample.humidity = data.humidity;
+    sample.status = data.status;
+    history.record(sample);
+}
+
+/**
+ * @brief sends the next chunk of a running history query
+ */
+void sendHistoryChunk()
+{
+    esp_history_response_message rsp{};
+    rsp.now = history.now();
+    HistorySample sample;
+    while (rsp.count < esp_history_response_message::max_samples && history.next(historyQuery, sample))
+        rsp.samples[rsp.count++] = sample;
+    rsp.last = historyQuery.done ? 1 : 0;
+    historyQueryActive = !historyQuery.done;
+    sendMessage(rsp);
+}
+
+/**
+ * @brief hands the unique frames heard on the air to a connected pc-compagnion, which gates them to aprs-is
+ */
+void forwardReceived()
+{
+    static_assert(sizeof(esp_rx_frame_message) <= SerialMessage::max_payload, "rx frame message too long");
+    RxFrame frame;
+    while (lora.received(frame))
+    {
+        if (!display.get_statusPCConnected() || frame.length > esp_rx_frame_message::max_length)
+            continue;
+        esp_rx_frame_message msg{};
+        msg.rssi = frame.rssi;
+        msg.snr = frame.snr;
+        msg.length = frame.length;
+        memcpy(msg.frame, frame.data, frame.length);
+        sendMessage(msg);
+        ++rxForwarded;
+    }
+}
+
+/**
+ * @brief persists what is needed and restarts
+ */
+void restart()
+{
+    display.flush();
+    history.flush();
+    esp.restart();
+}
+
+/**
+ * @brief toggles the status LED
+ */
+void blinkJob()
+{
+    statusBlink = !statusBlink;
+    digitalWrite(settings.basic.green_led_pin, statusBlink);
+}
+
+/**
+ * @brief sends the aprs status messages (position and tlm-parameters)
+ */
+void aprsStatusJob()
+{
+#if SERIALDEBUG
+    Serial.println("{loop} aprs status timer reached.");
+#endif
+    lastAPRSStatus = scheduler.now();
+    requestRadio(radio_beacon);
+}
+
+/**
+ * @brief sends the aprs telemetry data
+ */
+void aprsDataJob()
+{
+#if SERIALDEBUG
+    Serial.println("{loop} aprs telemetry timer reached.");
+#endif
+    lastAPRSData = scheduler.now();
+    report.sent(lastAPRSData, display.snapshot());
+    requestRadio(radio_data);
+}
+
+void batteryJob()
+{
+    display.sampleBattery();
+}
+
+void displayJob()
+{
+    requestRedraw();
+}
+
+/**
+ * @brief no frame from the pc-compagnion within the keepalive interval
+ */
+void keepAliveJob()
+{
+    display.set_statusPCConnected(false);
+    display.set_statusUpLink(false);
+    display.set_statusEchoLink(false);
+    subscription.cancel();
+}
+
+SchedulerJob blink{"blink", blinkJob};
+SchedulerJob aprsStatus{"aprs status", aprsStatusJob};
+SchedulerJob aprsData{"aprs data", aprsDataJob};
+SchedulerJob historySample{"history", recordHistory};
+SchedulerJob batterySample{"battery", batteryJob};
+SchedulerJob displayRefresh{"display", displayJob};
+SchedulerJob keepAlive{"keepalive", keepAliveJob};
+SchedulerJob autoRestart{"restart", restart};
+
+/**
+ * @brief last step of a dht11 read, decodes the captured frame
+ */
+void climateFinishJob()
+{
+    display.finishClimate();
+}
+SchedulerJob climateFinish{"dht11 finish", climateFinishJob};
+
+/**
+ * @brief second step of a dht11 read, hands the line to the sensor
+ */
+void climateReleaseJob()
+{
+    display.releaseClimate();
+    scheduler.once(climateFinish, AsyncDht::frame_ms);
+}
+SchedulerJob climateRelease{"dht11 release", climateReleaseJob};
+
+/**
+ * @brief first step of a dht11 read, start signal
+ */
+void climateJob()
+{
+    display.sampleClimate();
+    scheduler.once(climateRelease, AsyncDht::start_ms);
+}
+SchedulerJob climateSample{"dht11", climateJob};
+
+/**
+ * @brief handles a message completed by the pc-compagnion frame parser
+ *
+ * @param message received message
+ */
+void handleMessage(const SerialMessage &message)
+{
+    // read the appropriate message and
+    // update the system accordingly
+    switch (message.command)
+    {
+    case pc_link_message::command:
+    {
+        pc_link_message msg;
+        if (!message.decode(msg))
+            break;
+        display.set_statusUpLink(msg.UplinkStatus);
+        display.set_statusEchoLink(msg.EcholinkStatus);
+    }
+    break;
+    case esp_get_keepAlive_message::command:
+        break;
+    case esp_get_message::command:
+    {
+        const auto data = display.snapshot();
+        esp_get_response_message rsp;
+        rsp.aprsPacketSeq = data.aprsPacketSeq;
+        rsp.intvoltage = data.intvoltage / 1000.0f;
+        rsp.battPercent = data.battPercent;
+        rsp.MAINSpower = (data.status & (1U << tlm_mainspower)) ? 1 : 0;
+        rsp.temperature = data.temperature / 10.0f;
+        rsp.humidity = data.humidity;
+        rsp.lastAPRSDataTime = (millis() - lastAPRSData) / 1000;
+        rsp.lastAPRSStatusTime = (millis() - lastAPRSStatus) / 1000;
+        sendMessage(rsp);
+    }
+    break;
+    case esp_get_airtime_message::command:
+    {
+        const auto stats = lora.airtimeStats();
+        esp_get_airtime_response_message rsp;
+        rsp.airtimeTotal = stats.total_ms;
+        rsp.airtimeWindow = stats.window_ms;
+        rsp.airtimeBudget = stats.budget_ms;
+        rsp.framesSent = stats.framesSent;
+        rsp.framesDeferred = stats.framesDeferred;
+        rsp.framesDropped = stats.framesDropped;
+        rsp.queueDepth = stats.queueDepth;
+        rsp.compressedFrames = stats.compressedFrames;
+        rsp.bytesSaved = stats.bytesSaved;
+        rsp.airtimeSaved = stats.airtimeSaved_ms;
+        sendMessage(rsp);
+    }
+    break;
+    case esp_get_rx_message::command:
+    {
+        const auto stats = lora.rxStats();
+        esp_get_rx_response_message rsp;
+        rsp.framesReceived = stats.framesReceived;
+        rsp.framesInvalid = stats.framesInvalid;
+        rsp.duplicates = stats.duplicates;
+        rsp.digipeated = stats.digipeated;
+        rsp.forwarded = rxForwarded;
+        rsp.poolDrops = stats.poolDrops;
+        rsp.cacheEntries = stats.cacheEntries;
+        rsp.cacheCapacity = stats.cacheCapacity;
+        rsp.cacheEvictions = stats.cacheEvictions;
+        rsp.memory = stats.memory;
+        rsp.receive = stats.receive ? 1 : 0;
+        rsp.digipeat = stats.digipeat ? 1 : 0;
+        sendMessage(rsp);
+    }
+    break;
+    case esp_set_radio_message::command:
+    {
+        esp_set_radio_message msg;
+        if (!message.decode(msg))
+            break;
+        requestRadio(msg.digipeat ? radio_digipeat : msg.receive ? radio_receive : radio_silent);
+    }
+    break;
+    case esp_get_display_message::command:
+    {
+        const auto stats = display.stats();
+        esp_get_display_response_message rsp;
+        rsp.redraws = stats.redraws;
+        rsp.redrawsSkipped = stats.skipped;
+        rsp.framesDropped = stats.frames.dropped;
+        rsp.flushLatencyP99 = stats.frames.latencyP99;
+        rsp.flushLatencyMax = stats.frames.latencyMax;
+        rsp.flushes = stats.panel.flushes;
+        rsp.flushesUnchanged = stats.panel.unchanged;
+        rsp.windows = stats.panel.windows;
+        rsp.bytes = stats.panel.bytes;
+        sendMessage(rsp);
+    }
+    break;
+    case esp_get_idle_message::command:
+    {
+        const auto stats = idle.stats();
+        esp_get_idle_response_message rsp;
+        rsp.uptime = stats.uptime_ms;
+        rsp.idleTime = stats.idle_ms;
+        rsp.waits = stats.waits;
+        rsp.lightSleeps = stats.lightSleeps;
+        rsp.wakeTimer = stats.wakeTimer;
+        rsp.wakeUart = stats.wakeUart;
+        rsp.wakePower = stats.wakePower;
+        rsp.wakeRadio = stats.wakeRadio;
+        rsp.dutyCycle = stats.dutyCycle;
+        sendMessage(rsp);
+    }
+    break;
+    case esp_get_tasks_message::command:
+    {
+#if DUALCORE
+        const TaskMonitor *monitors[] = {&radioMonitor, &displayMonitor, &pcMonitor, &loopMonitor};
+#else
+        const TaskMonitor *monitors[] = {&loopMonitor};
+#endif
+        esp_get_tasks_response_message rsp{};
+        for (const auto monitor : monitors)
+        {
+            auto &task = rsp.tasks[rsp.count++];
+            const auto name = monitor->name();
+            memcpy(task.name, name, strnlen(name, sizeof(task.name))); // not terminated if it fills the field
+            task.stackFree = monitor->stackFree();
+            task.worstLatency = monitor->worstLatency();
+            task.runs = monitor->runs();
+        }
+        sendMessage(rsp);
+    }
+    break;
+    case esp_subscribe_message::command:
+    {
+        esp_subscribe_message msg;
+        if (!message.decode(msg))
+            break;
+        subscription.configure(msg);
+    }
+    break;
+    case esp_get_history_message::command:
+    {
+        esp_get_history_message msg;
+        if (!message.decode(msg))
+            break;
+        historyQuery = history.query(msg.from, msg.to);
+        historyQueryActive = true;
+    }
+    break;
+#if LOOPPROBES
+    case esp_get_probes_message::command:
+    {
+        esp_get_probes_message msg;
+        if (!message.decode(msg))
+            break;
+        static_assert(esp_get_probes_response_message::max_buckets == LatencyHistogram::buckets, "probe buckets");
+        for (uint8_t stage = 0; stage < probe_stages; ++stage)
+        {
+            const auto &histogram = LoopProbes::histogram(static_cast<ProbeStage>(stage));
+            esp_get_probes_response_message rsp{};
+            const auto name = LoopProbes::name(static_cast<ProbeStage>(stage));
+            memcpy(rsp.name, name, strnlen(name, sizeof(rsp.name))); // not terminated if it fills the field
+            rsp.stage = stage;
+            rsp.last = stage == probe_stages - 1 ? 1 : 0;
+            rsp.count = histogram.count();
+            rsp.min = histogram.min();
+            rsp.max = histogram.max();
+            rsp.p99 = histogram.percentile(990);
+            for (size_t i = 0; i < LatencyHistogram::buckets; ++i)
+                rsp.buckets[i] = histogram.bucket(i);
+            sendMessage(rsp);
+        }
+        if (msg.reset)
+            LoopProbes::reset();
+    }
+    break;
+#endif
+    case esp_get_serial_message::command:
+    {
+        const auto stats = pcOutput.stats();
+        esp_get_serial_response_message rsp{};
+        rsp.frames = stats.frames;
+        rsp.framesDropped = stats.framesDropped;
+        rsp.bytesDropped = stats.bytesDropped;
+        rsp.writes = stats.writes;
+        rsp.queued = stats.queued;
+        rsp.highWater = stats.highWater;
+        rsp.capacity = stats.capacity;
+        sendMessage(rsp);
+    }
+    break;
+    case esp_get_reboot_message::command:
+        restart();
+        break;
+    default:
+        // unknown command, the frame was valid so just ignore it
+        break;
+    }
+}
+
+#if DUALCORE
+/**
+ * @brief radio task on core 0: telemetry encoding and the tx queue
+ */
+void radioTask(void *)
+{
+    for (;;)
+    {
+        radioMonitor.pass();
+        RadioRequest request;
+        while (radioQueue.pop(request))
+        {
+            radioMonitor.served(request.enqueued);
+            serveRadio(request);
+        }
+        lora.service();
+
+        long timeout = static_cast<long>(lora.nextDeadline() - millis());
+        if (lora.queue().inFlight() && timeout > static_cast<long>(radio_poll_ms))
+            timeout = radio_poll_ms;
+        timeout = timeout < 1 ? 1 : timeout > 1000 ? 1000 : timeout;
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(timeout));
+    }
+}
+
+/**
+ * @brief display task, sends the newest frame to the panel on request
+ */
+void displayTask(void *)
+{
+    for (;;)
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        uint32_t enqueued;
+        bool flush = false;
+        while (displayQueue.pop(enqueued))
+        {
+            displayMonitor.served(enqueued);
+            flush = true;
+        }
+        if (!flush)
+            continue;
+        displayMonitor.pass();
+        display.refresh();
+    }
+}
+
+/**
+ * @brief pc link task, parses frames and hands complete messages to the loop
+ */
+void pcTask(void *)
+{
+    static SerialMessage message;
+    for (;;)
+    {
+        pcMonitor.pass();
+        while (Serial.available())
+        {
+            if (!pcLink.feed(Serial.read()))
+                continue;
+            pcLink.message(message);
+            message.enqueued = micros();
+            if (pcInbox.push(message))
+                IdleWait::wake(idle_wake_uart);
+        }
+        vTaskDelay(pdMS_TO_TICKS(pc_poll_ms));
+    }
+}
+#endif
 
 void setup()
 {
@@ -64,156 +609,181 @@ void setup()
 #if SERIALDEBUG
     Serial.println("{setup} Display data");
 #endif
-    display.updateData();
+    display.acquire();
     display.displayData();
+    display.refresh();
 
 #if SERIALDEBUG
     Serial.println("{setup} tx_telemetry_beacon");
 #endif
-    tmrAPRSsendStatus.stamp = millis();
+    lastAPRSStatus = millis();
     lora.tx_telemetry_beacon(display);
-#if SERIALDEBUG
-    Serial.println("{setup} tx_telemetry_data");
-#endif
-    tmrAPRSsendData.stamp = millis();
-    lora.tx_telemetry_data(display);
 #if SERIALDEBUG
     Serial.println("{setup} Startup finished.");
 #endif
+    history.init();
     display.reset_statusChanged();
-}
 
-void loop()
-{
+    // the first telemetry data and history sample wait for the first dht11 frame
+    const auto firstClimate = AsyncDht::power_up_ms + AsyncDht::start_ms + AsyncDht::frame_ms + 2 * Scheduler::tick;
+    scheduler.every(blink, 1000);
+    scheduler.every(aprsStatus, settings.tlm.status_interval * 60 * 1000, settings.tlm.status_interval * 60 * 1000);
+    scheduler.every(aprsData, settings.tlm.beacon_interval * 60 * 1000, firstClimate);
+    scheduler.every(historySample, settings.tlm.history_interval * 1000, firstClimate);
+    scheduler.every(batterySample, settings.tlm.battery_interval * 1000, settings.tlm.battery_interval * 1000);
+    scheduler.every(climateSample, settings.tlm.dht11_interval * 1000, AsyncDht::power_up_ms);
+    scheduler.every(displayRefresh, settings.basic.display_interval, settings.basic.display_interval);
+    scheduler.once(keepAlive, KeepAliveInterval);
     // auto restart in case something unexpected happens
-    if (millis() > 23L * 59L * 60L * 1000L)
-        esp.restart();
-
-    currentTime = millis();
+    scheduler.once(autoRestart, 23L * 59L * 60L * 1000L);
+#if IDLEWAIT
+    idle.init();
+#endif
+    loopMonitor.attachCurrent();
+#if LOOPPROBES
+    LoopProbes::init();
+#endif
+#if DUALCORE
+    TaskHandle_t handle;
+    xTaskCreatePinnedToCore(radioTask, "radio", task_stack, nullptr, 2, &handle, 0);
+    radioMonitor.attach(handle);
+    xTaskCreatePinnedToCore(displayTask, "display", task_stack, nullptr, 1, &handle, 1);
+    displayMonitor.attach(handle);
+    xTaskCreatePinnedToCore(pcTask, "pc", task_stack, nullptr, 1, &handle, 1);
+    pcMonitor.attach(handle);
+#endif
+}
 
-    // blink status LED
-    if (currentTime - statusBlink.stamp >= statusBlink.duration)
+/**
+ * @brief feeds the pc-compagnion link and handles completed messages
+ */
+void receivePc()
+{
+    PROBE(probe_serial);
+#if DUALCORE
+    // messages parsed by the pc task
+    while (pcInbox.pop(pcMessage))
     {
-        statusBlink.stamp = currentTime;
-        statusBlink.state = !statusBlink.state;
-        digitalWrite(settings.basic.green_led_pin, statusBlink.state);
+        loopMonitor.served(pcMessage.enqueued);
+        scheduler.once(keepAlive, KeepAliveInterval);
+        display.set_statusPCConnected(true);
+        handleMessage(pcMessage);
     }
-
-#if SERIALDATA
+#else
     // serial communication with pc-compagnion
-    // look for incoming serial packets
-    while (Serial.available() >= sizeof(uint32_t))
+    // feed incoming bytes to the frame parser, a corrupted frame only costs that frame
+    while (Serial.available())
     {
-        lastSerialPacketReceived = currentTime;
-        display.set_statusPCConnected(true);
-        auto cmd = uint32_t{};
-        // read the command
-        if (sizeof(cmd) == Serial.read(( uint8_t * )&cmd, sizeof(cmd)))
-        {
-            // read the appropriate message and
-            // update the system accordingly
-            switch (cmd)
-            {
-            case pc_link_message::command:
-            {
-                pc_link_message msg;
-                Serial.read(( uint8_t * )&msg, sizeof(msg));
-                display.set_statusUpLink(msg.UplinkStatus);
-                display.set_statusEchoLink(msg.EcholinkStatus);
-            }
-            break;
-            case esp_get_keepAlive_message::command:
-            {
-                esp_get_keepAlive_message msg;
-                Serial.read(( uint8_t * )&msg, sizeof(msg));
-            }
-            break;
-            case esp_get_message::command:
-            {
-                esp_get_message msg;
-                Serial.read(( uint8_t * )&msg, sizeof(msg));
-                esp_get_response_message rsp;
-                display.updateData();
-                rsp.aprsPacketSeq = display.get_aprsPacketSeq();
-                rsp.intvoltage = display.get_intVoltage();
-                rsp.battPercent = display.get_battPercent();
-                rsp.MAINSpower = display.get_statusMainsPower() ? 1 : 0;
-                rsp.temperature = display.get_temperature();
-                rsp.humidity = display.get_humidity();
-                rsp.lastAPRSDataTime = (millis() - tmrAPRSsendData.stamp) / 1000;
-                rsp.lastAPRSStatusTime = (millis() - tmrAPRSsendStatus.stamp) / 1000;
-                cmd = esp_get_response_message::command;
-                while (!Serial.availableForWrite())
-                {
-                    delay(1);
-                }
-                Serial.write(( uint8_t * )&cmd, sizeof(cmd));
-                while (!Serial.availableForWrite())
-                {
-                    delay(1);
-                }
-                Serial.write(( uint8_t * )&rsp, sizeof(rsp));
-            }
-            break;
-            case esp_get_reboot_message::command:
-            {
-                esp_get_reboot_message msg;
-                Serial.read(( uint8_t * )&msg, sizeof(msg));
-                esp.restart();
-            }
-            break;
-            default:
-                // junk. consume what we didn't read
-                while (Serial.available())
-                    Serial.read();
-                break;
-            }
-        }
-        else
+        if (pcLink.feed(Serial.read()))
         {
-            // junk. consume what we didn't read
-            while (Serial.available())
-                Serial.read();
+            pcLink.message(pcMessage);
+            scheduler.once(keepAlive, KeepAliveInterval);
+            display.set_statusPCConnected(true);
+            handleMessage(pcMessage);
         }
     }
 #endif
+}
 
-    if (currentTime - lastSerialPacketReceived >= KeepAliveInterval)
-    {
-        display.set_statusPCConnected(false);
-        display.set_statusUpLink(false);
-        display.set_statusEchoLink(false);
-    }
-    display.updateData();
+/**
+ * @brief one pass of the main loop, everything but the idle wait
+ */
+void loopPass()
+{
+    PROBE(probe_loop);
+    currentTime = millis();
+    loopMonitor.pass();
 
-    // send aprs status messages (position and tlm-parameters)
-    if (currentTime - tmrAPRSsendStatus.stamp >= tmrAPRSsendStatus.duration)
-    {
-#if SERIALDEBUG
-        Serial.println("{loop} aprs status timer reached.");
+    // run the periodic jobs which are due
+    scheduler.run();
+
+#if !DUALCORE
+    // feed queued aprs frames to the radio
+    lora.service();
+    // one page of a pending display frame, a redraw during the flush replaces the frame waiting behind it
+    display.refreshPage();
 #endif
-        tmrAPRSsendStatus.stamp = currentTime;
-        lora.tx_telemetry_beacon(display);
-    }
-    // send aprs telemetry data
-    if (currentTime - tmrAPRSsendData.stamp >= tmrAPRSsendData.duration)
-    {
-#if SERIALDEBUG
-        Serial.println("{loop} aprs telemetry timer reached.");
+
+#if SERIALDATA
+    receivePc();
+#endif
+
+    display.acquire();
+
+#if SERIALDATA
+    // push changes to a subscribed pc-compagnion
+    esp_delta_message delta;
+    if (subscription.poll(currentTime, display.snapshot(), delta))
+        sendMessage(delta);
+    // stream a requested history range, one chunk per pass as long as the output keeps up
+    if (historyQueryActive && pcOutput.room() >= SerialProtocol::max_frame)
+        sendHistoryChunk();
+    forwardReceived();
+    // what the uart takes now, the rest on the next passes
+    pcOutput.drain();
 #endif
-        tmrAPRSsendData.stamp = currentTime;
-        lora.tx_telemetry_data(display);
-    }
 
     if (display.get_statusChanged())
     {
         display.reset_statusChanged();
-        display.displayData();
-        tmrAPRSsendStatus.stamp = currentTime;
-        lora.tx_telemetry_data(display);
+        // running on battery from now on, don't leave the aprs sequence uncommitted
+        if (!display.get_statusMainsPower())
+            display.flush();
+        requestRedraw();
+        recordHistory();
+    }
+
+    // a telemetry frame only for changes which outlast their hold time or deadband, the heartbeat starts over
+    const auto data = display.snapshot();
+    if (report.poll(currentTime, data))
+    {
+        lastAPRSData = currentTime;
+        scheduler.restart(aprsData);
+        report.sent(currentTime, data);
+        requestRadio(radio_data, tx_priority_status);
     }
-    if (currentTime % 50)
+}
+
+#if IDLEWAIT
+/**
+ * @brief idle wait of the loop task
+ */
+void waitNextDeadline()
+{
+#if DUALCORE
+    // the radio task serves the radio, the other tasks keep running so no light sleep
+    if ((historyQueryActive && pcOutput.room() >= SerialProtocol::max_frame) || !pcInbox.empty())
+        return;
+    auto deadline = scheduler.nextDeadline();
+    for (const auto next : {subscription.nextDeadline(currentTime), report.nextDeadline(currentTime),
+                            pcOutput.nextDeadline(currentTime)})
     {
-        display.displayData();
+        if (static_cast<long>(next - deadline) < 0)
+            deadline = next;
     }
+    idle.wait(deadline, false);
+#else
+    // sleep until the next job, radio, subscription, report or serial output deadline unless something is left to do
+    if ((historyQueryActive && pcOutput.room() >= SerialProtocol::max_frame) || Serial.available() ||
+        display.flushing())
+        return;
+    auto deadline = scheduler.nextDeadline();
+    for (const auto next : {lora.nextDeadline(), subscription.nextDeadline(currentTime),
+                            report.nextDeadline(currentTime), pcOutput.nextDeadline(currentTime)})
+    {
+        if (static_cast<long>(next - deadline) < 0)
+            deadline = next;
+    }
+    idle.wait(deadline,
+              !display.get_statusPCConnected() && !lora.busy() && !dht.busy() && !pcOutput.queued());
+#endif
+}
+#endif
+
+void loop()
+{
+    loopPass();
+#if IDLEWAIT
+    waitNextDeadline();
+#endif
 }
@@ -1,7 +1,9 @@
 #include <Arduino.h>
 #include <Wire.h>
 #include <hb9gl.h>
+#include <idle.h>
 #include <mylora.h>
+#include <probe.h>
 
 #define LORA true         // enable LoRa tx
 #define SERIALDEBUG false // use usb/serial for debug instead communication with PC-Compagnion
@@ -28,71 +30,375 @@ void MyLora::init()
     setSpreadingFactor(m_settings.lora.SpreadingFactor);
     setSignalBandwidth(m_settings.lora.SignalBandwidth);
     setCodingRate4(m_settings.lora.CodingRate4);
+    setPreambleLength(m_settings.lora.PreambleLength);
     enableCrc();
     setTxPower(m_settings.lora.TxPower);
+
+    const auto &tlm = m_settings.tlm;
+    m_position.encode(tlm.latitude, tlm.longitude, tlm.altitude, tlm.symbol_table, tlm.symbol_code,
+                      tlm.compressed_position);
+
+    // endPacket(true) only maps DIO0 to TXDONE when a tx done callback is registered, receive() to RXDONE
+    // likewise. the library's own dio0 isr talks SPI via the global LoRa instance, so replace it by ours.
+    onTxDone(onTxDoneDummy);
+    onReceive(onRxDoneDummy);
+    detachInterrupt(digitalPinToInterrupt(m_settings.lora.DIO0_pin));
+    attachInterrupt(digitalPinToInterrupt(m_settings.lora.DIO0_pin), onDio0, RISING);
+
     delay(3000);
-    sleep();
+    park();
+    publish_stats();
 }
 
 
+volatile bool MyLora::s_dio0Raised = false;
+
 /**
- * @brief transmit aprs string
+ * @brief DIO0 (tx or rx done) interrupt, only flags the event, the SPI work is done in service()
+ */
+void IRAM_ATTR MyLora::onDio0()
+{
+    s_dio0Raised = true;
+    IdleWait::wakeFromIsr(idle_wake_radio);
+}
+
+void MyLora::onTxDoneDummy()
+{
+}
+
+void MyLora::onRxDoneDummy(int size)
+{
+}
+
+
+/**
+ * @brief drives the tx queue and the receive path, call on every loop() pass. never blocks on the radio.
+ * @note the task that calls it owns the radio, the radio task in DUALCORE mode. it publishes the counters for
+ * airtimeStats() and rxStats() after every pass.
+ */
+void MyLora::service()
+{
+    PROBE(probe_radio);
+    serve_queue();
+    publish_stats();
+}
+
+/**
+ * @brief one pass of the tx queue and the receive path
+ * @note completes the in flight frame after the DIO0 tx done interrupt and starts the next queued one
+ * @note the most urgent frame is deferred while it would exceed the duty cycle budget
+ * @note in receive mode DIO0 without a frame in flight is rx done
+ */
+void MyLora::serve_queue()
+{
+    const auto currentTime = millis();
+    if (m_queue.inFlight())
+    {
+        if (!s_dio0Raised && currentTime - m_txStartTime < m_txTimeout)
+            return;
+        s_dio0Raised = false;
+        // also clears the tx done irq flag
+        if (isTransmitting())
+            return;
+        m_queue.complete_tx();
+    }
+    else if (s_dio0Raised && m_parked && m_receive)
+    {
+        s_dio0Raised = false;
+        take_rx();
+    }
+
+    auto next = m_queue.peek();
+    if (next)
+    {
+        const auto airtime = m_airtime.frame_ms(header_length + next->length);
+        if (m_budget.allows(currentTime, airtime))
+        {
+            m_deferring = false;
+            m_budget.charge(currentTime, airtime);
+            m_airtimeTotal += airtime;
+            m_txTimeout = airtime + 1000;
+            start_tx(*m_queue.begin_tx());
+            return;
+        }
+        if (!m_deferring || next->order != m_deferredOrder)
+        {
+#if SERIALDEBUG
+            Serial.println("duty cycle budget exhausted, frame deferred");
+#endif
+            m_deferring = true;
+            m_deferredOrder = next->order;
+            ++m_deferrals;
+        }
+    }
+    if (!m_parked)
+    {
+        park();
+        digitalWrite(m_settings.basic.green_led_pin, LOW);
+    }
+}
+
+/**
+ * @brief switches the receive path, a parked radio at once, one with a frame in flight after tx done
  *
- * @param tx_data string to tx
+ * @param receive listen between transmissions
+ * @param digipeat repeat frames for our callsign or a WIDEn-N alias, implies receive
  */
-void MyLora::tx(String tx_data)
+void MyLora::mode(bool receive, bool digipeat)
+{
+    m_receive = receive || digipeat;
+    m_digipeat = digipeat;
+    if (m_parked)
+        park();
+}
+
+/**
+ * @brief takes the radio off the air: continuous receive in receive mode, sleep otherwise
+ */
+void MyLora::park()
+{
+    setFrequency(m_settings.lora.frequency);
+    if (m_receive)
+        receive();
+    else
+        sleep();
+    m_parked = true;
+}
+
+/**
+ * @brief copies a received frame into the pool unless it is a duplicate, queues the digipeated copy
+ * @note the radio listens again before the frame is looked at
+ */
+void MyLora::take_rx()
+{
+    PROBE(probe_receive);
+    RxFrame frame;
+    frame.length = 0;
+    // 0 after a crc error
+    const auto length = parsePacket();
+    if (length > static_cast<int>(header_length) && length - header_length <= TxFrame::max_length)
+    {
+        uint8_t header[header_length];
+        for (auto &byte : header)
+            byte = static_cast<uint8_t>(read());
+        if (header[0] == '<' && header[1] == 0xFF && header[2] == 0x01)
+        {
+            frame.length = static_cast<uint8_t>(length - header_length);
+            for (size_t i = 0; i < frame.length; ++i)
+                frame.data[i] = static_cast<uint8_t>(read());
+        }
+    }
+    frame.rssi = static_cast<int16_t>(packetRssi());
+    frame.snr = packetSnr();
+    receive();
+
+    if (!frame.length)
+    {
+        ++m_rxInvalid;
+        return;
+    }
+    ++m_rxFrames;
+    if (m_dupes.seen(DupeCache::digest(frame.data, frame.length), millis()))
+    {
+        ++m_duplicates;
+        return;
+    }
+    AprsFrame repeat;
+    if (m_digipeat && m_digipeater.rewrite(frame.data, frame.length, repeat))
+    {
+        ++m_digipeated;
+        tx(repeat, tx_priority_digipeat);
+    }
+    m_rxPool.push(frame);
+}
+
+
+/**
+ * @brief hands a frame to the radio and returns without waiting for tx done
+ *
+ * @param frame frame to tx
+ */
+void MyLora::start_tx(const TxFrame &frame)
 {
 #if SERIALDEBUG
-    Serial.println("Function called: tx_lora");
+    Serial.print("TX: ");
+    Serial.write(frame.data, frame.length);
+    Serial.println();
 #endif
     digitalWrite(m_settings.basic.green_led_pin, HIGH);
-#if LORA
+    m_parked = false;
+    s_dio0Raised = false;
     setFrequency(m_settings.lora.frequency);
     beginPacket();
     write('<');
     write(0xFF);
     write(0x01);
+    write(frame.data, frame.length);
+    m_txStartTime = millis();
+    endPacket(true);
+}
+
+
+/**
+ * @brief queue a frame for transmission
+ *
+ * @param data aprs payload
+ * @param length payload length
+ * @param priority transmit priority
+ */
+void MyLora::enqueue(const uint8_t *data, size_t length, TxPriority priority)
+{
+    // our own frames heard back from other digipeaters are duplicates
+    if (m_receive)
+        m_dupes.seen(DupeCache::digest(data, length), millis());
+    if (!m_queue.push(data, length, priority))
+    {
 #if SERIALDEBUG
-    Serial.println("TX: " + tx_data);
+        Serial.println("tx queue full, frame dropped");
 #endif
-    write(( const uint8_t * )tx_data.c_str(), tx_data.length());
-    endPacket();
-    setFrequency(m_settings.lora.frequency);
-    sleep();
-#endif
-    digitalWrite(m_settings.basic.green_led_pin, LOW);
+    }
 }
 
 
 /**
- * @brief transmit aprs data
+ * @brief true while frames are queued or in flight, or the radio listens
+ */
+bool MyLora::busy() const
+{
+    return !m_queue.empty() || m_receive;
+}
+
+/**
+ * @brief latest time service() has to run again without being woken by DIO0
  *
- * @tparam T
- * @param tx_data data to tx
+ * @return unsigned long [ms] absolute millis() time, far ahead if the radio is idle
  */
-template <typename T>
-void MyLora::tx(T tx_data)
+unsigned long MyLora::nextDeadline() const
+{
+    const auto currentTime = millis();
+    if (m_queue.inFlight())
+        return m_txStartTime + m_txTimeout;
+    if (m_deferring)
+        return currentTime + deferral_retry;
+    return currentTime + 24UL * 60 * 60 * 1000;
+}
+
+const TxQueue &MyLora::queue() const
+{
+    return m_queue;
+}
+
+/**
+ * @brief publishes the counters of the radio owner for the other tasks
+ * @note AirtimeBudget::used() rotates the duty cycle buckets, so only the owner may compute the window
+ */
+void MyLora::publish_stats()
+{
+    AirtimeStats airtime;
+    airtime.total_ms = m_airtimeTotal;
+    airtime.window_ms = m_budget.used(millis());
+    airtime.budget_ms = m_budget.budget();
+    airtime.framesSent = m_queue.sent();
+    airtime.framesDeferred = m_deferrals;
+    airtime.framesDropped = m_queue.drops();
+    airtime.queueDepth = m_queue.depth();
+    airtime.compressedFrames = m_compressedFrames;
+    airtime.bytesSaved = m_bytesSaved;
+    airtime.airtimeSaved_ms = m_airtimeSaved;
+    m_airtimeStats.write(airtime);
+
+    RxStats rx;
+    rx.framesReceived = m_rxFrames;
+    rx.framesInvalid = m_rxInvalid;
+    rx.duplicates = m_duplicates;
+    rx.digipeated = m_digipeated;
+    rx.poolDrops = m_rxPool.drops();
+    rx.cacheEntries = m_dupes.size(millis());
+    rx.cacheCapacity = DupeCache::capacity;
+    rx.cacheEvictions = m_dupes.evictions();
+    rx.memory = sizeof(m_rxPool) + sizeof(m_dupes);
+    rx.receive = m_receive;
+    rx.digipeat = m_digipeat;
+    m_rxStats.write(rx);
+}
+
+/**
+ * @brief airtime counters as of the last service() pass, from any task
+ *
+ * @return AirtimeStats
+ */
+AirtimeStats MyLora::airtimeStats() const
+{
+    return m_airtimeStats.read();
+}
+
+/**
+ * @brief next unique frame heard on the air
+ *
+ * @param frame received frame
+ * @return false if none is waiting
+ */
+bool MyLora::received(RxFrame &frame)
+{
+    return m_rxPool.pop(frame);
+}
+
+/**
+ * @brief receive path counters as of the last service() pass, from any task
+ *
+ * @return RxStats
+ */
+RxStats MyLora::rxStats() const
+{
+    return m_rxStats.read();
+}
+
+/**
+ * @brief time on air of an aprs frame with the current radio settings
+ *
+ * @param length aprs payload length
+ * @return uint32_t [ms]
+ */
+uint32_t MyLora::airtime_ms(size_t length) const
+{
+    return m_airtime.frame_ms(header_length + length);
+}
+
+
+/**
+ * @brief queue aprs frame for transmission
+ *
+ * @param data frame bytes
+ * @param length frame length
+ * @param priority transmit priority
+ */
+void MyLora::tx(const uint8_t *data, size_t length, TxPriority priority)
 {
 #if SERIALDEBUG
     Serial.println("Function called: tx_lora");
 #endif
-
-    digitalWrite(m_settings.basic.green_led_pin, HIGH);
 #if LORA
-    setFrequency(m_settings.lora.frequency);
-    beginPacket();
-    write('<');
-    write(0xFF);
-    write(0x01);
-#if SERIALDEBUG
-    Serial.println("TX: " + tx_data);
+    enqueue(data, length, priority);
 #endif
-    write(( const uint8_t * )tx_data.c_str(), tx_data.length());
-    endPacket();
-    setFrequency(m_settings.lora.frequency);
-    sleep();
+}
+
+
+/**
+ * @brief queue encoded aprs frame for transmission
+ *
+ * @param frame encoded frame, dropped if it did not fit into the buffer
+ * @param priority transmit priority
+ */
+void MyLora::tx(const AprsFrame &frame, TxPriority priority)
+{
+    if (frame.overflow())
+    {
+#if SERIALDEBUG
+        Serial.println("aprs frame overflow, frame dropped");
 #endif
-    digitalWrite(m_settings.basic.green_led_pin, LOW);
+        return;
+    }
+    tx(frame.data(), frame.length(), priority);
 }
 
 
@@ -106,49 +412,58 @@ void MyLora::tx_telemetry_beacon(Display &display)
 #endif
 
 #if LORA
+    const auto callsign = m_settings.tlm.callsign.c_str();
+    const auto destcall = m_settings.tlm.destcall.c_str();
+    AprsFrame beacon;
 
     // send the status of HB9GL (root)
-    // String beacon = String("HB9GL-0") + ">" + String(m_settings.tlm.destcall.c_str()) + ":!" +
-    //                 String(m_settings.tlm.lat.c_str()) + "/" + String(m_settings.tlm.lon.c_str()) + "r" +
-    //                 String(m_settings.tlm.comment.c_str()).substring(0, 43) + "/A=" + String(m_settings.tlm.alt.c_str());
-    // tx_lora(beacon);
-
-    // send status of current station
-    String beacon = String(m_settings.tlm.callsign.c_str()) + ">" + String(m_settings.tlm.destcall.c_str()) + ":!" +
-                    String(m_settings.tlm.lat.c_str()) + "/" + String(m_settings.tlm.lon.c_str()) + "r" +
-                    String(m_settings.tlm.comment.c_str()).substring(0, 43) +
-                    "/A=" + String(m_settings.tlm.alt.c_str());
-    tx(beacon);
+    // beacon.header("HB9GL-0", destcall)
+    //     .append('!')
+    //     .append(m_position.position())
+    //     .append(m_settings.tlm.comment.c_str(), 43)
+    //     .append(m_position.altitude());
+    // tx(beacon);
 
-    /**
-     * @brief set APRS telemetry parameters/titles
-     * @note the 6 analog channels
-     * @note then up to 8 digital channels
-     */
-    beacon = String(m_settings.tlm.callsign.c_str()) + ">" + String(m_settings.tlm.destcall.c_str()) +
-             "::" + rpad(m_settings.tlm.callsign, 9).c_str() +
-             ":PARM.Vbatt,Capacity,Temperature,Humidity,,USBPower,240V,PCconn,Uplink,Echolink";
-    tx(beacon);
+    // send status of current station, the position was encoded in init()
+    beacon.header(callsign, destcall)
+        .append('!')
+        .append(m_position.position())
+        .append(m_settings.tlm.comment.c_str(), 43)
+        .append(m_position.altitude());
+    tx(beacon, tx_priority_position);
 
     /**
-     * @brief set APRS telemetry parameters/units
-     * @note first the 6 analog channels
-     * @note then up to 8 digital channels
+     * @brief set APRS telemetry parameters/titles, units, equations and bit sense
+     * @note texts are generated at compile time from the TelemetryTable
      */
-    beacon = String(m_settings.tlm.callsign.c_str()) + ">" + String(m_settings.tlm.destcall.c_str()) +
-             "::" + rpad(m_settings.tlm.callsign, 9).c_str() + ":UNIT.Vdc,%,Celsius,%,,UP,UP,UP,UP,UP";
-    tx(beacon);
+    for (const char *text : {telemetry_parm.text, telemetry_unit.text, telemetry_eqns.text, telemetry_bits.text})
+    {
+        beacon.clear();
+        beacon.header(callsign, destcall).message(callsign).append(text);
+        tx(beacon, tx_priority_metadata);
+    }
+#endif
+}
 
-    /**
-     * @brief set APRS telemetry parameters/equations for the 6 analog channels
-     */
-    beacon = String(m_settings.tlm.callsign.c_str()) + ">" + String(m_settings.tlm.destcall.c_str()) +
-             "::" + rpad(m_settings.tlm.callsign, 9).c_str() + ":EQNS.0,0.01,2.5,0,1,0,0,1,-100,0,1,0";
-    tx(beacon);
 
-    beacon = String(m_settings.tlm.callsign.c_str()) + ">" + String(m_settings.tlm.destcall.c_str()) +
-             "::" + rpad(m_settings.tlm.callsign, 9).c_str() + ":BITS.HB9GL-R telemetry by HB9HDG";
-    tx(beacon);
+/**
+ * @brief accounts the bytes and airtime a compressed telemetry frame saved
+ *
+ * @param compressed frame sent
+ * @param plain same telemetry as T# frame
+ */
+void MyLora::count_saving(const AprsFrame &compressed, const AprsFrame &plain)
+{
+    const auto saved = static_cast<uint32_t>(plain.length() - compressed.length());
+    const auto airtimeSaved = airtime_ms(plain.length()) - airtime_ms(compressed.length());
+    ++m_compressedFrames;
+    m_bytesSaved += saved;
+    m_airtimeSaved += airtimeSaved;
+#if SERIALDEBUG
+    Serial.print("compressed telemetry saved bytes: ");
+    Serial.print(saved);
+    Serial.print(" airtime [ms]: ");
+    Serial.println(airtimeSaved);
 #endif
 }
 
@@ -156,79 +471,50 @@ void MyLora::tx_telemetry_beacon(Display &display)
 /**
  * @brief send APRS telemetry data
  *
+ * @param sequence aprs sequence number, counted by the loop task
+ * @param priority tx_priority_status if triggered by a status change
  */
-void MyLora::tx_telemetry_data(Display &display)
+void MyLora::tx_telemetry_data(Display &display, uint8_t sequence, TxPriority priority)
 {
+    PROBE(probe_telemetry);
 #if SERIALDEBUG
     Serial.println("Function called: tx_telemetry_data");
 #endif
 
 
-    display.inc_aprsPacketSeq();
+    const auto data = display.snapshot();
 
-    //write aprs sequence to eeprom
-    EEPROM.write(m_settings.basic.EEPROMaddress, display.get_aprsPacketSeq());
-    EEPROM.commit();
+    float values[tlm_analog_count];
+    values[tlm_vbatt] = data.intvoltage / 1000.0f;
+    values[tlm_capacity] = data.battPercent;
+    values[tlm_temperature] = data.temperature / 10.0f;
+    values[tlm_humidity] = data.humidity;
+    int analog[tlm_analog_count];
+    for (size_t i = 0; i < tlm_analog_count; ++i)
+        analog[i] = TelemetryTable::encode(static_cast<TelemetryAnalogId>(i), values[i]);
 
-    auto txaprsPacketSeq = std::to_string(display.get_aprsPacketSeq());
-    auto txvoltage =
-        std::to_string(static_cast<int>(round((display.get_intVoltage() - 2.5) / (2.5 / 255))));     // EQN: 0,0.01,2.5
-    auto txbattPercent = std::to_string(display.get_battPercent());                                  // EQN: 0,1,0
-    auto txtemperature = std::to_string(static_cast<int>(round((display.get_temperature() + 100)))); // EQN: 0,1,-100
-    auto txhumidity = std::to_string(static_cast<int>(round(display.get_humidity())));               // EQN: 0,1,0
-
-    std::string txbits = "00000"; // bits for each of the digital telemetry channels
-    txbits[0] = display.get_statusPCUSBpower() ? '1' : '0';
-    txbits[1] = display.get_statusMainsPower() ? '1' : '0';
-    txbits[2] = display.get_statusPCConnected() ? '1' : '0';
-    txbits[3] = display.get_statusUpLink() ? '1' : '0';
-    txbits[4] = display.get_statusEchoLink() ? '1' : '0';
-
-    auto beacon = m_settings.tlm.callsign + ">" + m_settings.tlm.destcall + ":T#" + lpad(txaprsPacketSeq, 3, '0') +
-                  "," + lpad(txvoltage, 3, '0') + "," + lpad(txbattPercent, 3, '0') + "," +
-                  lpad(txtemperature, 3, '0') + "," + lpad(txhumidity, 3, '0') + ",," + txbits;
+    // the snapshot status bits are already in digital channel order
+    const auto callsign = m_settings.tlm.callsign.c_str();
+    const auto destcall = m_settings.tlm.destcall.c_str();
+    AprsFrame beacon;
+    beacon.header(callsign, destcall).telemetry(sequence, analog, tlm_analog_count, data.status, tlm_digital_count);
+    if (m_settings.tlm.compressed_telemetry)
+    {
+        // same values as base-91 comment telemetry of a status report, the T# frame is only kept for the figures
+        AprsFrame compressed;
+        compressed.header(callsign, destcall)
+            .append('>')
+            .compressedTelemetry(sequence, analog, tlm_analog_count, data.status, tlm_digital_count);
+        count_saving(compressed, beacon);
+        beacon = compressed;
+    }
 #if SERIALDEBUG
     Serial.print("tx_telemetry_data beacon:");
-    Serial.println(beacon);
+    Serial.write(beacon.data(), beacon.length());
+    Serial.println();
 #endif
 
 #if LORA
-    tx(beacon);
+    tx(beacon, priority);
 #endif
 }
-
-/**
- * @brief adds leading characters to a string
- *
- * @param str input string
- * @param s final length
- * @param paddedChar padded character (default: space)
- * @return std::string
- */
-std::string MyLora::lpad(std::string const &str, size_t length, char paddedChar)
-{
-    if (str.size() < length)
-    {
-        return std::string(length - str.size(), paddedChar) + str;
-    }
-    else
-    {
-        return str;
-    }
-}
-
-/**
- * @brief adds trailing characters to a string
- *
- * @param str input string
- * @param s final length
- * @param paddedChar padded character (default: space)
- * @return std::string
- */
-std::string MyLora::rpad(std::string const &str, size_t s, char paddedChar)
-{
-    if (str.size() < s)
-        return str + std::string(s - str.size(), paddedChar);
-    else
-        return str;
-}
@@ -0,0 +1,132 @@
+#include <cstring>
+#include <oledpanel.h>
+
+// SSD1306 control bytes and commands
+static constexpr uint8_t control_commands = 0x00; // the rest of the transaction are commands
+static constexpr uint8_t control_data = 0x40;     // the rest of the transaction is display data
+static constexpr uint8_t column_address = 0x21;
+static constexpr uint8_t page_address = 0x22;
+
+
+/**
+ * @brief the panel shows frame, e.g. after the display driver sent it
+ */
+void OledPanel::sync(const uint8_t *frame)
+{
+    memcpy(m_shown, frame, frame_size);
+    m_valid = true;
+}
+
+/**
+ * @brief the panel content is unknown, the next flush sends the whole frame
+ */
+void OledPanel::invalidate()
+{
+    m_valid = false;
+}
+
+/**
+ * @brief sends the changed runs of each page
+ *
+ * @param frame page buffer of the display driver, byte x + page * width holds the 8 rows of column x
+ * @return size_t [bytes] sent on the i2c bus
+ */
+size_t OledPanel::flush(const uint8_t *frame)
+{
+    const auto before = m_stats.bytes;
+    m_page = 0;
+    while (!flushPage(frame))
+        ;
+    return m_stats.bytes - before;
+}
+
+/**
+ * @brief sends the changed runs of the next page, the whole frame at once if the panel content is unknown
+ * @note pass the same frame until it returns true
+ *
+ * @param frame page buffer of the display driver
+ * @return true if the frame is complete on the panel
+ */
+bool OledPanel::flushPage(const uint8_t *frame)
+{
+    if (!m_page)
+    {
+        ++m_stats.flushes;
+        m_frameBytes = m_stats.bytes;
+        if (!m_valid)
+        {
+            send(0, pages - 1, 0, width - 1, frame);
+            sync(frame);
+            return true;
+        }
+    }
+
+    const auto page = m_page;
+    const auto shown = m_shown + page * width;
+    const auto next = frame + page * width;
+    int16_t first = -1;
+    int16_t last = -1;
+    for (int16_t x = 0; x < width; ++x)
+    {
+        if (shown[x] == next[x])
+            continue;
+        if (first >= 0 && static_cast<size_t>(x - last - 1) > window_cost)
+        {
+            send(page, page, first, last, frame);
+            first = -1;
+        }
+        if (first < 0)
+            first = x;
+        last = x;
+    }
+    if (first >= 0)
+        send(page, page, first, last, frame);
+    memcpy(m_shown + page * width, next, width);
+
+    if (++m_page < pages)
+        return false;
+    m_page = 0;
+    if (m_stats.bytes == m_frameBytes)
+        ++m_stats.unchanged;
+    return true;
+}
+
+OledPanelStats OledPanel::stats() const
+{
+    return m_stats;
+}
+
+/**
+ * @brief sets the address window and writes its bytes, the panel fills the window column by column, page by page
+ */
+void OledPanel::send(int16_t firstPage, int16_t lastPage, int16_t firstColumn, int16_t lastColumn,
+                     const uint8_t *frame)
+{
+    const uint8_t window[] = {control_commands,
+                              column_address,
+                              static_cast<uint8_t>(firstColumn),
+                              static_cast<uint8_t>(lastColumn),
+                              page_address,
+                              static_cast<uint8_t>(firstPage),
+                              static_cast<uint8_t>(lastPage)};
+    m_wire.beginTransmission(m_address);
+    m_wire.write(window, sizeof(window));
+    m_wire.endTransmission();
+    m_stats.bytes += 1 + sizeof(window);
+    ++m_stats.windows;
+
+    const auto columns = static_cast<size_t>(lastColumn - firstColumn + 1);
+    for (auto page = firstPage; page <= lastPage; ++page)
+    {
+        const auto data = frame + page * width + firstColumn;
+        for (size_t offset = 0; offset < columns; offset += chunk)
+        {
+            const auto length = columns - offset < chunk ? columns - offset : chunk;
+            m_wire.beginTransmission(m_address);
+            m_wire.write(control_data);
+            m_wire.write(data + offset, length);
+            m_wire.endTransmission();
+            m_stats.bytes += 2 + length;
+        }
+    }
+}
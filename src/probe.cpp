@@ -0,0 +1,133 @@
+#include <Arduino.h>
+#include <probe.h>
+
+
+void LatencyHistogram::record(uint32_t us)
+{
+    ++m_count;
+    if (us < m_min)
+        m_min = us;
+    if (us > m_max)
+        m_max = us;
+    auto &bucket = m_buckets[bucket_of(us)];
+    if (bucket < UINT16_MAX)
+        ++bucket;
+}
+
+void LatencyHistogram::reset()
+{
+    *this = LatencyHistogram();
+}
+
+uint32_t LatencyHistogram::count() const
+{
+    return m_count;
+}
+
+/**
+ * @return uint32_t [us] 0 if nothing was recorded
+ */
+uint32_t LatencyHistogram::min() const
+{
+    return m_count ? m_min : 0;
+}
+
+/**
+ * @return uint32_t [us]
+ */
+uint32_t LatencyHistogram::max() const
+{
+    return m_max;
+}
+
+/**
+ * @brief upper bound of the bucket holding the percentile, never above max()
+ *
+ * @param perMille e.g. 990 for p99
+ * @return uint32_t [us] 0 if nothing was recorded
+ */
+uint32_t LatencyHistogram::percentile(uint16_t perMille) const
+{
+    // the saturated bucket counts, not m_count, are the population
+    uint32_t total = 0;
+    for (const auto bucket : m_buckets)
+        total += bucket;
+    if (!total)
+        return 0;
+    const uint32_t rank = (static_cast<uint64_t>(total) * perMille + 999) / 1000;
+    uint32_t seen = 0;
+    for (size_t i = 0; i < buckets - 1; ++i)
+    {
+        seen += m_buckets[i];
+        if (seen >= rank)
+        {
+            const uint32_t upper = (2UL << i) - 1;
+            return upper < m_max ? upper : m_max;
+        }
+    }
+    return m_max;
+}
+
+uint16_t LatencyHistogram::bucket(size_t index) const
+{
+    return index < buckets ? m_buckets[index] : 0;
+}
+
+/**
+ * @brief log2 of the duration, 0 us goes to bucket 0
+ */
+size_t LatencyHistogram::bucket_of(uint32_t us)
+{
+    if (!us)
+        return 0;
+    const size_t log2 = 31 - __builtin_clz(us);
+    return log2 < buckets ? log2 : buckets - 1;
+}
+
+
+#if LOOPPROBES
+LatencyHistogram LoopProbes::s_histograms[probe_stages];
+uint32_t LoopProbes::s_cyclesPerUs = 240;
+
+/**
+ * @brief takes the cpu clock for the cycle to us conversion, call once in setup()
+ */
+void LoopProbes::init()
+{
+    s_cyclesPerUs = ESP.getCpuFreqMHz();
+    if (!s_cyclesPerUs)
+        s_cyclesPerUs = 1;
+}
+
+/**
+ * @brief records a stage duration
+ * @note every stage is timed by one task only, a reset from another task may race with the sample in flight
+ *
+ * @param cycles cpu cycles, the counter wraps after 17 s at 240 MHz
+ */
+void LoopProbes::record(ProbeStage stage, uint32_t cycles)
+{
+    s_histograms[stage].record(cycles / s_cyclesPerUs);
+}
+
+const LatencyHistogram &LoopProbes::histogram(ProbeStage stage)
+{
+    return s_histograms[stage];
+}
+
+/**
+ * @brief short name of a stage, fits esp_get_probes_response_message::name
+ */
+const char *LoopProbes::name(ProbeStage stage)
+{
+    static const char *const names[probe_stages] = {"loop",   "serial",  "acquire", "display", "tlm",
+                                                    "commit", "history", "radio",   "rx"};
+    return stage < probe_stages ? names[stage] : "";
+}
+
+void LoopProbes::reset()
+{
+    for (auto &histogram : s_histograms)
+        histogram.reset();
+}
+#endif
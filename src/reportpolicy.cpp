@@ -0,0 +1,123 @@
+#include <cstdlib>
+#include <reportpolicy.h>
+
+static_assert(sizeof(Settings::Telemetry_settings::report_hold_time) / sizeof(uint16_t) == tlm_digital_count,
+              "one hold time per status bit");
+
+
+ReportPolicy::ReportPolicy(const Settings::Telemetry_settings &settings) : m_settings(settings)
+{
+}
+
+/**
+ * @brief debounces the status bits and compares the values with the last frame
+ *
+ * @param now [ms]
+ * @param data current values
+ * @return true if a change driven frame has to be sent now, call sent() when it is
+ */
+bool ReportPolicy::poll(unsigned long now, const TelemetrySnapshot &data)
+{
+    if (!m_started)
+    {
+        // the first heartbeat frame reports the power up state
+        m_started = true;
+        m_stable = m_candidate = data.status;
+        for (auto &since : m_candidateSince)
+            since = now;
+        m_reported = data;
+        m_lastSent = now;
+        return false;
+    }
+
+    for (size_t i = 0; i < tlm_digital_count; ++i)
+    {
+        const uint8_t mask = 1U << i;
+        if ((data.status ^ m_candidate) & mask)
+        {
+            // the hold time starts over, a level that doesn't outlast it is never reported
+            m_candidate ^= mask;
+            m_candidateSince[i] = now;
+        }
+        if ((m_candidate ^ m_stable) & mask && now - m_candidateSince[i] >= m_settings.report_hold_time[i] * 1000UL)
+            m_stable ^= mask;
+    }
+
+    if (!changed(data))
+    {
+        // e.g. a value drifted back into its deadband
+        m_pending = false;
+        return false;
+    }
+    if (!m_pending)
+    {
+        m_pending = true;
+        m_pendingSince = now;
+    }
+    return now - m_pendingSince >= m_settings.report_coalesce * 1000UL &&
+           now - m_lastSent >= m_settings.report_min_interval * 1000UL;
+}
+
+/**
+ * @brief a telemetry frame went out, change driven or heartbeat, its values are the new reference
+ *
+ * @param now [ms]
+ * @param data values of the frame
+ */
+void ReportPolicy::sent(unsigned long now, const TelemetrySnapshot &data)
+{
+    // a frame within a hold time may carry a transient level, the reference keeps the debounced one
+    m_reported = data;
+    m_reported.status = m_started ? m_stable : data.status;
+    m_pending = false;
+    m_lastSent = now;
+}
+
+/**
+ * @brief latest time poll() has to run again, value changes are only caught by the poll that follows them
+ *
+ * @param now [ms]
+ * @return unsigned long [ms] absolute time, far ahead with nothing pending
+ */
+unsigned long ReportPolicy::nextDeadline(unsigned long now) const
+{
+    auto deadline = now + 24UL * 60 * 60 * 1000;
+    auto earlier = [&deadline](unsigned long time) {
+        if (static_cast<long>(time - deadline) < 0)
+            deadline = time;
+    };
+    if (m_pending)
+    {
+        const auto coalesced = m_pendingSince + m_settings.report_coalesce * 1000UL;
+        const auto spaced = m_lastSent + m_settings.report_min_interval * 1000UL;
+        earlier(static_cast<long>(coalesced - spaced) > 0 ? coalesced : spaced);
+    }
+    for (size_t i = 0; i < tlm_digital_count; ++i)
+    {
+        if ((m_candidate ^ m_stable) & (1U << i))
+            earlier(m_candidateSince[i] + m_settings.report_hold_time[i] * 1000UL);
+    }
+    return deadline;
+}
+
+/**
+ * @brief debounced status or an analog value differs from the last frame by at least its deadband
+ */
+bool ReportPolicy::changed(const TelemetrySnapshot &data) const
+{
+    auto moved = [](int value, int reference, int deadband) {
+        const auto delta = abs(value - reference);
+        return delta != 0 && delta >= deadband;
+    };
+    if (m_stable != m_reported.status)
+        return true;
+    if (moved(data.intvoltage, m_reported.intvoltage, m_settings.report_deadband_voltage))
+        return true;
+    // no climate values before the first dht11 frame
+    if (!data.climateValid)
+        return false;
+    if (!m_reported.climateValid)
+        return true;
+    return moved(data.temperature, m_reported.temperature, m_settings.report_deadband_temperature) ||
+           moved(data.humidity, m_reported.humidity, m_settings.report_deadband_humidity);
+}
@@ -0,0 +1,196 @@
+#include <scheduler.h>
+
+
+static bool due(unsigned long deadline, unsigned long now)
+{
+    return static_cast<long>(now - deadline) >= 0;
+}
+
+
+unsigned long Scheduler::now() const
+{
+    return m_clock();
+}
+
+size_t Scheduler::slot_of(unsigned long time) const
+{
+    return (time / tick) % slots;
+}
+
+void Scheduler::insert(SchedulerJob &job)
+{
+    auto &head = m_slots[slot_of(job.deadline)];
+    job.next = head;
+    head = &job;
+    job.armed = true;
+}
+
+void Scheduler::unlink(SchedulerJob &job)
+{
+    if (!job.armed)
+        return;
+    for (auto link = &m_slots[slot_of(job.deadline)]; *link; link = &(*link)->next)
+    {
+        if (*link == &job)
+        {
+            *link = job.next;
+            break;
+        }
+    }
+    job.next = nullptr;
+    job.armed = false;
+}
+
+/**
+ * @brief registers a periodic job
+ *
+ * @param job job
+ * @param period [ms]
+ * @param delay [ms] until the first run
+ */
+void Scheduler::every(SchedulerJob &job, unsigned long period, unsigned long delay)
+{
+    unlink(job);
+    job.period = period;
+    job.deadline = now() + delay;
+    insert(job);
+}
+
+/**
+ * @brief (re)arms a one shot job
+ *
+ * @param job job
+ * @param delay [ms] until it runs
+ */
+void Scheduler::once(SchedulerJob &job, unsigned long delay)
+{
+    unlink(job);
+    job.period = 0;
+    job.deadline = now() + delay;
+    insert(job);
+}
+
+/**
+ * @brief starts the period of a periodic job from now
+ */
+void Scheduler::restart(SchedulerJob &job)
+{
+    unlink(job);
+    job.deadline = now() + job.period;
+    insert(job);
+}
+
+void Scheduler::cancel(SchedulerJob &job)
+{
+    unlink(job);
+}
+
+/**
+ * @brief runs every job which is due
+ * @note a late periodic job runs once and skips the periods it missed (counted as overruns)
+ *
+ * @return size_t number of jobs run
+ */
+size_t Scheduler::run()
+{
+    const auto currentTime = now();
+    const auto currentTick = currentTime / tick;
+    if (!m_started)
+    {
+        m_lastTick = currentTick - 1;
+        m_started = true;
+    }
+    // the last visited tick again: jobs armed after its visit with a deadline in that tick are in its slot
+    auto ticks = currentTick - m_lastTick;
+    if (ticks > slots - 1)
+        ticks = slots - 1;
+
+    // collect first, jobs may re-arm themselves or others while running
+    SchedulerJob *dueJobs = nullptr;
+    for (unsigned long t = currentTick - ticks; t <= currentTick; ++t)
+    {
+        for (auto link = &m_slots[t % slots]; *link;)
+        {
+            auto job = *link;
+            if (due(job->deadline, currentTime))
+            {
+                *link = job->next;
+                job->armed = false;
+                job->next = dueJobs;
+                dueJobs = job;
+            }
+            else
+            {
+                link = &job->next;
+            }
+        }
+    }
+    m_lastTick = currentTick;
+
+    size_t count = 0;
+    while (dueJobs)
+    {
+        auto job = dueJobs;
+        dueJobs = job->next;
+        job->next = nullptr;
+
+        const auto lateness = currentTime - job->deadline;
+        if (lateness > job->maxLateness)
+            job->maxLateness = lateness;
+        if (job->period)
+        {
+            job->deadline += job->period;
+            if (due(job->deadline, currentTime))
+            {
+                const auto missed = (currentTime - job->deadline) / job->period + 1;
+                job->overruns += missed;
+                job->deadline += missed * job->period;
+            }
+            insert(*job);
+        }
+        ++job->runs;
+        ++count;
+        job->function();
+    }
+    return count;
+}
+
+/**
+ * @brief earliest deadline of all armed jobs
+ * @note walks the wheel from the last tick run() visited, jobs that fell due since then come first. jobs more than
+ * one rotation ahead and all jobs before the first run() are found by the full scan
+ *
+ * @return unsigned long [ms] absolute time, in the past for a job that is due, now() + one day if no job is armed
+ */
+unsigned long Scheduler::nextDeadline() const
+{
+    const auto currentTime = now();
+    for (size_t i = 0; m_started && i < slots; ++i)
+    {
+        bool found = false;
+        unsigned long earliest = 0;
+        for (auto job = m_slots[(m_lastTick + i) % slots]; job; job = job->next)
+        {
+            if (job->deadline / tick > m_lastTick + i)
+                continue;
+            if (!found || static_cast<long>(job->deadline - earliest) < 0)
+                earliest = job->deadline;
+            found = true;
+        }
+        if (found)
+            return earliest;
+    }
+
+    bool found = false;
+    unsigned long earliest = currentTime + 24UL * 60 * 60 * 1000;
+    for (auto head : m_slots)
+    {
+        for (auto job = head; job; job = job->next)
+        {
+            if (!found || static_cast<long>(job->deadline - earliest) < 0)
+                earliest = job->deadline;
+            found = true;
+        }
+    }
+    return earliest;
+}
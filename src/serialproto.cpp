@@ -0,0 +1,189 @@
+#include <serialproto.h>
+
+
+/**
+ * @brief consumes one received byte, never blocks
+ * @note a corrupted frame is dropped and the parser resynchronises on the next 0x00 delimiter
+ *
+ * @param byte received byte
+ * @return true if a complete, crc checked message is available
+ */
+bool SerialProtocol::feed(uint8_t byte)
+{
+    if (byte == 0)
+        return finish();
+    if (m_discard)
+        return false;
+
+    if (m_remaining == 0)
+    {
+        // cobs code byte
+        if (m_zeroPending)
+            put(0);
+        m_remaining = byte - 1;
+        m_zeroPending = byte != 0xFF;
+    }
+    else
+    {
+        put(byte);
+        --m_remaining;
+    }
+    return false;
+}
+
+void SerialProtocol::put(uint8_t byte)
+{
+    if (m_length >= max_message)
+    {
+        m_discard = true;
+        return;
+    }
+    m_buffer[m_length++] = byte;
+}
+
+/**
+ * @brief delimiter received, checks and publishes the frame
+ */
+bool SerialProtocol::finish()
+{
+    const auto length = m_length;
+    const bool broken = m_discard || m_remaining != 0;
+    m_length = 0;
+    m_remaining = 0;
+    m_zeroPending = false;
+    m_discard = false;
+
+    if (length == 0 && !broken)
+        return false; // empty frame, e.g. leading delimiter
+    if (broken || length < sizeof(uint32_t) + sizeof(uint16_t))
+    {
+        ++m_framingErrors;
+        return false;
+    }
+    const auto dataLength = length - sizeof(uint16_t);
+    const uint16_t crc = m_buffer[dataLength] | (m_buffer[dataLength + 1] << 8);
+    if (crc != crc16(m_buffer, dataLength))
+    {
+        ++m_crcErrors;
+        return false;
+    }
+    m_messageLength = dataLength;
+    ++m_frames;
+    return true;
+}
+
+/**
+ * @brief command of the last received message
+ */
+uint32_t SerialProtocol::command() const
+{
+    return m_buffer[0] | (m_buffer[1] << 8) | (m_buffer[2] << 16) | (static_cast<uint32_t>(m_buffer[3]) << 24);
+}
+
+const uint8_t *SerialProtocol::payload() const
+{
+    return m_buffer + sizeof(uint32_t);
+}
+
+size_t SerialProtocol::payloadLength() const
+{
+    return m_messageLength - sizeof(uint32_t);
+}
+
+/**
+ * @brief copies the last received message
+ */
+void SerialProtocol::message(SerialMessage &msg) const
+{
+    msg.command = command();
+    msg.length = static_cast<uint16_t>(payloadLength());
+    memcpy(msg.payload, payload(), msg.length);
+}
+
+/**
+ * @brief builds a complete frame including the trailing delimiter
+ *
+ * @param command message command
+ * @param payload message struct
+ * @param length size of the message struct
+ * @param out frame buffer
+ * @param outSize size of the frame buffer
+ * @return size_t frame length, 0 if the frame does not fit
+ */
+size_t SerialProtocol::encode(uint32_t command, const void *payload, size_t length, uint8_t *out, size_t outSize)
+{
+    const auto raw = sizeof(uint32_t) + length + sizeof(uint16_t);
+    if (length > max_payload || outSize < raw + raw / 254 + 2)
+        return 0;
+
+    uint8_t header[sizeof(uint32_t)] = {
+        static_cast<uint8_t>(command),
+        static_cast<uint8_t>(command >> 8),
+        static_cast<uint8_t>(command >> 16),
+        static_cast<uint8_t>(command >> 24),
+    };
+    const auto data = static_cast<const uint8_t *>(payload);
+    auto crc = crc16(header, sizeof(header));
+    crc = crc16(data, length, crc);
+    const uint8_t trailer[sizeof(uint16_t)] = {static_cast<uint8_t>(crc), static_cast<uint8_t>(crc >> 8)};
+
+    size_t pos = 1;
+    size_t codePos = 0;
+    uint8_t code = 1;
+    auto cobs = [&](uint8_t byte) {
+        if (byte)
+        {
+            out[pos++] = byte;
+            ++code;
+        }
+        if (!byte || code == 0xFF)
+        {
+            out[codePos] = code;
+            codePos = pos++;
+            code = 1;
+        }
+    };
+    for (auto byte : header)
+        cobs(byte);
+    for (size_t i = 0; i < length; ++i)
+        cobs(data[i]);
+    for (auto byte : trailer)
+        cobs(byte);
+    out[codePos] = code;
+    out[pos++] = 0;
+    return pos;
+}
+
+/**
+ * @brief CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF)
+ *
+ * @param data data
+ * @param length data length
+ * @param crc crc of the preceding data
+ * @return uint16_t
+ */
+uint16_t SerialProtocol::crc16(const uint8_t *data, size_t length, uint16_t crc)
+{
+    for (size_t i = 0; i < length; ++i)
+    {
+        crc ^= data[i] << 8;
+        for (int bit = 0; bit < 8; ++bit)
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+    return crc;
+}
+
+uint32_t SerialProtocol::frames() const
+{
+    return m_frames;
+}
+
+uint32_t SerialProtocol::crcErrors() const
+{
+    return m_crcErrors;
+}
+
+uint32_t SerialProtocol::framingErrors() const
+{
+    return m_framingErrors;
+}
@@ -0,0 +1,87 @@
+#include <cstring>
+#include <serialtx.h>
+
+
+/**
+ * @brief appends a frame to the ring
+ *
+ * @param frame complete frame, see SerialProtocol::encode()
+ * @param length [bytes]
+ * @return false if it didn't fit, the frame is dropped and counted
+ */
+bool SerialTx::queue(const uint8_t *frame, size_t length)
+{
+    if (length > room())
+    {
+        ++m_stats.framesDropped;
+        m_stats.bytesDropped += length;
+        return false;
+    }
+    const auto offset = m_head % capacity;
+    const auto first = length < capacity - offset ? length : capacity - offset;
+    memcpy(m_ring + offset, frame, first);
+    memcpy(m_ring, frame + first, length - first);
+    m_head += length;
+    ++m_stats.frames;
+    if (queued() > m_stats.highWater)
+        m_stats.highWater = static_cast<uint16_t>(queued());
+    return true;
+}
+
+/**
+ * @brief hands the uart as much as its tx fifo takes without waiting
+ *
+ * @return size_t [bytes] written
+ */
+size_t SerialTx::drain()
+{
+    size_t written = 0;
+    while (m_head != m_tail)
+    {
+        const auto space = m_serial.availableForWrite();
+        if (space <= 0)
+            break;
+        const auto offset = m_tail % capacity;
+        auto length = m_head - m_tail;
+        if (length > capacity - offset)
+            length = capacity - offset; // up to the end of the ring, the rest on the next turn
+        if (length > static_cast<size_t>(space))
+            length = space;
+        m_serial.write(m_ring + offset, length);
+        ++m_stats.writes;
+        m_tail += length;
+        written += length;
+    }
+    return written;
+}
+
+size_t SerialTx::queued() const
+{
+    return m_head - m_tail;
+}
+
+size_t SerialTx::room() const
+{
+    return capacity - queued();
+}
+
+/**
+ * @brief when the uart has taken the next half fifo of a queued output
+ *
+ * @param now [ms] millis()
+ * @return unsigned long [ms]
+ */
+unsigned long SerialTx::nextDeadline(unsigned long now) const
+{
+    if (m_head == m_tail)
+        return now + 24UL * 60 * 60 * 1000;
+    return now + (uart_fifo / 2 * 10 * 1000 + m_baud - 1) / m_baud; // 10 bits per byte
+}
+
+SerialTxStats SerialTx::stats() const
+{
+    auto stats = m_stats;
+    stats.queued = static_cast<uint16_t>(queued());
+    stats.capacity = capacity;
+    return stats;
+}
@@ -0,0 +1,119 @@
+#include <cstdlib>
+#include <subscription.h>
+
+
+/**
+ * @brief applies an esp_subscribe_message, the next poll() pushes the complete state
+ *
+ * @param msg subscription request
+ */
+void Subscription::configure(const esp_subscribe_message &msg)
+{
+    m_active = msg.enable != 0;
+    m_initial = true;
+    m_voltageThreshold = msg.voltageThreshold;
+    m_temperatureThreshold = static_cast<int16_t>(msg.temperatureThreshold);
+    m_humidityThreshold = msg.humidityThreshold;
+    m_heartbeatInterval = msg.heartbeatInterval * 1000UL;
+}
+
+/**
+ * @brief stops pushing, e.g. when the pc-compagnion timed out
+ */
+void Subscription::cancel()
+{
+    m_active = false;
+}
+
+bool Subscription::active() const
+{
+    return m_active;
+}
+
+/**
+ * @brief compares the current values with the last pushed ones
+ *
+ * @param now [ms]
+ * @param data current values
+ * @param msg message to push
+ * @return true if msg has to be sent
+ */
+bool Subscription::poll(unsigned long now, const TelemetrySnapshot &data, esp_delta_message &msg)
+{
+    if (!m_active)
+        return false;
+
+    msg.status = data.status;
+    msg.intvoltage = data.intvoltage;
+    msg.temperature = data.temperature;
+    msg.humidity = data.humidity;
+    msg.battPercent = data.battPercent;
+    msg.aprsPacketSeq = data.aprsPacketSeq;
+
+    msg.changed = 0;
+    if (m_initial)
+    {
+        msg.changed = esp_delta_message::changed_status | esp_delta_message::changed_voltage |
+                      esp_delta_message::changed_temperature | esp_delta_message::changed_humidity |
+                      esp_delta_message::changed_sequence;
+    }
+    else
+    {
+        auto moved = [](int value, int reference, int threshold) {
+            const auto delta = abs(value - reference);
+            return delta != 0 && delta >= threshold;
+        };
+        if (msg.status != m_last.status)
+            msg.changed |= esp_delta_message::changed_status;
+        if (moved(msg.intvoltage, m_last.intvoltage, m_voltageThreshold) || msg.battPercent != m_last.battPercent)
+            msg.changed |= esp_delta_message::changed_voltage;
+        if (moved(msg.temperature, m_last.temperature, m_temperatureThreshold))
+            msg.changed |= esp_delta_message::changed_temperature;
+        if (moved(msg.humidity, m_last.humidity, m_humidityThreshold))
+            msg.changed |= esp_delta_message::changed_humidity;
+        if (msg.aprsPacketSeq != m_last.aprsPacketSeq)
+            msg.changed |= esp_delta_message::changed_sequence;
+    }
+
+    const bool heartbeat = m_heartbeatInterval && now - m_lastSent >= m_heartbeatInterval;
+    if (!msg.changed && !heartbeat)
+        return false;
+
+    // thresholds compare against the last pushed value of a field, so slow drifts add up until they pass
+    if (heartbeat || m_initial)
+    {
+        m_last = msg;
+    }
+    else
+    {
+        m_last.status = msg.status;
+        m_last.aprsPacketSeq = msg.aprsPacketSeq;
+        if (msg.changed & esp_delta_message::changed_voltage)
+        {
+            m_last.intvoltage = msg.intvoltage;
+            m_last.battPercent = msg.battPercent;
+        }
+        if (msg.changed & esp_delta_message::changed_temperature)
+            m_last.temperature = msg.temperature;
+        if (msg.changed & esp_delta_message::changed_humidity)
+            m_last.humidity = msg.humidity;
+    }
+    m_initial = false;
+    m_lastSent = now;
+    return true;
+}
+
+/**
+ * @brief latest time poll() has to run again, value changes are only caught by the poll that follows them
+ *
+ * @param now [ms]
+ * @return unsigned long [ms] absolute time, far ahead without heartbeat
+ */
+unsigned long Subscription::nextDeadline(unsigned long now) const
+{
+    if (!m_active || (!m_initial && !m_heartbeatInterval))
+        return now + 24UL * 60 * 60 * 1000;
+    if (m_initial)
+        return now;
+    return m_lastSent + m_heartbeatInterval;
+}
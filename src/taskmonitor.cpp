@@ -0,0 +1,75 @@
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <taskmonitor.h>
+
+
+void TaskMonitor::attach(void *handle)
+{
+    m_handle = handle;
+}
+
+/**
+ * @brief monitors the calling task
+ */
+void TaskMonitor::attachCurrent()
+{
+    m_handle = xTaskGetCurrentTaskHandle();
+}
+
+/**
+ * @brief counts one pass of the task loop
+ */
+void TaskMonitor::pass()
+{
+    m_runs.store(m_runs.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+/**
+ * @brief a queued request was picked up by the task
+ *
+ * @param enqueued [us] micros() when the request was queued
+ */
+void TaskMonitor::served(uint32_t enqueued)
+{
+    const uint32_t latency = micros() - enqueued;
+    if (latency > m_worstLatency.load(std::memory_order_relaxed))
+        m_worstLatency.store(latency, std::memory_order_relaxed);
+}
+
+const char *TaskMonitor::name() const
+{
+    return m_name;
+}
+
+void *TaskMonitor::handle() const
+{
+    return m_handle;
+}
+
+/**
+ * @brief stack high water mark
+ *
+ * @return uint32_t [bytes] never used stack, 0 if no task is attached
+ */
+uint32_t TaskMonitor::stackFree() const
+{
+    if (!m_handle)
+        return 0;
+    return uxTaskGetStackHighWaterMark(static_cast<TaskHandle_t>(m_handle));
+}
+
+/**
+ * @brief worst latency between queueing a request and the task picking it up
+ *
+ * @return uint32_t [us]
+ */
+uint32_t TaskMonitor::worstLatency() const
+{
+    return m_worstLatency.load(std::memory_order_relaxed);
+}
+
+uint32_t TaskMonitor::runs() const
+{
+    return m_runs.load(std::memory_order_relaxed);
+}
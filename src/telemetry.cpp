@@ -0,0 +1,53 @@
+#include <cmath>
+#include <telemetry.h>
+
+// compile time checks of the channel table and the generated texts
+
+constexpr bool telemetry_equals(const char *a, const char *b)
+{
+    while (*a && *a == *b)
+    {
+        ++a;
+        ++b;
+    }
+    return *a == *b;
+}
+
+constexpr bool telemetry_linear_equations()
+{
+    for (const auto &channel : TelemetryTable::analog)
+        if (channel.a.mantissa != 0 || channel.b.mantissa == 0)
+            return false;
+    return true;
+}
+
+static_assert(tlm_analog_count <= TelemetryTable::aprs_analog_channels, "aprs telemetry has 5 analog channels");
+static_assert(tlm_digital_count <= TelemetryTable::aprs_digital_channels, "aprs telemetry has 8 digital channels");
+static_assert(telemetry_linear_equations(), "encode() can only invert linear equations (a = 0, b != 0)");
+static_assert(telemetry_equals(telemetry_parm.text,
+                               "PARM.Vbatt,Capacity,Temperature,Humidity,,USBPower,240V,PCconn,Uplink,Echolink"),
+              "generated PARM text");
+static_assert(telemetry_equals(telemetry_unit.text, "UNIT.Vdc,%,Celsius,%,,UP,UP,UP,UP,UP"), "generated UNIT text");
+static_assert(telemetry_equals(telemetry_eqns.text, "EQNS.0,0.01,2.5,0,1,0,0,1,-100,0,1,0"), "generated EQNS text");
+static_assert(telemetry_equals(telemetry_bits.text, "BITS.11111111,HB9GL-R telemetry by HB9HDG"),
+              "generated BITS text");
+static_assert(telemetry_parm.length == sizeof(telemetry_parm.text) - 1, "generated text length");
+
+
+/**
+ * @brief scales a value to the raw aprs telemetry value by inverting the channel's equation
+ *
+ * @param id analog channel
+ * @param value value in channel units
+ * @return int raw value, clamped to 0..255
+ */
+int TelemetryTable::encode(TelemetryAnalogId id, float value)
+{
+    const auto &channel = analog[id];
+    auto raw = static_cast<int>(lround((value - channel.c.value()) / channel.b.value()));
+    if (raw < raw_min)
+        raw = raw_min;
+    if (raw > raw_max)
+        raw = raw_max;
+    return raw;
+}
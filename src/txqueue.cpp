@@ -0,0 +1,138 @@
+#include <cstring>
+#include <txqueue.h>
+
+
+/**
+ * @brief finds the waiting frame which is sent next (or last)
+ *
+ * @param lowest false: most urgent frame, true: least urgent frame
+ * @return int slot index, -1 if no frame is waiting
+ */
+int TxQueue::select(bool lowest) const
+{
+    int best = -1;
+    for (size_t i = 0; i < capacity; ++i)
+    {
+        if (!m_used[i] || static_cast<int>(i) == m_inFlight)
+            continue;
+        if (best < 0)
+        {
+            best = i;
+            continue;
+        }
+        const auto &a = m_frames[i];
+        const auto &b = m_frames[best];
+        const bool before =
+            a.priority < b.priority || (a.priority == b.priority && static_cast<int32_t>(a.order - b.order) < 0);
+        if (before != lowest)
+            best = i;
+    }
+    return best;
+}
+
+/**
+ * @brief add a frame to the queue
+ * @note if the queue is full a waiting frame of lower priority is dropped in favour of the new one
+ *
+ * @param data aprs payload
+ * @param length payload length
+ * @param priority transmit priority
+ * @return false if the frame is dropped (queue full of more urgent frames or frame too long)
+ */
+bool TxQueue::push(const uint8_t *data, size_t length, TxPriority priority)
+{
+    if (length > TxFrame::max_length)
+    {
+        ++m_drops;
+        return false;
+    }
+    int slot = -1;
+    if (m_count < capacity)
+    {
+        for (size_t i = 0; i < capacity && slot < 0; ++i)
+            if (!m_used[i])
+                slot = i;
+        ++m_count;
+    }
+    else
+    {
+        slot = select(true);
+        ++m_drops;
+        if (slot < 0 || m_frames[slot].priority <= priority)
+            return false;
+    }
+    auto &frame = m_frames[slot];
+    frame.length = static_cast<uint8_t>(length);
+    memcpy(frame.data, data, length);
+    frame.priority = priority;
+    frame.order = m_order++;
+    m_used[slot] = true;
+    return true;
+}
+
+/**
+ * @brief frame that begin_tx() would hand out
+ *
+ * @return most urgent waiting frame, nullptr if none
+ */
+const TxFrame *TxQueue::peek() const
+{
+    if (m_inFlight >= 0)
+        return nullptr;
+    const auto slot = select(false);
+    return slot < 0 ? nullptr : &m_frames[slot];
+}
+
+/**
+ * @brief marks the most urgent frame as in flight
+ *
+ * @return frame to hand to the radio, nullptr if the queue is empty or a frame is already in flight
+ */
+const TxFrame *TxQueue::begin_tx()
+{
+    if (m_inFlight >= 0)
+        return nullptr;
+    m_inFlight = select(false);
+    return m_inFlight < 0 ? nullptr : &m_frames[m_inFlight];
+}
+
+/**
+ * @brief releases the in flight frame after the radio reported tx done
+ */
+void TxQueue::complete_tx()
+{
+    if (m_inFlight < 0)
+        return;
+    m_used[m_inFlight] = false;
+    m_inFlight = -1;
+    --m_count;
+    ++m_sent;
+}
+
+const TxFrame *TxQueue::inFlight() const
+{
+    return m_inFlight < 0 ? nullptr : &m_frames[m_inFlight];
+}
+
+/**
+ * @brief number of frames in the queue, including the one in flight
+ */
+size_t TxQueue::depth() const
+{
+    return m_count;
+}
+
+bool TxQueue::empty() const
+{
+    return m_count == 0;
+}
+
+uint32_t TxQueue::drops() const
+{
+    return m_drops;
+}
+
+uint32_t TxQueue::sent() const
+{
+    return m_sent;
+}